@@ -24,6 +24,17 @@
 //							setLocationParams(), setTCPParams()
 //                       Bug fixed the following functions,
 //							setDefaultProfile(), enterAT()
+//		R4.4 2026/10/19  Escape data by lookup table and write it in blocks (write())
+//                       Read $TR data by block with deadline, add getMissingBytes()
+//                       Add tunnel streaming functions tunnelBegin(), tunnelWrite(), tunnelEnd(), fix writeBegin()
+//		R4.5 2026/10/19  Move common functions into gimcore library(GIMCore), A3GS is derived from it
+//                       Receive through ring buffer and line framer
+//                       (pollResult(), availableStatus() and readStatus() are available)
+//		R4.6 2026/10/19  Add asynchronous positioning startLocation(), startLocation2(), pollLocation() and
+//						 getLastLocation(), getLastLocation2()(cache of the last fix, defined in GIMCore),
+//						 getLocation()/getLocation2() use them
+//		R4.7 2026/10/19  UNO..: status lines are not kept and the last fix is parsed from the work buffer
+//						 (A3GSLimits), add MAX_RESULT_LENGTH to A3GSLimits
 //
 //	Author:
 //		Open wireless Alliance(Old 3G Shield Alliance) and Atushi Daikoku
@@ -35,6 +46,9 @@
 //		- Use specified power control or not(always on).
 //		If you want to change UART baudrate then define "a3gsBAUDRATE"
 //		symbol before #include "a3gs3.h" statement.
+//		RAM of A3GS object on UNO..(counted from member sizes, int and pointer are 2 bytes) is 317 bytes,
+//		163 bytes more than R4.3(150 bytes work buffer + 4 bytes): 32 bytes ring buffer, 80 bytes line buffer,
+//		21 bytes clock(getTime()), 13 bytes positioning state and 17 bytes others. --@add R4.7
 //***********************************************************
 
 #ifndef _A3GIM_H_
@@ -42,6 +56,7 @@
 
 #include <Arduino.h>
 #include <SoftwareSerial.h>
+#include <gimcore.h>		//@add R4.5
 
 /*
 	Define constants
@@ -53,25 +68,25 @@
 
 //	Basic constants
 #define	a3gsBAUDRATE						9600		// Default UART baudrate if "a3gsBAUDRATE" is undefined(3GIM default baudrate is 9600)
-#define	a3gsDATE_SIZE						11		// date space size ("YYYY/MM/DD\0" format, used in getTime(), included '\0')
-#define	a3gsTIME_SIZE						9			// time space size ("HH:MM:SS\0" format(hour is 24h-way), used in getTime(), included '\0')
+#define	a3gsDATE_SIZE						gimDATE_SIZE	// date space size ("YYYY/MM/DD\0" format, used in getTime(), included '\0')
+#define	a3gsTIME_SIZE						gimTIME_SIZE	// time space size ("HH:MM:SS\0" format(hour is 24h-way), used in getTime(), included '\0')
 #define	a3gsCS_ASCII						0			// SMS Text Char Code: ASCII (used in sendSMS())
 #define	a3gsCS_UNICODE						1			// SMS Text Char Code: UNICODE(Little Endian) (used in sendSMS()) --@Not used R4.0
-#define	a3gsIMEI_SIZE						16		// imei space size ("99..9\0" format, used in getIMEI(), included '\0')
-#define	a3gsDEFAULT_PORT					0			// Default port number(for httpGET() and httpPOST())
+#define	a3gsIMEI_SIZE						gimIMEI_SIZE	// imei space size ("99..9\0" format, used in getIMEI(), included '\0')
+#define	a3gsDEFAULT_PORT					gimDEFAULT_PORT	// Default port number(for httpGET() and httpPOST())
 
 //	Return values in general
-#define	a3gsSUCCESS							0
-#define	a3gsERROR								(-1)
+#define	a3gsSUCCESS							gimSUCCESS
+#define	a3gsERROR								gimERROR
 
 //	Maximum lengths
-#define	a3gsMAX_VERSION_LENGTH			5			// Maximum bytes of Version number(used in getVersion())
+#define	a3gsMAX_VERSION_LENGTH			gimMAX_VERSION_LENGTH	// Maximum bytes of Version number(used in getVersion())
 #define	a3gsMAX_SMS_LENGTH				120		// Maximum bytes of SMS message(used in sendSMS()) --@change R4.0
-#define	a3gsMAX_MSN_LENGTH				11		// Maximum bytes of Phone Number in Japan(used in readSMS())
-#define	a3gsMAX_HOST_LENGTH				96		// Maximum length of host name --@change R4.0
-#define	a3gsMAX_DATA_LENGTH				1024		// Maximum length of data(at read/write)
+#define	a3gsMAX_MSN_LENGTH				gimMAX_MSN_LENGTH		// Maximum bytes of Phone Number in Japan(used in readSMS())
+#define	a3gsMAX_HOST_LENGTH				gimMAX_HOST_LENGTH		// Maximum length of host name --@change R4.0
+#define	a3gsMAX_DATA_LENGTH				gimMAX_DATA_LENGTH		// Maximum length of data(at read/write)
 #define	a3gsMAX_SMS_SLOT				20		// Maximum number of SMS slot --@add R4.0
-#define	a3gsMAX_TUNNEL_DATA_LENGTH 32000	// Maximum length of data in writeBegin() --@add R4.0
+#define	a3gsMAX_TUNNEL_DATA_LENGTH gimMAX_TUNNEL_DATA_LENGTH	// Maximum length of data in writeBegin() --@add R4.0
 
 #if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
 	// Mega and Mega 2560/ADK
@@ -87,89 +102,71 @@
 #define	a3gsMAX_BODY_LENGTH				256		// Maximum length of header(used in httpPOST())
 #define	a3gsMAX_TWEET_LENGTH			60		// Maximum length of Tweet message(used in tweet())
 #endif
+#define	a3gsMAX_STATUS_LENGTH			48		// Maximum length of status line(used in readStatus()) --@add R4.5
 
 //	Return values of getService()
-#define	a3gsSRV_NO								0			// Out of service
-#define	a3gsSRV_PS								1			// Data(packet) only
-#define	a3gsSRV_CS								2			// Voice only -- @Not used R4.0
-#define	a3gsSRV_BOTH							3			// Data and voice both -- @Not used R4.0
+#define	a3gsSRV_NO								gimSRV_NO			// Out of service
+#define	a3gsSRV_PS								gimSRV_PS			// Data(packet) only
+#define	a3gsSRV_CS								gimSRV_CS			// Voice only -- @Not used R4.0
+#define	a3gsSRV_BOTH							gimSRV_BOTH			// Data and voice both -- @Not used R4.0
 
 //	Method of positioning by getPosition() -- @Not used R4.0 
-#define	a3gsMPBASED								0			// GPS + AGPS
-#define	a3gsMPASSISTED						1			// AGPS
-#define	a3gsMPSTANDALONE					2			// GPS only
+#define	a3gsMPBASED								gimMPBASED	// GPS + AGPS
+#define	a3gsMPASSISTED						gimMPASSISTED	// AGPS
+#define	a3gsMPSTANDALONE					gimMPSTANDALONE	// GPS only
+
+//	Positioning --@add R4.6
+#define	a3gsLOCATION_SIZE			gimLOCATION_SIZE	// latitude/longitude/height/utc space size(used in getLastLocation(), included '\0')
+
+extern  SoftwareSerial	a3gSerial;		// Serial for 3GIM
+
+/*
+	Limits policy of this library --@add R4.5
+*/
+struct A3GSLimits : public GIMDefaultLimits
+{
+	static const uint32_t	BAUDRATE = a3gsBAUDRATE;
+	static const int		MIN_FIRMWARE_VERSION = 330;	// 3.3
+#if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+	// Mega and Mega 2560/ADK
+	static const int		WORK_BUFFER_SIZE = 256;
+#else // UNO, Lenoard, Pro, Fio..
+	static const int		WORK_BUFFER_SIZE = 150;
+	static const int		RX_BUFFER_SIZE = 32;		// SoftwareSerial has own 64 bytes buffer
+	static const int		LINE_BUFFER_SIZE = 80;		// Longest result is $PS or $LG
+	static const int		MAX_STATUS_LINES = 0;		// Status lines are discarded --@change R4.7
+	static const boolean	LOCATION_CACHE = false;		// The last fix is parsed from the work buffer --@add R4.7
+#endif
+	static const int		MAX_URL_LENGTH = a3gsMAX_URL_LENGTH;
+	static const int		MAX_HEADER_LENGTH = a3gsMAX_HEADER_LENGTH;
+	static const int		MAX_BODY_LENGTH = a3gsMAX_BODY_LENGTH;
+	static const int		MAX_RESULT_LENGTH = a3gsMAX_RESULT_LENGTH;	//@add R4.7
+	static const int		MAX_TWEET_LENGTH = a3gsMAX_TWEET_LENGTH;
+	static const int		MAX_STATUS_LENGTH = a3gsMAX_STATUS_LENGTH;
+	static const uint32_t	TIMEOUT_NETWORK = 35000;
+	static const uint32_t	TIMEOUT_GPS = 180000;
+
+	static void listen(SoftwareSerial& serial) { serial.listen(); }
+};
 
 /*
 	Declare class
 */
-class A3GS
+class A3GS : public GIMCore<SoftwareSerial, A3GSLimits>		//@change R4.5
 {
   public:
-  	A3GS() : _powerPin(0) { };
-	enum A3GS_st_e { ERROR, IDLE, READY, TCPCONNECTEDCLIENT };
-
-	// compatible methods with Arduino GSM/GPRS Shield library
-	int getStatus() { return _status; };
-	int begin(char* pin = 0);
-	int begin(char* pin, uint32_t baudrate);
-	int end(void);
-	int restart(int pin = 0);   // @change(R3.0)
-	int start(int pin = 0);      // @change(R3.0)
-	int shutdown(void);
-		//-- This library do not use "pin" parameter, so ignore it.
-	int getIMEI(char* imei);
-	int connectTCP(const char* server, int port);
-	int disconnectTCP(void);
-	int getStatusTCP(int *status, int *tcpnotif, long *remainedBytes, long *receivedBytes);	//@add R4.0
-	int setTCPParams(int timeout1, int timeout2);	//@add R4.3 -- use only 3GIM(V2.2) above
-	int write(uint8_t c);
-			//--@R3.0 support binary data
-	int write(const char* str);
-			//--@R3.0 this function doesn't support binary data
-	int write(const uint8_t* buffer, size_t sz);
-			//--@R3.0 support binary data
-	int writeBegin(size_t sz);		//@add R4.0
-	int read(char* result, int resultlength);	//@R2.3 - Leave for compatibility
-			//--@R3.0 change non-blocking mode and this function doesn't support binary data
-	int read(void);		//@R2.0 Change
-			//--@R3.0 support binary data and change non-blocking mode
-	int read(uint8_t* buffer, size_t sz);		//@R2.3 Add
-			//--@R3.0 support binary data and change non-blocking mode
-		//-- This library do not support tcp/ip server functions.
-	int httpGET(const char* server, uint16_t port, const char* path, char* result, int resultlength, boolean ssled = false, const char* header = NULL);
-			//--@R3.0 add optional paramer "header"
-	int httpPOST(const char* server, uint16_t port, const char* path, const char* header, const char* body, char* result, int* resultlength, boolean ssled = false);
-			//-- httpPOST() is not compatible parameters with Arduino GSM/GPRS Shield library
-	int tweet(const char* token, const char* msg);
-		//-- tweet() sends a message to twitter with the text "msg"and the token "token". 
-		//-- Get the token from http://arduino-tweet.appspot.com/
+  	A3GS() : GIMCore<SoftwareSerial, A3GSLimits>(a3gSerial) { };
+	typedef gim_st_e A3GS_st_e;		// for compatibility
 
 	//-- Extended methods of IEM 3G Shield --//
+	//-- Other methods are defined in GIMCore(gimcore.h) --@change R4.5
 	int getLocation(int method, char* latitude, char* longitude);
 	int getLocation2(char* latitude, char* longitude, char *height, char *utc, int *quality, int *number);	//@add R4.0
 	int setLocationParams(int timeout, boolean useAGPS, boolean useActiveAntenna);	//@add R4.3 -- use only 3GIM(V2.2) above
-	int getServices(int& status);
-	int getRSSI(int& rssi);
-	int getTime(char* date, char* time);
-	int getTime2(uint32_t& seconds);
-	int getVersion(char *version);
-	int setDefaultProfile(const char *apn, const char *user, const char *password);	//@change R4.0
-	int getDefaultProfile(char *apn, char *user, char *password);	//@change R4.0
-	int setBaudrate(uint32_t baudrate);
-	int setLED(boolean sw);
-	int setAirplaneMode(boolean sw);
-	int enterAT(uint32_t duration);		//@add R4.0
-	int getResult(char *buf, int *len, uint32_t timeout);
-	
-  private:
-	int _status;		// for Compatible with GSM.h
-	int _powerPin;
-	void sendCommand(const char* cmd);
-	void sendData(const char* data);
-	void discardUntil(const char match);
+	//-- startLocation(), startLocation2(), pollLocation(), getLastLocation() and getLastLocation2()
+	//-- are defined in GIMCore(gimcore.h)
 };
 
 extern	A3GS				a3gs;				// An A3GS object
-extern  SoftwareSerial	a3gSerial;		// Serial for 3GIM
 
 #endif // _A3GIM_H_
@@ -0,0 +1,42 @@
+//***********************************************************
+//	a3gim2_client.h -- Arduino Client adapter of A3GS for Mega/Zero/M0..
+//
+//	History:
+//		R1.0 2026/10/19  1st Release
+//		R1.1 2026/10/19  A3GSClient is an instance of GIMClient(gimcore/gimclient.h), a3gim2_client.cpp is removed
+//
+//	Author:
+//		Open wireless Alliance(Old 3G Shield Alliance) and Atushi Daikoku
+//
+//	Notes:
+//		Client compatible class over a3gs TCP/IP functions, so that libraries using Client
+//		(MQTT, HTTP..) can run on 3GIM(V2).
+//		- Received data is read ahead up to a3gsCLIENT_RX_BUFFER_SIZE bytes by one $TR command.
+//		- Written data is coalesced up to a3gsCLIENT_TX_BUFFER_SIZE bytes into one $TW command,
+//		  and sent by flush(), or before reading.
+//***********************************************************
+
+#ifndef _A3GIM2_CLIENT_H_
+#define _A3GIM2_CLIENT_H_
+
+#include <Arduino.h>
+#include <gimclient.h>
+#include "a3gim2.h"
+
+/*
+	Define constants
+*/
+#ifndef a3gsCLIENT_RX_BUFFER_SIZE
+#define	a3gsCLIENT_RX_BUFFER_SIZE		a3gsMAX_DATA_LENGTH	// Size of read-ahead buffer(max a3gsMAX_DATA_LENGTH)
+#endif
+#ifndef a3gsCLIENT_TX_BUFFER_SIZE
+#define	a3gsCLIENT_TX_BUFFER_SIZE		256			// Size of write coalescing buffer(max a3gsMAX_DATA_LENGTH)
+#endif
+
+/*
+	Declare class
+*/
+typedef GIMClient<A3GS, a3gs, a3gsCLIENT_RX_BUFFER_SIZE, a3gsCLIENT_TX_BUFFER_SIZE>	A3GSClient;
+	//-- Methods are defined in GIMClient(gimclient.h)
+
+#endif // _A3GIM2_CLIENT_H_
@@ -0,0 +1,59 @@
+// 3GIM(V2) sample sketch for Mega/Leonardo.. -- startLocation/pollLocation
+
+#include "a3gim2.h"
+
+#define baudrate 	9600UL
+const int powerPin = 7;     // 3gim power pin(If not using power control, 0 is set.)
+const uint32_t maxAge = 600000UL;   // Locate again if the last fix is older than this [mS]
+
+boolean ready = false;
+
+void setup()
+{
+  Serial.begin(baudrate);
+  delay(100);    // Wait for start serial monitor
+  Serial.println("Ready.");
+
+  Serial.print("Initializing.. ");
+  if (a3gs.start(powerPin) == 0 && a3gs.begin(0, baudrate) == 0) {
+    Serial.println("Succeeded.");
+    ready = true;
+  }
+  else
+    Serial.println("Failed.");
+}
+
+void loop()
+{
+  char lat[a3gsLOCATION_SIZE], lng[a3gsLOCATION_SIZE];
+  uint32_t age;
+
+  if (! ready)
+    return;
+
+  if (a3gs.isLocating()) {
+    // Check the result without blocking
+    int rc = a3gs.pollLocation();
+    if (rc == 2)
+      Serial.println("Sorry, I don't know this location.");
+    else if (rc == 0)
+      Serial.println("Located.");
+  }
+  else if (a3gs.getLastLocation(lat, lng, &age) != 0 || age > maxAge) {
+    // No fix or too old, so locate again(It maybe takes several minutes)
+    a3gs.startLocation(a3gsMPBASED);
+  }
+  else {
+    Serial.print(lat);
+    Serial.print(", ");
+    Serial.print(lng);
+    Serial.print(" (");
+    Serial.print(age / 1000);
+    Serial.println(" sec. ago)");
+  }
+
+  // Sampling or other jobs can be done here while locating
+  delay(1000);
+}
+
+// END
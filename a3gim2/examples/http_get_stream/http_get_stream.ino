@@ -0,0 +1,59 @@
+// 3GIM(V2) sample sketch for Mega/Leonardo.. -- httpGET(streaming)
+//   Response body is passed to Print(Serial here, or File of SD library) by block,
+//   so that the body larger than a3gsMAX_RESULT_LENGTH can be received.
+
+#include "a3gim2.h"
+
+#define baudrate 	9600UL
+
+const int powerPin = 7;     // 3gim power pin(If not using power control, 0 is set.)
+const char *server = "www.arduino.cc";
+const char *path = "";
+const int port = a3gsDEFAULT_PORT;
+
+// Print to count bytes and echo them to Serial
+class CountingPrint : public Print {
+  public:
+    uint32_t count = 0;
+    size_t write(uint8_t c) { count++; return Serial.write(c); }
+    size_t write(const uint8_t *buf, size_t sz) { count += sz; return Serial.write(buf, sz); }
+};
+
+void setup()
+{
+  CountingPrint body;
+
+  Serial.begin(baudrate);
+  delay(3000);  // Wait for Start Serial Monitor
+  Serial.println("Ready.");
+
+  Serial.print("Initializing.. ");
+  if (a3gs.start(powerPin) == 0 && a3gs.begin(0, baudrate) == 0) {
+    Serial.println("Succeeded.");
+    Serial.println("httpGET() requesting.. ");
+    Serial.print("[");
+    if (a3gs.httpGET(server, port, path, body, true) == 0) {
+      Serial.println("]");
+      Serial.print("OK! ");
+      Serial.print(body.count);
+      Serial.println(" bytes received.");
+    }
+    else {
+      Serial.println("]");
+      Serial.print("Can't get HTTP response from ");
+      Serial.println(server);
+    }
+  }
+  else
+    Serial.println("Failed.");
+
+  Serial.println("Shutdown..");
+  a3gs.end();
+  a3gs.shutdown();
+}
+
+void loop()
+{
+}
+
+// END
@@ -0,0 +1,72 @@
+// 3GIM(V2) sample sketch for Mega/Leonardo/Zero.. -- benchmark of binary write
+//   Write binary data(all byte values, so many bytes are escaped) and show throughput in bytes per second.
+//   Use any TCP server which accepts and discards data.
+//   The cost of escaping alone is measured on a host by gimcore/test(make -C gimcore/test).
+
+#include <a3gim2.h>
+
+#define baudrate 	        9600UL
+#define MAX_RETRY  3
+#define NUM_WRITES  10
+
+const int powerPin = 7;     // 3gim power pin(If not using power control, 0 is set.)
+const char *server = "tcpbin.com";  // TCP server to write data
+const int port = 4242;
+uint8_t data[a3gsMAX_DATA_LENGTH];
+
+void setup()
+{
+  Serial.begin(baudrate);
+  delay(100);  // Wait for Start Serial Monitor
+  Serial.println("Ready.");
+
+  for (int n = 0; n < (int)sizeof(data); n++)
+    data[n] = (uint8_t)n;   // 0x00..0xff
+
+  Serial.print("Initializing.. ");
+  if (a3gs.start(powerPin) == 0 && a3gs.begin(0, baudrate) == 0) {
+    Serial.println("Succeeded.");
+    // Connect to server
+    int nCount = 0;
+    while (nCount++ < MAX_RETRY && a3gs.connectTCP(server, port) != 0) {
+      Serial.println("connectTCP() can't connect, retry..");
+      delay(100);
+    }
+    if (nCount > MAX_RETRY) {
+      Serial.println("connectTCP() abort");
+      goto _end;
+    }
+    // Write data and measure time
+    uint32_t total = 0;
+    uint32_t startTime = millis();
+    for (int n = 0; n < NUM_WRITES; n++) {
+      int nbytes = a3gs.write(data, sizeof(data));
+      if (nbytes < 0) {
+        Serial.println("write() failed");
+        break;
+      }
+      total += nbytes;
+    }
+    uint32_t elapsed = millis() - startTime;
+    Serial.print(total);
+    Serial.print(" bytes in ");
+    Serial.print(elapsed);
+    Serial.print(" mS : ");
+    Serial.print(elapsed > 0 ? (total * 1000UL / elapsed) : 0);
+    Serial.println(" bytes/sec");
+    a3gs.disconnectTCP();
+  }
+  else
+    Serial.println("Failed.");
+
+ _end:
+  Serial.println("Shutdown..");
+  a3gs.end();
+  a3gs.shutdown();
+}
+
+void loop()
+{
+}
+
+// END
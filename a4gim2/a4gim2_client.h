@@ -0,0 +1,42 @@
+//***********************************************************
+//	a4gim2_client.h -- Arduino Client adapter of A4GS for Mega/Zero/M0..
+//
+//	History:
+//		R1.0 2026/10/19  1st Release
+//		R1.1 2026/10/19  A4GSClient is an instance of GIMClient(gimcore/gimclient.h), a4gim2_client.cpp is removed
+//
+//	Author:
+//		Open wireless Alliance and Atsushi Daikoku
+//
+//	Notes:
+//		Client compatible class over a4gs TCP/IP functions, so that libraries using Client
+//		(MQTT, HTTP..) can run on 4GIM(V1).
+//		- Received data is read ahead up to a4gsCLIENT_RX_BUFFER_SIZE bytes by one $TR command.
+//		- Written data is coalesced up to a4gsCLIENT_TX_BUFFER_SIZE bytes into one $TW command,
+//		  and sent by flush(), or before reading.
+//***********************************************************
+
+#ifndef _A4GIM2_CLIENT_H_
+#define _A4GIM2_CLIENT_H_
+
+#include <Arduino.h>
+#include <gimclient.h>
+#include "a4gim2.h"
+
+/*
+	Define constants
+*/
+#ifndef a4gsCLIENT_RX_BUFFER_SIZE
+#define	a4gsCLIENT_RX_BUFFER_SIZE		a4gsMAX_DATA_LENGTH	// Size of read-ahead buffer(max a4gsMAX_DATA_LENGTH)
+#endif
+#ifndef a4gsCLIENT_TX_BUFFER_SIZE
+#define	a4gsCLIENT_TX_BUFFER_SIZE		256			// Size of write coalescing buffer(max a4gsMAX_DATA_LENGTH)
+#endif
+
+/*
+	Declare class
+*/
+typedef GIMClient<A4GS, a4gs, a4gsCLIENT_RX_BUFFER_SIZE, a4gsCLIENT_TX_BUFFER_SIZE>	A4GSClient;
+	//-- Methods are defined in GIMClient(gimclient.h)
+
+#endif // _A4GIM2_CLIENT_H_
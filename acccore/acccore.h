@@ -0,0 +1,748 @@
+/*
+ *	acccore.h
+ *
+ *	Driver core of 3-axis accelerometers for Arduino (Interface and Implementation)
+ *
+ *	Version:
+ *		R1.0  2026.10.19  1st Release, factored out of lis2dw(R1.4) and mma8451q(R1.5)
+ *		R1.1  2026.10.19  Add time of each XYZ set drained from FIFO(AccBatch), ODR estimation and lost sets
+ *
+ *	Note:
+ *		Header only library, used by lis2dw and mma8451q.
+ *		AccCore is a template class parameterized by the register map(Map) of the device,
+ *		which has constants below(checked at compile time):
+ *		  - OUT_REG, MSB_FIRST, AXIS_X/Y/Z, RESOLUTION : output registers(first address, byte order,
+ *		    position of each axis and bits left-justified in 16-bit)
+ *		  - LSB_PER_G : LSB/g at the smallest range(power of 2), rangeIndex(range) : 0 for the smallest
+ *		    range and +1 for each doubled range
+ *		  - FIFO_SAMPLES, FIFO_STATUS_REG, FIFO_COUNT_MASK, FIFO_OVERRUN : FIFO(XYZ sets) and its status
+ *		  - INC_REG, INC_BIT : bit to enable auto increment of address(INC_BIT = 0 if always enabled)
+ *		  - RESET_REG, RESET_BITS : bits to reset the device(all registers return to default)
+ *		  - STANDBY_REG, ACTIVE_BIT : bit to be cleared to change other registers(ACTIVE_BIT = 0 if not needed)
+ *		  - SHADOW_BASE, SHADOW_REGS, SHADOW_WRITABLE : control registers kept in shadow
+ *		  - I2C_BUFFER_SIZE, STREAM_BLOCKS : size of Wire buffer and blocks kept in stream ring
+ *		  - ODR_REG, samplePeriod(reg) : register of ODR and its sample period [uS](0 if not sampling)
+ *		A new device gets register shadow, burst FIFO read, streaming and unit conversion
+ *		by defining its map and deriving the driver from AccCore<Map>.
+ *		Register fields are defined by AccField<Reg, Mask>, and the values are checked at compile time.
+ *
+ *		Timestamps:
+ *		  readFIFOBurst() and pollStream() read the FIFO count and the clock(micros() or setClock()) together.
+ *		  The newest set in FIFO was taken within one sample period before that time, so the time of
+ *		  each set is reconstructed backward by the period, and kept continuous from the previous drain
+ *		  as long as it stays in that bound. The period starts at the nominal ODR, and is replaced by
+ *		  the measured one(clock time / sets produced, over windows of accODR_WINDOW).
+ *		  When the FIFO overruns, the lost sets are counted from the time, and the batch is marked as gap.
+ *
+ *	Copyright(c) 2026 TABrain Inc.
+ */
+
+#ifndef _ACCCORE_
+#define _ACCCORE_
+
+#include <Arduino.h>
+#include <Wire.h>
+
+/*
+ *	Constants
+ */
+#define	accBARRIER()			__asm__ __volatile__("" ::: "memory")	// Keep order of memory access(single core)
+#define	accODR_WINDOW			(1UL << 30)	// Length of ODR measurement window [uS](about 18 minutes)
+#define	accODR_MIN_SETS			1024		// XYZ sets in window to replace the period measured in the previous one
+#define	accODR_TOLERANCE		8			// Measured period is used only within nominal +/- 1/8
+#define	accMAX_LOST				0xffff		// Maximum of AccBatch.lost
+
+/*
+ *	Time of XYZ sets read at once(batch)
+ *		Time of set k is time + k * period / 256 [uS], see AccCore<Map>::sampleTime()
+ */
+typedef struct {
+	uint32_t	time;				// Time of the first set [uS]
+	uint32_t	period;				// Sample period [1/256 uS](0 if ODR is unknown)
+	uint16_t	samples;			// Number of XYZ sets
+	uint16_t	lost;				// XYZ sets lost just before the first set(estimated from time if FIFO overran)
+	bool	gap;					// Sets were lost or ODR was changed before the first set
+} AccBatch;
+
+/*
+ *	Compile time helpers
+ */
+template <bool Cond, class T, class F> struct AccSelect { typedef T type; };
+template <class T, class F> struct AccSelect<false, T, F> { typedef F type; };
+
+struct AccBits {
+	static constexpr int lowest(uint32_t mask) { return ((mask & 1) ? 0 : 1 + lowest(mask >> 1)); }	// mask != 0
+	static constexpr int log2(uint32_t value) { return ((value <= 1) ? 0 : 1 + log2(value >> 1)); }
+	static constexpr bool isPowerOf2(uint32_t value) { return (value != 0 && (value & (value - 1)) == 0); }
+};
+
+/*
+ *	Register field
+ *		ex. AccField<s2REG_FIFO_CTRL, s2FIFO_CTRL_FTH_MASK>::field<16>() .. 16 is checked to fit in the field
+ *		    AccField<s2REG_CTRL6, s2CTRL6_FS_MASK>::bits<s2FS_4G>() .. s2FS_4G is checked to be in the mask
+ */
+template <uint8_t Reg, uint8_t Mask>
+struct AccField {
+	static_assert(Mask != 0, "Mask of field must not be 0");
+	static constexpr uint8_t REG = Reg;
+	static constexpr uint8_t MASK = Mask;
+	static constexpr int SHIFT = AccBits::lowest(Mask);
+	static constexpr uint8_t MAX = Mask >> AccBits::lowest(Mask);
+	static_assert(((MAX + 1) & MAX) == 0, "Bits of field must be contiguous");
+
+	template <uint8_t V> static constexpr uint8_t field(void) {
+		static_assert(V <= MAX, "Value does not fit in the field");
+		return (V << SHIFT);
+	}												// Encode field value(checked at compile time)
+	template <uint8_t V> static constexpr uint8_t bits(void) {
+		static_assert((V & ~Mask) == 0, "Bits are out of the field");
+		return (V);
+	}												// Register bits(checked at compile time)
+	static uint8_t encode(int value) {
+		return ((value < 0) ? 0 : (value > MAX) ? (MAX << SHIFT) : (value << SHIFT));
+	}												// Encode field value(saturated at run time)
+	static int decode(uint8_t reg) { return ((reg & Mask) >> SHIFT); }	// Decode field value from register
+};
+
+/*
+ *	AccCore class
+ */
+template <class Map>
+class AccCore {
+	static_assert(Map::RESOLUTION > 0 && Map::RESOLUTION <= 16, "RESOLUTION must be 1..16");
+	static_assert(AccBits::isPowerOf2(Map::LSB_PER_G) && Map::LSB_PER_G >= 8 && Map::LSB_PER_G <= 65536, "LSB_PER_G must be power of 2(8..65536)");
+	static_assert(Map::AXIS_X < 3 && Map::AXIS_Y < 3 && Map::AXIS_Z < 3 && Map::AXIS_X + Map::AXIS_Y + Map::AXIS_Z == 3, "AXIS_X/Y/Z must be 0..2");
+	static_assert(Map::FIFO_SAMPLES > 0 && Map::FIFO_SAMPLES <= 255, "FIFO_SAMPLES must be 1..255");
+	static_assert(Map::SHADOW_REGS > 0 && Map::SHADOW_REGS <= 64, "SHADOW_REGS must be 1..64");
+	static_assert(Map::I2C_BUFFER_SIZE >= 6, "I2C_BUFFER_SIZE must be 6 or more");
+	static_assert(AccBits::isPowerOf2(Map::STREAM_BLOCKS) && Map::STREAM_BLOCKS <= 128, "STREAM_BLOCKS must be power of 2(up to 128)");
+
+  public:
+	typedef typename AccSelect<(Map::SHADOW_REGS > 32), uint64_t, uint32_t>::type ShadowMask;
+	static const int BURST_SAMPLES = ((Map::I2C_BUFFER_SIZE / 6) < Map::FIFO_SAMPLES) ? (Map::I2C_BUFFER_SIZE / 6) : Map::FIFO_SAMPLES;
+		/* XYZ sets read by one I2C transaction(6 bytes per set) */
+
+	AccCore(uint8_t i2cAddress);
+	uint8_t readRegister(uint8_t reg);				// Read byte data from a register
+	void readMultiRegisters(uint8_t reg, int bytes, uint8_t data[]);	// Read multi bytes data from registers
+	void writeRegister(uint8_t reg, uint8_t data);	// Write byte data to a register
+	void updateRegister(uint8_t reg, uint8_t mask, uint8_t data);	// Change "mask" bits of a register to "data"(write only if changed)
+	void stageRegister(uint8_t reg, uint8_t mask, uint8_t data);	// Change "mask" bits in shadow only(written by applyConfig())
+	int applyConfig(void);							// Write staged registers(contiguous ones by one burst, in standby if needed)
+	uint8_t getShadowRegister(uint8_t reg);			// Get register value from shadow(read once if unknown)
+	void invalidateShadow(void) { _shadowValid = _shadowDirty = 0; }	// Forget shadow(ex. the device was reset outside)
+	template <class F> void updateField(int value) { updateRegister(F::REG, F::MASK, F::encode(value)); }	// Change a field
+	template <class F> void stageField(int value) { stageRegister(F::REG, F::MASK, F::encode(value)); }	// Change a field in shadow only
+	template <class F> int getField(void) { return (F::decode(getShadowRegister(F::REG))); }	// Get a field
+
+	int getAccelerations(int *ax, int *ay, int *az); // Get 3-axis accelerations
+	int getFIFOEntries(void) { return ((readRegister(Map::FIFO_STATUS_REG) & Map::FIFO_COUNT_MASK)); }	// Get number of XYZ sets in FIFO
+	int readFIFO(int samples[], int numSamples);	// Read data from FIFO
+	int readFIFOBurst(int16_t data[], int maxSamples, AccBatch *batch = NULL);
+													// Read all samples in FIFO by burst transfer(data[] is X,Y,Z,X,..), and their time
+	uint32_t getShortReads(void) { return _shortReads; }	// Number of transactions which returned less bytes than requested
+
+	void onWatermark(void) { _watermark = true; }	// Call from FIFO watermark interrupt handler(no I2C transaction)
+	int pollStream(void);							// Drain FIFO into ring if watermark is reached(call from loop() or yield())
+	int availableStream(void) { return ((uint16_t)(_ringHead - _ringTail)); }	// Number of XYZ sets in ring
+	int readStream(int16_t data[], int maxSamples, uint32_t *timestamp = NULL, bool *gap = NULL);
+													// Read XYZ sets of a block from ring(timestamp[uS] is of the last set read)
+	int readStream(int16_t data[], int maxSamples, AccBatch *batch);	// Read XYZ sets of a block from ring, and their time
+	uint32_t getFIFOOverruns(void) { return _fifoOverruns; }	// Number of FIFO overruns(samples were lost in the device)
+	uint32_t getRingOverruns(void) { return _ringOverruns; }	// Number of XYZ sets discarded because ring was full
+
+	void setClock(uint32_t (*clock)(void)) { _clock = clock; resetTiming(); }	// Time source [uS](NULL: micros())
+	void resetTiming(void);							// Forget time of sets and measured period(ex. FIFO was read outside)
+	uint32_t getSamplePeriod(void) { return _period; }	// Sample period [1/256 uS](nominal until measured, 0 if unknown)
+	uint32_t getEstimatedODR(void) { return ((_period == 0) ? 0 : (uint32_t)(256000000000ULL / _period)); }	// ODR [mHz]
+	uint32_t getLostSamples(void) { return _lostTotal; }	// Number of XYZ sets lost(FIFO overrun and discarded)
+	static uint32_t sampleTime(const AccBatch *batch, int index) {
+		return (batch->time + (uint32_t)(((uint64_t)index * batch->period) >> 8));
+	}												// Time of set "index" in batch [uS]
+
+	static int toRaw(uint8_t high, uint8_t low) {
+		int8_t signedHigh = high;
+		return ((((int)signedHigh << 8) + low) >> (16 - Map::RESOLUTION));
+	}												// Convert to raw acceleration
+	static int tomg(int raw, int range) {
+		int32_t v = (int32_t)raw * 125;
+		int shift = mgShift(range);
+		return ((v + ((v >> 31) & ((1L << shift) - 1))) >> shift);
+	}												// Convert raw to mg(truncated toward zero)
+	static void toRaw(const uint8_t data[], int16_t raw[], int n);	// Convert n values of OUT_* bytes to raw
+	static void tomg(const int16_t raw[], int16_t mg[], int n, int range);	// Convert n values to mg(mg[] may be raw[])
+	static void tog(const int16_t raw[], int32_t g[], int n, int range);	// Convert n values to g in Q16.16 fixed-point
+		/* 1mg is 125/LSB_PER_G*8 LSB at the smallest range, and each range doubles it.
+		   So that conversion is done by a multiply and a shift, without float division.
+		 */
+
+  protected:
+	uint8_t	_i2cAddress;
+	int startStream(int16_t buffer[], int samples);	// Set ring and clear it
+	void stopStream(void) { _ring = NULL; }
+	void enableAddressIncrement(void) {
+		if (Map::INC_BIT != 0)
+			updateRegister(Map::INC_REG, Map::INC_BIT, Map::INC_BIT);
+	}												// Set auto increment bit if not yet
+	int burstRead(int16_t data[], int numSamples);	// Read XYZ sets from FIFO by one transaction
+	void discardFIFO(int numSamples);				// Read XYZ sets from FIFO and discard them
+	static ShadowMask shadowBit(uint8_t reg) {
+		uint8_t n = reg - Map::SHADOW_BASE;
+		return ((n < Map::SHADOW_REGS) ? (((ShadowMask)1 << n) & (ShadowMask)Map::SHADOW_WRITABLE) : 0);
+	}												// Bit of register in shadow masks(0 if not kept)
+	static int mgShift(int range) { return (AccBits::log2(Map::LSB_PER_G) - 3 - Map::rangeIndex(range)); }
+	static int gShift(int range) { return (16 - AccBits::log2(Map::LSB_PER_G) + Map::rangeIndex(range)); }
+	uint32_t now(void) { return ((_clock != NULL) ? _clock() : (uint32_t)micros()); }
+	void countFIFO(uint8_t status, uint32_t time);	// Advance time to the newest set in FIFO(status is read at "time")
+	void takeBatch(int samples, AccBatch *batch);	// Time of sets read from FIFO(oldest first)
+	void dropBatch(int samples);					// Sets read from FIFO and discarded
+
+  private:
+	uint32_t	_shortReads;
+	uint8_t	_shadow[Map::SHADOW_REGS];	// Shadow of control registers
+	ShadowMask	_shadowValid;			// Registers whose value in shadow is known(bit n is register SHADOW_BASE+n)
+	ShadowMask	_shadowDirty;			// Registers staged but not yet written
+	int16_t	*_ring;						// Sample ring(X,Y,Z,X..), NULL if not streaming
+	uint16_t	_ringSize;				// Number of XYZ sets in ring(power of 2)
+	volatile uint16_t	_ringHead;		// XYZ sets written(by pollStream())
+	volatile uint16_t	_ringTail;		// XYZ sets read(by readStream())
+	struct {
+		uint32_t	time;				// Time of the first set in block [uS]
+		uint32_t	period;				// Sample period [1/256 uS]
+		uint16_t	lost;				// XYZ sets lost before this block
+		uint8_t	samples;				// Number of XYZ sets in block
+		bool	gap;					// Samples were lost before this block
+	} _blocks[Map::STREAM_BLOCKS];
+	volatile uint8_t	_blockHead, _blockTail;	// Blocks written/read
+	uint8_t	_blockOffset;				// XYZ sets already read in the oldest block
+	volatile bool	_watermark;			// FIFO watermark interrupt occurred
+	uint32_t	_fifoOverruns;
+	uint32_t	_ringOverruns;
+	// Time of sets
+	uint32_t	(*_clock)(void);		// Time source [uS](NULL: micros())
+	uint32_t	_nominal;				// Sample period of ODR register [1/256 uS](0 if not sampling)
+	uint32_t	_period;				// Sample period, measured or nominal [1/256 uS]
+	uint32_t	_lastTime;				// Time of the newest set counted [uS]
+	uint8_t	_lastFraction;				// and its fraction [1/256 uS]
+	uint8_t	_pending;					// Sets counted but not yet read from FIFO
+	bool	_timeValid;					// _lastTime and _pending are valid
+	bool	_timeGap;					// Continuity is lost before the next batch
+	uint16_t	_lost;					// Sets lost before the next batch
+	uint32_t	_lostTotal;
+	uint32_t	_windowStart;			// Start of ODR measurement window [uS]
+	uint32_t	_windowSets;			// Sets produced in window
+	uint16_t	_windowMinSets;			// Sets needed in window to use its period
+};
+
+/*
+ *	Public methods
+ */
+
+template <class Map>
+AccCore<Map>::AccCore(uint8_t i2cAddress) {
+	_i2cAddress = i2cAddress;
+	_shortReads = 0;
+	_shadowValid = _shadowDirty = 0;
+	_ring = NULL;
+	_ringSize = _ringHead = _ringTail = 0;
+	_blockHead = _blockTail = _blockOffset = 0;
+	_watermark = false;
+	_fifoOverruns = _ringOverruns = 0;
+	_clock = NULL;
+	_lostTotal = 0;
+	resetTiming();
+}
+
+template <class Map>
+uint8_t AccCore<Map>::readRegister(uint8_t reg) {
+	Wire.beginTransmission(_i2cAddress);
+	Wire.write(reg);
+	Wire.endTransmission(false); 	// uses repeated start
+	Wire.requestFrom(_i2cAddress, (uint8_t)1);
+	if (! Wire.available())
+		return (0xff);		// error
+	return (Wire.read());
+}
+
+template <class Map>
+void AccCore<Map>::readMultiRegisters(uint8_t reg, int bytes, uint8_t data[]) {
+	enableAddressIncrement();		// no I2C transaction if known to be set
+
+	Wire.beginTransmission(_i2cAddress);
+	Wire.write(reg);
+	Wire.endTransmission(false); 	// uses repeated start
+	Wire.requestFrom(_i2cAddress, (uint8_t)bytes);
+	while (bytes-- > 0) {
+		if (! Wire.available())
+			*data++ = 0xff;			// read error
+		else
+			*data++ = Wire.read();
+	}
+}
+
+template <class Map>
+void AccCore<Map>::writeRegister(uint8_t reg, uint8_t data) {
+	bool reset = (reg == Map::RESET_REG && (data & Map::RESET_BITS));
+	if (Map::INC_BIT != 0 && reg == Map::INC_REG && ! reset)
+		data |= Map::INC_BIT;		// auto increment is always enabled
+	Wire.beginTransmission(_i2cAddress);
+	Wire.write(reg);
+	Wire.write(data);
+	Wire.endTransmission();
+
+	ShadowMask bit = shadowBit(reg);
+	if (reset)
+		invalidateShadow();		// all registers return to default
+	else if (bit) {
+		_shadow[reg - Map::SHADOW_BASE] = data;
+		_shadowValid |= bit;
+		_shadowDirty &= ~bit;
+	}
+}
+
+template <class Map>
+void AccCore<Map>::updateRegister(uint8_t reg, uint8_t mask, uint8_t data) {
+	uint8_t current = (mask == 0xff) ? 0 : getShadowRegister(reg);
+	uint8_t value = (current & ~mask) | (data & mask);
+	ShadowMask bit = shadowBit(reg);
+	if (mask == 0xff || value != current || ! (bit & _shadowValid) || (bit & _shadowDirty))
+		writeRegister(reg, value);
+}
+
+template <class Map>
+void AccCore<Map>::stageRegister(uint8_t reg, uint8_t mask, uint8_t data) {
+	ShadowMask bit = shadowBit(reg);
+	if (! bit) {
+		updateRegister(reg, mask, data);	// not kept in shadow, so write now
+		return;
+	}
+	uint8_t current = (mask == 0xff) ? 0 : getShadowRegister(reg);	// no need to know if all bits are changed
+	_shadow[reg - Map::SHADOW_BASE] = (current & ~mask) | (data & mask);
+	_shadowValid |= bit;
+	_shadowDirty |= bit;
+}
+
+template <class Map>
+int AccCore<Map>::applyConfig(void) {
+	const ShadowMask one = 1;
+	int rc = 0;
+
+	// Other registers can be changed only in standby mode(if the device needs)
+	const int standby = Map::STANDBY_REG - Map::SHADOW_BASE;
+	ShadowMask standbyBit = (Map::ACTIVE_BIT != 0) ? shadowBit(Map::STANDBY_REG) : 0;
+	uint8_t active = 0;		// value to be set at last
+	if (standbyBit && (_shadowDirty & ~standbyBit)) {
+		active = getShadowRegister(Map::STANDBY_REG);
+		if ((active & Map::ACTIVE_BIT) || (_shadowDirty & standbyBit) || ! (_shadowValid & standbyBit))
+			writeRegister(Map::STANDBY_REG, active & ~Map::ACTIVE_BIT);
+		_shadow[standby] = active & ~Map::ACTIVE_BIT;
+	}
+	else
+		standbyBit = 0;
+
+	enableAddressIncrement();		// needed for burst, staged register of auto increment is written here if any
+
+	for (int n = 0; n < Map::SHADOW_REGS; ) {
+		if (! (_shadowDirty & (one << n))) {
+			n++;
+			continue;
+		}
+		// Write contiguous staged registers by one burst(limited by Wire buffer)
+		Wire.beginTransmission(_i2cAddress);
+		Wire.write(Map::SHADOW_BASE + n);
+		for (int i = 0; n < Map::SHADOW_REGS && (_shadowDirty & (one << n)) && i < Map::I2C_BUFFER_SIZE - 1; i++, n++) {
+			Wire.write(_shadow[n]);
+			_shadowDirty &= ~(one << n);
+			_shadowValid |= (one << n);
+		}
+		uint8_t status = Wire.endTransmission();
+		if (rc == 0)
+			rc = status;
+	}
+
+	if (standbyBit && _shadow[standby] != active)
+		writeRegister(Map::STANDBY_REG, active);	// back to active mode
+
+	return (rc);	// 0: OK, otherwise status of endTransmission()
+}
+
+template <class Map>
+uint8_t AccCore<Map>::getShadowRegister(uint8_t reg) {
+	ShadowMask bit = shadowBit(reg);
+	if (! bit)
+		return (readRegister(reg));		// not kept in shadow
+	if (! (_shadowValid & bit)) {
+		_shadow[reg - Map::SHADOW_BASE] = readRegister(reg);
+		_shadowValid |= bit;
+	}
+	return (_shadow[reg - Map::SHADOW_BASE]);
+}
+
+template <class Map>
+int AccCore<Map>::getAccelerations(int *ax, int *ay, int *az) {
+	uint8_t data[6];
+	for (int i = 0; i < 6; i++)
+		data[i] = 0;
+	readMultiRegisters(Map::OUT_REG, 6, data);
+	int16_t raw[3];
+	toRaw(data, raw, 3);
+	*ax = raw[Map::AXIS_X];
+	*ay = raw[Map::AXIS_Y];
+	*az = raw[Map::AXIS_Z];
+
+	return 0;	// OK
+}
+
+template <class Map>
+int AccCore<Map>::readFIFO(int samples[], int numSamples) {
+	int16_t data[3 * BURST_SAMPLES];
+	int m = 0;
+
+	resetTiming();		// sets are read without FIFO count, so time of them is unknown
+	enableAddressIncrement();
+	while (m < numSamples) {
+		int n = numSamples - m;
+		if (n > BURST_SAMPLES)
+			n = BURST_SAMPLES;
+		int got = burstRead(data, n);
+		for (int i = 0; i < got * 3; i++)
+			samples[m * 3 + i] = data[i];
+		m += got;
+		if (got < n)
+			break;		// short read
+	}
+
+	return (m);		// return number of read samples
+}
+
+template <class Map>
+int AccCore<Map>::readFIFOBurst(int16_t data[], int maxSamples, AccBatch *batch) {
+	uint8_t status = readRegister(Map::FIFO_STATUS_REG);
+	countFIFO(status, now());
+	int entries = status & Map::FIFO_COUNT_MASK;
+	if (entries > maxSamples)
+		entries = maxSamples;
+
+	enableAddressIncrement();
+	int m = 0;
+	while (m < entries) {
+		int n = entries - m;
+		if (n > BURST_SAMPLES)
+			n = BURST_SAMPLES;
+		int got = burstRead(data + m * 3, n);
+		m += got;
+		if (got < n)
+			break;		// short read, the rest is left in FIFO
+	}
+	if (m > 0)
+		takeBatch(m, batch);
+	else if (batch != NULL)
+		batch->samples = 0;
+
+	return (m);		// return number of read samples
+}
+
+template <class Map>
+int AccCore<Map>::pollStream(void) {
+	if (_ring == NULL || ! _watermark)
+		return (0);		// nothing to do(no I2C transaction)
+	_watermark = false;		// set again if interrupt occurs while draining
+
+	uint8_t status = readRegister(Map::FIFO_STATUS_REG);
+	countFIFO(status, now());	// the last set in FIFO was taken within 1/ODR before
+	int entries = status & Map::FIFO_COUNT_MASK;
+	if (entries == 0)
+		return (0);
+
+	uint16_t head = _ringHead;
+	uint8_t blockHead = _blockHead;
+	if (_ringSize - (uint16_t)(head - _ringTail) < entries || (uint8_t)(blockHead - _blockTail) >= Map::STREAM_BLOCKS) {
+		// Ring is full, so read and discard samples to keep watermark interrupt working
+		discardFIFO(entries);
+		dropBatch(entries);
+		_ringOverruns += entries;
+		return (0);
+	}
+
+	enableAddressIncrement();
+	int m = 0;
+	while (m < entries) {
+		int index = (head + m) & (_ringSize - 1);
+		int n = entries - m;
+		if (n > BURST_SAMPLES)
+			n = BURST_SAMPLES;
+		if (n > _ringSize - index)
+			n = _ringSize - index;		// up to the end of ring
+		int got = burstRead(_ring + index * 3, n);
+		m += got;
+		if (got < n) {
+			_watermark = true;		// short read, try again at next call
+			break;
+		}
+	}
+	if (m == 0)
+		return (0);
+
+	// Publish the block after samples are written
+	AccBatch batch;
+	takeBatch(m, &batch);
+	uint8_t b = blockHead & (Map::STREAM_BLOCKS - 1);
+	_blocks[b].time = batch.time;
+	_blocks[b].period = batch.period;
+	_blocks[b].lost = batch.lost;
+	_blocks[b].samples = m;
+	_blocks[b].gap = batch.gap;
+	accBARRIER();
+	_ringHead = head + m;
+	_blockHead = blockHead + 1;
+
+	return (m);		// return number of XYZ sets moved into ring
+}
+
+template <class Map>
+int AccCore<Map>::readStream(int16_t data[], int maxSamples, uint32_t *timestamp, bool *gap) {
+	AccBatch batch;
+	int n = readStream(data, maxSamples, &batch);
+	if (n > 0) {
+		if (timestamp != NULL)
+			*timestamp = sampleTime(&batch, n - 1);
+		if (gap != NULL)
+			*gap = batch.gap;
+	}
+
+	return (n);		// return number of read XYZ sets
+}
+
+template <class Map>
+int AccCore<Map>::readStream(int16_t data[], int maxSamples, AccBatch *batch) {
+	uint8_t blockTail = _blockTail;
+	if (blockTail == _blockHead)
+		return (0);		// no block
+	accBARRIER();
+
+	uint8_t b = blockTail & (Map::STREAM_BLOCKS - 1);
+	int n = _blocks[b].samples - _blockOffset;
+	if (n > maxSamples)
+		n = maxSamples;		// the rest is returned by next call
+	uint16_t tail = _ringTail;
+	for (int i = 0; i < n; i++) {
+		const int16_t *sample = _ring + ((tail + i) & (_ringSize - 1)) * 3;
+		*data++ = sample[0];
+		*data++ = sample[1];
+		*data++ = sample[2];
+	}
+	if (batch != NULL) {
+		batch->period = _blocks[b].period;
+		batch->time = _blocks[b].time + (uint32_t)(((uint64_t)_blockOffset * batch->period) >> 8);
+		batch->samples = n;
+		batch->lost = (_blockOffset == 0) ? _blocks[b].lost : 0;
+		batch->gap = (_blockOffset == 0) && _blocks[b].gap;
+	}
+
+	// Release samples(and block) after they are copied
+	accBARRIER();
+	_ringTail = tail + n;
+	_blockOffset += n;
+	if (_blockOffset >= _blocks[b].samples) {
+		_blockOffset = 0;
+		_blockTail = blockTail + 1;
+	}
+
+	return (n);		// return number of read XYZ sets
+}
+
+template <class Map>
+void AccCore<Map>::resetTiming(void) {
+	_nominal = _period = 0;		// read from ODR register at next drain
+	_lastTime = 0;
+	_lastFraction = _pending = 0;
+	_timeValid = _timeGap = false;
+	_lost = 0;
+	_windowStart = _windowSets = 0;
+	_windowMinSets = Map::FIFO_SAMPLES;
+}
+
+template <class Map>
+void AccCore<Map>::toRaw(const uint8_t data[], int16_t raw[], int n) {
+	const int high = Map::MSB_FIRST ? 0 : 1;
+	for (int i = 0; i < n; i++, data += 2)
+		raw[i] = (int16_t)(((uint16_t)data[high] << 8) | data[1 - high]) >> (16 - Map::RESOLUTION);
+}
+
+template <class Map>
+void AccCore<Map>::tomg(const int16_t raw[], int16_t mg[], int n, int range) {
+	const int shift = mgShift(range);		// mg = raw * 125 / 2^shift
+	const int32_t round = (1L << shift) - 1;
+	for (int i = 0; i < n; i++) {
+		int32_t v = (int32_t)raw[i] * 125;
+		mg[i] = (v + ((v >> 31) & round)) >> shift;	// truncate toward zero as tomg(raw, range)
+	}
+}
+
+template <class Map>
+void AccCore<Map>::tog(const int16_t raw[], int32_t g[], int n, int range) {
+	const int shift = gShift(range);		// g = raw / LSB_PER_G * 2^16
+	for (int i = 0; i < n; i++)
+		g[i] = (int32_t)raw[i] * (1L << shift);
+}
+
+/*
+ *	Protected methods
+ */
+
+template <class Map>
+int AccCore<Map>::startStream(int16_t buffer[], int samples) {
+	if (buffer == NULL || samples < Map::FIFO_SAMPLES || (samples & (samples - 1)) != 0)
+		return (-1);	// bad parameter
+
+	_ring = buffer;
+	_ringSize = samples;
+	_ringHead = _ringTail = 0;
+	_blockHead = _blockTail = _blockOffset = 0;
+	_watermark = false;
+	resetTiming();		// FIFO is cleared by the driver
+
+	return (0);		// OK
+}
+
+template <class Map>
+int AccCore<Map>::burstRead(int16_t data[], int numSamples) {
+	// Output registers are read repeatedly, address rolls back to the first one while FIFO is enabled
+	Wire.beginTransmission(_i2cAddress);
+	Wire.write(Map::OUT_REG);
+	Wire.endTransmission(false); 	// uses repeated start
+	Wire.requestFrom(_i2cAddress, (uint8_t)(numSamples * 6));
+
+	int n;
+	for (n = 0; n < numSamples && Wire.available() >= 6; n++) {
+		uint8_t bytes[6];
+		int16_t raw[3];
+		for (int i = 0; i < 6; i++)
+			bytes[i] = Wire.read();
+		toRaw(bytes, raw, 3);
+		*data++ = raw[Map::AXIS_X];
+		*data++ = raw[Map::AXIS_Y];
+		*data++ = raw[Map::AXIS_Z];
+	}
+	if (n < numSamples) {
+		_shortReads++;
+		while (Wire.available())
+			Wire.read();	// discard partial set
+	}
+
+	return (n);
+}
+
+template <class Map>
+void AccCore<Map>::discardFIFO(int numSamples) {
+	int16_t data[3 * BURST_SAMPLES];
+
+	enableAddressIncrement();
+	while (numSamples > 0) {
+		int n = (numSamples > BURST_SAMPLES) ? BURST_SAMPLES : numSamples;
+		if (burstRead(data, n) < n)
+			break;		// short read
+		numSamples -= n;
+	}
+}
+
+template <class Map>
+void AccCore<Map>::countFIFO(uint8_t status, uint32_t time) {
+	int entries = status & Map::FIFO_COUNT_MASK;
+	bool overrun = (status & Map::FIFO_OVERRUN) != 0;
+	if (overrun) {
+		_fifoOverruns++;
+		_timeGap = true;		// lost sets are counted below if time of the previous set is known
+	}
+
+	uint32_t nominal = Map::samplePeriod(getShadowRegister(Map::ODR_REG)) << 8;	// no I2C transaction if known
+	if (nominal != _nominal) {
+		if (_timeValid)
+			_timeGap = true;		// ODR was changed
+		_nominal = _period = nominal;
+		_timeValid = false;
+	}
+	if (_period == 0) {
+		_lastTime = time;		// not sampling periodically, so time of sets is unknown
+		_lastFraction = 0;
+		_pending = entries;
+		return;
+	}
+
+	int32_t offset;		// time of the newest set in FIFO - "time" [1/256 uS], -period < offset <= 0
+	if (! _timeValid) {
+		offset = -(int32_t)(_period / 2);		// middle of the bound
+		_windowStart = time;
+		_windowSets = 0;
+		_windowMinSets = Map::FIFO_SAMPLES;
+		_timeValid = true;
+	}
+	else {
+		int64_t since = ((int64_t)(time - _lastTime) << 8) - _lastFraction;	// from the newest set counted
+		int32_t produced;
+		if (overrun || entries < _pending) {
+			// Sets were overwritten(or read outside), so count them from time, and measure again
+			produced = (int32_t)(since / _period);	// "time" is 1/2 period after the newest set on average
+			int32_t lost = produced + _pending - entries;
+			if (lost > 0) {
+				_lost = (_lost + lost > accMAX_LOST) ? accMAX_LOST : _lost + lost;
+				_lostTotal += lost;
+			}
+			if (_windowSets > _windowMinSets)
+				_windowMinSets = (_windowSets < accODR_MIN_SETS) ? _windowSets : accODR_MIN_SETS;	// keep the better period
+			_windowStart = time;
+			_windowSets = 0;
+		}
+		else {
+			produced = entries - _pending;
+			_windowSets += produced;
+			uint32_t span = time - _windowStart;
+			if (_windowSets >= _windowMinSets) {
+				uint32_t period = (uint32_t)(((uint64_t)span << 8) / _windowSets);
+				if (period > _nominal - _nominal / accODR_TOLERANCE && period < _nominal + _nominal / accODR_TOLERANCE)
+					_period = period;
+			}
+			if (span >= accODR_WINDOW) {
+				_windowStart = time;	// next window, the period is kept until it has enough sets
+				_windowSets = 0;
+				_windowMinSets = accODR_MIN_SETS;
+			}
+		}
+		// Continue from the previous set by the period, within the bound
+		int64_t predicted = (int64_t)produced * _period - since;
+		if (predicted > 0)
+			predicted = 0;
+		else if (predicted <= -(int64_t)_period)
+			predicted = 1 - (int64_t)_period;
+		offset = (int32_t)predicted;
+	}
+	_lastTime = time + (offset >> 8);		// floor
+	_lastFraction = offset & 0xff;
+	_pending = entries;
+}
+
+template <class Map>
+void AccCore<Map>::takeBatch(int samples, AccBatch *batch) {
+	if (batch != NULL) {
+		// The oldest set in FIFO is read first
+		int64_t offset = (int64_t)_lastFraction - (int64_t)(_pending - 1) * _period;
+		batch->time = _lastTime + (int32_t)(offset >> 8);
+		batch->period = _period;
+		batch->samples = samples;
+		batch->lost = _lost;
+		batch->gap = _timeGap;
+	}
+	_lost = 0;
+	_timeGap = false;
+	_pending = (samples < _pending) ? _pending - samples : 0;
+}
+
+template <class Map>
+void AccCore<Map>::dropBatch(int samples) {
+	_lost = (_lost + samples > accMAX_LOST) ? accMAX_LOST : _lost + samples;
+	_lostTotal += samples;
+	_timeGap = true;
+	_pending = (samples < _pending) ? _pending - samples : 0;
+}
+
+#endif // _ACCCORE_
@@ -17,7 +17,9 @@
  *  Symbols
  */
 #define DBG_SERIAL          SerialUSB           // シリアルモニタに対応するシリアルポート
-#define MAX_RETRY_POST      5                   // HTTP/POSTの最大リトライ回数
+#define BATCH_URL_FORMAT    "http://54.65.206.59/api/v2/channels/%d/dataarray"    // 複数サンプルを一括して送るAPI
+#define BATCH_TRAILER       "]}"                // バッチのBodyの末尾
+#define SAMPLE_PREFIX       "{\"created\":\""  // サンプルの先頭("created"の値が続く)
   // デバッグ用マクロ
 #if AMBIENT_DEBUG
 #define DBG(...) { DBG_SERIAL.print(__VA_ARGS__); }
@@ -27,6 +29,235 @@
 #define ERR(...)
 #endif /* AMBIENT_DBG */
 
+/*
+ *  Local functions
+ */
+  // 日時を1970/1/1 00:00:00からの秒数に変換する
+static uint32_t toEpochSeconds(int year, int month, int day, int hours, int minutes, int seconds) {
+    year -= (month <= 2);
+    int era = year / 400;
+    int yoe = year - era * 400;
+    int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    uint32_t days = era * 146097 + doe - 719468;
+    return (days * 86400UL + hours * 3600UL + minutes * 60UL + seconds);
+}
+
+  // 0詰めの固定桁数で数値を書き込む
+static char *putDigits(char *p, uint32_t value, int width) {
+    for (int i = width - 1; i >= 0; i--, value /= 10)
+        p[i] = '0' + value % 10;
+    return (p + width);
+}
+
+  // 1970/1/1 00:00:00からのミリ秒数を"YYYY-MM-DD hh:mm:ss.sss"の形式に変換する('\0'終端しない)
+static void formatDateTime(uint64_t ms, char *datetime) {
+    uint32_t seconds = ms / 1000;
+    int32_t z = seconds / 86400 + 719468;
+    int era = z / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    int day = doy - (153 * mp + 2) / 5 + 1;
+    int month = mp < 10 ? mp + 3 : mp - 9;
+    int year = yoe + era * 400 + (month <= 2);
+    uint32_t tod = seconds % 86400;
+    char *p = datetime;
+    p = putDigits(p, year, 4);
+    *p++ = '-';
+    p = putDigits(p, month, 2);
+    *p++ = '-';
+    p = putDigits(p, day, 2);
+    *p++ = ' ';
+    p = putDigits(p, tod / 3600, 2);
+    *p++ = ':';
+    p = putDigits(p, tod / 60 % 60, 2);
+    *p++ = ':';
+    p = putDigits(p, tod % 60, 2);
+    *p++ = '.';
+    putDigits(p, ms % 1000, 3);
+}
+
+/**
+ *  @fn
+ *
+ *  整数を10進数の文字列に変換する
+ *
+ *	@param(buffer)       変換した文字列の格納先
+ *	@param(size)         bufferのサイズ('\0'を含む)[Bytes]
+ *	@param(value)        変換する値
+ *  @return              0～:成功時(文字列の長さ)、-1:bufferに入らない
+ *  @detail              ヒープを使わない(String()の代わり)
+ */
+int amFormatInteger(char *buffer, int size, long value) {
+    char digits[12];
+    int n = 0;
+    unsigned long v = (value < 0) ? 0UL - (unsigned long)value : (unsigned long)value;
+    do {
+        digits[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v != 0);
+    if (value < 0)
+        digits[n++] = '-';
+    if (n >= size)
+        return (-1);
+
+    for (int i = 0; i < n; i++)
+        buffer[i] = digits[n - 1 - i];
+    buffer[n] = '\0';
+
+    return (n);
+}
+
+/**
+ *  @fn
+ *
+ *  実数を固定小数点形式の文字列に変換する
+ *
+ *	@param(buffer)       変換した文字列の格納先
+ *	@param(size)         bufferのサイズ('\0'を含む)[Bytes]
+ *	@param(value)        変換する値
+ *	@param(decimals)     小数点以下の桁数(0～6、四捨五入する)
+ *  @return              0～:成功時(文字列の長さ)、-1:bufferに入らない、または変換できない値
+ *  @detail              ヒープを使わない(String()の代わり)。NaNや極端に大きな値は変換できない。
+ */
+int amFormatFixed(char *buffer, int size, double value, int decimals) {
+    static const long scales[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+    if (decimals < 0 || decimals > 6 || value != value)
+        return (-1);
+    double scaled = value * scales[decimals];
+    if (scaled >= 9.0e18 || scaled <= -9.0e18)
+        return (-1);
+
+    int64_t v = (int64_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+    uint64_t a = (v < 0) ? 0ULL - (uint64_t)v : (uint64_t)v;
+    char digits[24];
+    int n = 0;
+    for (int i = 0; i < decimals; i++, a /= 10)
+        digits[n++] = '0' + a % 10;
+    if (decimals > 0)
+        digits[n++] = '.';
+    do {
+        digits[n++] = '0' + a % 10;
+        a /= 10;
+    } while (a != 0);
+    if (v < 0)
+        digits[n++] = '-';
+    if (n >= size)
+        return (-1);
+
+    for (int i = 0; i < n; i++)
+        buffer[i] = digits[n - 1 - i];
+    buffer[n] = '\0';
+
+    return (n);
+}
+
+/**
+ *  @fn
+ *
+ *  JSONライタを初期化する
+ *
+ *	@param(buffer)       書き込み先
+ *	@param(size)         bufferのサイズ('\0'を含む)[Bytes]
+ *  @return              なし
+ *  @detail              bufferは常に'\0'終端される。入りきらない時はoverflowed()がtrueになる。
+ */
+AmJsonWriter::AmJsonWriter(char *buffer, int size) {
+    _top = _cur = buffer;
+    _end = buffer + ((size > 0) ? size - 1 : 0);
+    _overflow = (size <= 0);
+    if (size > 0)
+        *_cur = '\0';
+}
+
+/**
+ *  @fn
+ *
+ *  文字列をそのまま書き込む
+ *
+ *	@param(s)            書き込む文字列
+ *	@param(length)       sの長さ[Bytes](省略時は'\0'まで)
+ *  @return              なし
+ *  @detail
+ */
+void AmJsonWriter::raw(const char *s) {
+    raw(s, strlen(s));
+}
+
+void AmJsonWriter::raw(const char *s, int length) {
+    if (_overflow || length > _end - _cur) {
+        _overflow = true;
+        return;
+    }
+    memcpy(_cur, s, length);
+    _cur += length;
+    *_cur = '\0';
+}
+
+/**
+ *  @fn
+ *
+ *  文字列をJSONの文字列として書き込む
+ *
+ *	@param(s)            書き込む文字列
+ *  @return              なし
+ *  @detail              前後を'"'で囲み、'"'と'\\'と制御文字をエスケープする
+ */
+void AmJsonWriter::string(const char *s) {
+    raw("\"", 1);
+    for (const char *p = s; *p != '\0' && ! _overflow; p++) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            char escaped[2] = { '\\', c };
+            raw(escaped, 2);
+        }
+        else if ((uint8_t)c < 0x20) {
+            char escaped[6] = { '\\', 'u', '0', '0', (char)('0' + (c >> 4)), "0123456789abcdef"[c & 0x0f] };
+            raw(escaped, 6);
+        }
+        else
+            raw(&c, 1);
+    }
+    raw("\"", 1);
+}
+
+/**
+ *  @fn
+ *
+ *  整数を書き込む
+ *
+ *	@param(value)        書き込む値
+ *  @return              なし
+ *  @detail
+ */
+void AmJsonWriter::integer(long value) {
+    char digits[12];
+    int len = amFormatInteger(digits, sizeof(digits), value);
+    raw(digits, len);
+}
+
+/**
+ *  @fn
+ *
+ *  実数を固定小数点形式で書き込む
+ *
+ *	@param(value)        書き込む値
+ *	@param(decimals)     小数点以下の桁数(0～6)
+ *  @return              なし
+ *  @detail              変換できない値の時は、overflowed()をtrueにする
+ */
+void AmJsonWriter::fixed(double value, int decimals) {
+    char digits[24];
+    int len = amFormatFixed(digits, sizeof(digits), value, decimals);
+    if (len < 0) {
+        _overflow = true;
+        return;
+    }
+    raw(digits, len);
+}
+
 /**
  *  @fn
  *
@@ -38,7 +269,7 @@
  *  @detail
  */
 int Ambient_mgim::begin(unsigned int channelId, const char * writeKey) {
-    if (sizeof(writeKey) > amWRITEKEY_SIZE) {
+    if (writeKey == NULL || strlen(writeKey) >= amWRITEKEY_SIZE) {
         ERR("writeKey length > amWRITEKEY_SIZE");
         return (amERR_BAD_PARAM);
     }
@@ -70,7 +301,7 @@ int Ambient_mgim::set(int field, const char * data) {
     if (field < 0 || field >= amNUM_FIELDS)
         return (amERR_BAD_PARAM);
 
-    if (strlen(data) > amDATA_SIZE)
+    if (strlen(data) >= amDATA_SIZE)
         return (amERR_TOO_LONG_DATA);
 
     _data[field].used = true;
@@ -86,11 +317,16 @@ int Ambient_mgim::set(int field, const char * data) {
  *
  *	@param(field)        フィールド番号(0～amNUM_FIELDS-1)
  *	@param(data)         セットする値(double型)
+ *	@param(decimals)     小数点以下の桁数(0～6、省略時は2)
  *  @return              0:成功時、0以外:エラー時(エラー番号)
  *  @detail
  */
-int Ambient_mgim::set(int field, double data) {
-	return (set(field, String(data).c_str()));
+int Ambient_mgim::set(int field, double data, int decimals) {
+    char item[amDATA_SIZE];
+    if (amFormatFixed(item, sizeof(item), data, decimals) < 0)
+        return (amERR_TOO_LONG_DATA);
+
+    return (set(field, item));
 }
 
 /**
@@ -104,7 +340,10 @@ int Ambient_mgim::set(int field, double data) {
  *  @detail
  */
 int Ambient_mgim::set(int field, int data) {
-	return (set(field, String(data).c_str()));
+    char item[amDATA_SIZE];
+    amFormatInteger(item, sizeof(item), data);
+
+    return (set(field, item));
 }
 
 /**
@@ -137,46 +376,320 @@ int Ambient_mgim::clear(int field) {
  *                       正しくアップロードできた時は、すべてのフィールドをクリアする
  */
 int Ambient_mgim::send(void) {
-	const char *keys[] = {"\"d1\":\"", "\"d2\":\"", "\"d3\":\"", "\"d4\":\"", "\"d5\":\"", "\"d6\":\"", "\"d7\":\"", "\"d8\":\"", "\"lat\":\"", "\"lng\":\"", "\"created\":\""};
     char body[256];
 
     // Bodyを作る
-    memset(body, 0, sizeof(body));
-    strcat(body, "{\"writeKey\":\"");
-    strcat(body, _writeKey);
-    strcat(body, "\"");
+    AmJsonWriter json(body, sizeof(body));
+    json.raw("{\"writeKey\":");
+    json.string(_writeKey);
+    writeFields(json);
+    json.raw("}");
+    if (json.overflowed())
+        return (amERR_BUFFER_OVERFLOW);
 
-    for (int i = 0; i < amNUM_FIELDS; i++) {
-        if (_data[i].used) {
-            strcat(body, ",");
-            strcat(body, keys[i]);
-            strcat(body, _data[i].item);
-            strcat(body, "\"");
+    // Postする
+    int stat;
+    if ((stat = post(_url, body, json.length())) != amERR_NONE)
+        return (stat);
+
+    // Clear data entries
+    clearFields();
+
+    return (amERR_NONE);  // Ok
+}
+
+/**
+ *  @fn
+ *
+ *  バッチ送信を開始する
+ *
+ *	@param(buffer)       Bodyを組み立てるバッファ(呼び出し側で用意する)
+ *	@param(size)         bufferのサイズ[Bytes]
+ *	@param(maxSamples)   この数のサンプルが貯まったら送信する(1～amBATCH_MAX_SAMPLES)
+ *	@param(maxAge)       最も古いサンプルがこの時間を過ぎたら送信する[mS]
+ *  @return              0:成功時、0以外:エラー時(エラー番号)
+ *  @detail              以降、append()したサンプルは、bufferに貯めて1回のHTTP/POSTでまとめて送信する。
+ *                       bufferが一杯になった時も送信する。
+ */
+int Ambient_mgim::beginBatch(char *buffer, int size, int maxSamples, uint32_t maxAge) {
+    if (buffer == NULL || maxSamples <= 0 || maxSamples > amBATCH_MAX_SAMPLES)
+        return (amERR_BAD_PARAM);
+    AmJsonWriter json(buffer, size - (sizeof(BATCH_TRAILER) - 1));
+    json.raw("{\"writeKey\":");
+    json.string(_writeKey);
+    json.raw(",\"data\":[");
+    if (json.overflowed())
+        return (amERR_BUFFER_OVERFLOW);     // Too small buffer
+    int len = json.length();
+
+    _batch = buffer;
+    _batchSize = size;
+    _batchLength = _batchPrefixLength = len;
+    _batchCount = 0;
+    _batchMaxSamples = maxSamples;
+    _batchMaxAge = maxAge;
+
+    return (amERR_NONE);
+}
+
+/**
+ *  @fn
+ *
+ *  set()したフィールドを1つのサンプルとしてバッチに追加する
+ *
+ *	@param               なし
+ *  @return              0:成功時、0以外:エラー時(エラー番号)
+ *  @detail              サンプルの日時("created")は、この時点の時刻とする(送信時に補完する)。
+ *                       追加できた時は、すべてのフィールドをクリアする。
+ *                       サンプル数、bufferのサイズ、または経過時間の上限に達したら送信する。
+ *                       送信に失敗した場合、バッチの中のサンプルは次の送信まで保持する。
+ *                       サンプル数が上限のまま送信できない時は、サンプルを追加せずに送信のエラーを返す
+ *                       (フィールドはクリアしないので、もう一度append()できる)。
+ */
+int Ambient_mgim::append(void) {
+    if (_batch == NULL)
+        return (amERR_NO_BATCH);
+
+    // サンプルをbufferに直接書き込む("created"の値は、送信時に上書きする)
+    // bufferに入らなければ、先に送信してから書き込み直す
+    // 前回の送信に失敗してサンプル数が上限のままなら、送信できるまで追加しない
+    int stat;
+    while (true) {
+        if (_batchCount >= _batchMaxSamples && (stat = flush()) != amERR_NONE)
+            return (stat);
+        AmJsonWriter json(_batch + _batchLength, _batchSize - _batchLength - (sizeof(BATCH_TRAILER) - 1));
+        if (_batchCount > 0)
+            json.raw(",");
+        json.raw(SAMPLE_PREFIX);
+        int offset = json.length();
+        for (int i = 0; i < amDATETIME_SIZE; i++)
+            json.raw("0", 1);
+        json.raw("\"");
+        writeFields(json);
+        json.raw("}");
+        if (! json.overflowed()) {
+            _samples[_batchCount].offset = _batchLength + offset;
+            _samples[_batchCount].stamp = millis();
+            _batchLength += json.length();
+            _batchCount++;
+            break;
         }
+
+        _batch[_batchLength] = '\0';   // Remove the incomplete sample
+        if (_batchCount == 0)
+            return (amERR_BUFFER_OVERFLOW);
+        if ((stat = flush()) != amERR_NONE)
+            return (stat);
+    }
+    clearFields();
+
+    // サンプル数または経過時間の上限に達したら送信する
+    if (_batchCount >= _batchMaxSamples)
+        return (flush());
+
+    return (poll());
+}
+
+/**
+ *  @fn
+ *
+ *  バッチに貯まっているサンプルを送信する
+ *
+ *	@param               なし
+ *  @return              0:成功時、0以外:エラー時(エラー番号)
+ *  @detail              現在日時をLTE網から1回だけ取得し、各サンプルの"created"を補完してから送信する。
+ *                       日時はHL7800が返す現地時刻(JST)とする。
+ */
+int Ambient_mgim::flush(void) {
+    if (_batch == NULL)
+        return (amERR_NO_BATCH);
+    if (_batchCount == 0)
+        return (amERR_NONE);
+
+    // 各サンプルの日時を、現在日時からの経過時間で求める
+    DATE_TIME now;
+    if (_hl7800.getDateTime(&now) != 0)
+        return (amERR_DATETIME);
+    uint32_t nowMillis = millis();
+    uint64_t nowMs = (uint64_t)toEpochSeconds(2000 + now.year, now.month, now.day,
+                                              now.hours, now.minutes, now.seconds) * 1000;
+    for (int i = 0; i < _batchCount; i++) {
+        char datetime[amDATETIME_SIZE + 1];
+        formatDateTime(nowMs - (uint32_t)(nowMillis - _samples[i].stamp), datetime);
+        memcpy(_batch + _samples[i].offset, datetime, amDATETIME_SIZE);
     }
-    strcat(body, "}");
 
     // Postする
-    char result[100];
-    int retry, len = sizeof(result) - 1;
-    for (retry = 0; retry < MAX_RETRY_POST; retry++) {
-        int ret = _hl7800.doHttpPost(_url, _header, body, strlen(body), result, &len);
-        if (ret == 0)
-            break;    // post succeed
+    char url[sizeof(BATCH_URL_FORMAT) + 8];
+    sprintf(url, BATCH_URL_FORMAT, _channelId);
+    memcpy(_batch + _batchLength, BATCH_TRAILER, sizeof(BATCH_TRAILER));
+    int stat = post(url, _batch, _batchLength + sizeof(BATCH_TRAILER) - 1);
+    _batch[_batchLength] = '\0';       // Remove trailer
+    if (stat != amERR_NONE)
+        return (stat);      // Keep the samples for next flush
+
+    // バッチを空にする
+    _batchLength = _batchPrefixLength;
+    _batchCount = 0;
+
+    return (amERR_NONE);
+}
+
+/**
+ *  @fn
+ *
+ *  経過時間の上限に達したサンプルがあれば、バッチを送信する
+ *
+ *	@param               なし
+ *  @return              0:成功時(または送信不要時)、0以外:エラー時(エラー番号)
+ *  @detail              サンプルをappend()しない間も、loop()から定期的に呼び出すこと
+ */
+int Ambient_mgim::poll(void) {
+    if (_batch == NULL)
+        return (amERR_NO_BATCH);
+    if (_batchCount > 0 && millis() - _samples[0].stamp >= _batchMaxAge)
+        return (flush());
+
+    return (amERR_NONE);
+}
+
+/**
+ *  @fn
+ *
+ *  set()されたフィールドを書き込む
+ *
+ *	@param(json)         書き込み先(",\"d1\":\"..\",\"d2\":\"..\"..."の形式で追加する)
+ *  @return              なし
+ *  @detail              bufferに入らない時は、json.overflowed()がtrueになる
+ */
+void Ambient_mgim::writeFields(AmJsonWriter &json) {
+	const char *keys[] = {",\"d1\":", ",\"d2\":", ",\"d3\":", ",\"d4\":", ",\"d5\":", ",\"d6\":", ",\"d7\":", ",\"d8\":", ",\"lat\":", ",\"lng\":"};
+
+    for (int i = 0; i < amNUM_FIELDS; i++) {
+        if (! _data[i].used)
+            continue;
+        json.raw(keys[i]);
+        json.string(_data[i].item);
+    }
+}
+
+/**
+ *  @fn
+ *
+ *  送信に失敗した時のリトライ方法を設定する
+ *
+ *	@param(maxAttempts)  HTTP/POSTの最大試行回数(1以上、1ならリトライしない)
+ *	@param(baseDelay)    最初のリトライまでの待ち時間[mS](リトライごとに倍にする)
+ *	@param(maxDelay)     リトライまでの待ち時間の上限[mS]
+ *	@param(deadline)     送信全体にかける時間の上限[mS]
+ *  @return              0:成功時、0以外:エラー時(エラー番号)
+ *  @detail              実際の待ち時間は、同時に起動した多数の端末が一斉にリトライしないように、
+ *                       待ち時間の1/2～1倍の範囲でランダムにばらつかせる
+ */
+int Ambient_mgim::setRetryPolicy(int maxAttempts, uint32_t baseDelay, uint32_t maxDelay, uint32_t deadline) {
+    if (maxAttempts < 1 || baseDelay > maxDelay)
+        return (amERR_BAD_PARAM);
+
+    _retryPolicy.maxAttempts = maxAttempts;
+    _retryPolicy.baseDelay = baseDelay;
+    _retryPolicy.maxDelay = maxDelay;
+    _retryPolicy.deadline = deadline;
+
+    return (amERR_NONE);
+}
+
+/**
+ *  @fn
+ *
+ *  doHttpPost()のエラーが、リトライすれば成功する見込みがあるかを判定する
+ *
+ *	@param(error)        doHttpPost()の戻り値(0以外)
+ *  @return              true:リトライする、false:リトライしない
+ *  @detail              4xxのレスポンス(408と429を除く)と、パラメータのエラーはリトライしない。
+ *                       5xxのレスポンスと、通信のエラー(h78ERR_HTTP_*、タイムアウトなど)はリトライする。
+ */
+static boolean isRetryable(int error) {
+    if (error < 0) {
+        int status = - error;
+        if (status == 408 || status == 429)
+            return true;        // Request Timeout, Too Many Requests
+        return (status < 400 || status >= 500);
     }
+    if (error == h78ERR_BAD_PARAM || error == h78ERR_NOT_YET_INITIALIZED)
+        return false;
+
+    return true;
+}
+
+/**
+ *  @fn
+ *
+ *  リトライ方法に従って、HTTP/POSTを実行する
+ *
+ *	@param(url)          PostするURL
+ *	@param(body)         Body
+ *	@param(length)       bodyの長さ[Bytes]
+ *  @return              0:成功時、0以外:エラー時(エラー番号)
+ *  @detail              リトライまでの待ち時間は、指数的に延ばす(ジッタ付き)
+ */
+int Ambient_mgim::post(char *url, char *body, int length) {
+    uint32_t start = millis();
+    uint32_t backoff = _retryPolicy.baseDelay;
+
+    _retryStats.posts++;
+    for (int attempt = 1; ; attempt++) {
+        char result[100];
+        int len = sizeof(result) - 1;
+        _retryStats.attempts++;
+        int ret = _lastPostError = _hl7800.doHttpPost(url, _header, body, length, result, &len);
+        if (ret == 0) {
 #ifdef AMBIENT_DEBUG
-    DBG_SERIAL.print("RES=\"");
-    DBG_SERIAL.print(result);
-    DBG_SERIAL.println("\"");
+            result[len] = '\0';
+            DBG_SERIAL.print("RES=\"");
+            DBG_SERIAL.print(result);
+            DBG_SERIAL.println("\"");
 #endif
-    if (retry == MAX_RETRY_POST) {
-        ERR("Could not post to host\r\n");
-        return (amERR_POST);
+            return (amERR_NONE);    // post succeed
+        }
+
+        // リトライするかを判断する
+        DBG("doHttpPost() error: ");
+        DBG(ret);
+        DBG("\r\n");
+        if (! isRetryable(ret)) {
+            _retryStats.rejected++;
+            ERR("Post rejected\r\n");
+            return (amERR_POST_REJECTED);
+        }
+        if (attempt >= _retryPolicy.maxAttempts) {
+            _retryStats.failures++;
+            ERR("Could not post to host\r\n");
+            return (amERR_POST);
+        }
+        uint32_t wait = backoff / 2 + random(backoff / 2 + 1);
+        if (millis() - start + wait >= _retryPolicy.deadline) {
+            _retryStats.deadlines++;
+            ERR("Post deadline exceeded\r\n");
+            return (amERR_POST_DEADLINE);
+        }
+
+        // 待ってからリトライする
+        delay(wait);
+        _retryStats.retries++;
+        backoff = (backoff > _retryPolicy.maxDelay / 2) ? _retryPolicy.maxDelay : backoff * 2;
     }
+}
 
-    // Clear data entries
+/**
+ *  @fn
+ *
+ *  すべてのフィールドをクリアする
+ *
+ *	@param               なし
+ *  @return              なし
+ *  @detail
+ */
+void Ambient_mgim::clearFields(void) {
     for (int i = 0; i < amNUM_FIELDS; i++)
         _data[i].used = false;
-
-    return (amERR_NONE);  // Ok
 }
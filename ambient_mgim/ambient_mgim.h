@@ -19,24 +19,87 @@
 #define amWRITEKEY_SIZE     18      // ライトキーの桁数[Bytes]
 #define amDATA_SIZE         24      // データの最大桁数[Bytes]
 #define amNUM_FIELDS        10      // フィールドの最大数
+#define amBATCH_MAX_SAMPLES 32      // バッチに貯められるサンプルの最大数
+#define amBATCH_MAX_AGE     600000UL    // バッチ内の最も古いサンプルの保持時間の上限(デフォルト)[mS]
+#define amDATETIME_SIZE     23      // "created"の日時("YYYY-MM-DD hh:mm:ss.sss")の桁数[Bytes]
+  // リトライ(デフォルト値)
+#define amRETRY_MAX_ATTEMPTS    5           // HTTP/POSTの最大試行回数
+#define amRETRY_BASE_DELAY      2000UL      // 最初のリトライまでの待ち時間[mS](リトライごとに倍にする)
+#define amRETRY_MAX_DELAY       30000UL     // リトライまでの待ち時間の上限[mS]
+#define amRETRY_DEADLINE        180000UL    // 送信全体にかける時間の上限[mS]
 
   // エラーコード
 #define amERR_NONE          0       // エラーなし
 #define amERR_BAD_PARAM     100     // パラメータがおかしい
 #define amERR_TOO_LONG_DATA 101     // データが長すぎる
-#define amERR_POST          2000    // Postに失敗した
+#define amERR_NO_BATCH      102     // beginBatch()が呼ばれていない
+#define amERR_DATETIME      103     // 現在日時を取得できない
+#define amERR_BUFFER_OVERFLOW   104 // Bodyがバッファに入らない
+#define amERR_POST          2000    // Postに失敗した(最大試行回数に達した)
+#define amERR_POST_REJECTED 2001    // Postがサーバーに拒否された(リトライしても成功しない4xx)
+#define amERR_POST_DEADLINE 2002    // Postに失敗した(時間の上限に達した)
+
+  // リトライの統計情報
+typedef struct {
+    uint32_t posts;         // 送信の回数(send()/flush())
+    uint32_t attempts;      // HTTP/POSTを試行した回数
+    uint32_t retries;       // リトライした回数
+    uint32_t failures;      // 最大試行回数に達して諦めた回数
+    uint32_t rejected;      // リトライできないエラーで諦めた回数
+    uint32_t deadlines;     // 時間の上限に達して諦めた回数
+} AM_RETRY_STATS;
+
+  // JSONライタ(ヒープを使わず、指定されたバッファに直接書き込む)
+class AmJsonWriter {
+  public:
+    AmJsonWriter(char *buffer, int size);
+
+    void raw(const char *s);
+    void raw(const char *s, int length);
+    void string(const char *s);
+    void integer(long value);
+    void fixed(double value, int decimals);
+    int length(void) { return (int)(_cur - _top); }
+    boolean overflowed(void) { return _overflow; }
+
+  private:
+    char *_top, *_cur, *_end;
+    boolean _overflow;
+};
+
+  // 数値の書式化(bufferに'\0'終端で書き込み、長さを返す。入らなければ-1)
+int amFormatInteger(char *buffer, int size, long value);
+int amFormatFixed(char *buffer, int size, double value, int decimals);
 
 class Ambient_mgim {
   public:
-    Ambient_mgim(HL7800 hl7800): _hl7800(hl7800) { }
+    Ambient_mgim(HL7800 hl7800): _hl7800(hl7800) {
+        _batch = NULL;
+        _batchSize = _batchLength = _batchCount = 0;
+        setRetryPolicy(amRETRY_MAX_ATTEMPTS, amRETRY_BASE_DELAY, amRETRY_MAX_DELAY, amRETRY_DEADLINE);
+        memset(&_retryStats, 0, sizeof(_retryStats));
+        _lastPostError = 0;
+    }
 
     int begin(unsigned int channelId, const char * writeKey);
     int set(int field,const char * data);
-	int set(int field, double data);
+	int set(int field, double data, int decimals = 2);
 	int set(int field, int data);
     int clear(int field);
     int send(void);
 
+    // バッチ送信
+    int beginBatch(char *buffer, int size, int maxSamples = amBATCH_MAX_SAMPLES, uint32_t maxAge = amBATCH_MAX_AGE);
+    int append(void);
+    int flush(void);
+    int poll(void);
+    int getBatchCount(void) { return _batchCount; }
+
+    // リトライ
+    int setRetryPolicy(int maxAttempts, uint32_t baseDelay, uint32_t maxDelay, uint32_t deadline);
+    const AM_RETRY_STATS *getRetryStats(void) { return &_retryStats; }
+    int getLastPostError(void) { return _lastPostError; }    // 最後のdoHttpPost()の戻り値
+
   private:
     HL7800 _hl7800;
 
@@ -48,6 +111,30 @@ class Ambient_mgim {
         boolean  used;
         char     item[amDATA_SIZE];
     } _data[amNUM_FIELDS];
+      // バッチ
+    char *_batch;               // Bodyを組み立てるバッファ(beginBatch()で指定)
+    int _batchSize;
+    int _batchLength;           // Bodyの現在の長さ(閉じ括弧を除く)
+    int _batchPrefixLength;     // 先頭("{"writeKey":..,"data":[")の長さ
+    int _batchCount;            // 貯まっているサンプル数
+    int _batchMaxSamples;
+    uint32_t _batchMaxAge;
+    struct {
+        uint16_t offset;        // "created"の値の位置
+        uint32_t stamp;         // append()したときのmillis()
+    } _samples[amBATCH_MAX_SAMPLES];
+
+      // リトライ
+    struct {
+        int maxAttempts;
+        uint32_t baseDelay, maxDelay, deadline;
+    } _retryPolicy;
+    AM_RETRY_STATS _retryStats;
+    int _lastPostError;
+
+    void writeFields(AmJsonWriter &json);
+    int post(char *url, char *body, int length);
+    void clearFields(void);
 };
 
 #endif // Ambient_mgim_h
@@ -0,0 +1,64 @@
+/*
+ *  Ambient batch upload sample sketch with mgim, hl7800 and stts751(on board temperature sensor)
+ *
+ *    10秒ごとに温度を計測してバッチに追加し、30サンプル(約5分)ごとに1回のHTTP/POSTでまとめてアップロードする
+ */
+
+#include <mgim.h>
+#include <hl7800.h>
+#include <Wire.h>
+#include <stts751.h>
+#include "ambient_mgim.h"
+
+// Set your REAL channel-id and write-key
+#define CHANNEL_ID  ***
+#define WRITE_KEY   "@@@"
+
+#define SAMPLING_INTERVAL   10000       // 計測間隔[mS]
+#define BATCH_SAMPLES       30          // まとめて送るサンプル数
+#define BATCH_MAX_AGE       600000UL    // サンプル数に達しなくても、この時間が過ぎたら送る[mS]
+
+HL7800  hl7800;
+STTS751 stts751;
+Ambient_mgim am(hl7800);
+char batchBuffer[2048];                 // 1サンプルあたり、約60バイト
+
+void setup() {
+  while (! mgSERIAL_MONITOR)
+    ;
+  mgSERIAL_MONITOR.begin(115200);
+  mgSERIAL_MONITOR.println("Start.");
+
+  Wire.begin();
+  stts751.begin();
+
+  am.begin(CHANNEL_ID, WRITE_KEY);
+  am.beginBatch(batchBuffer, sizeof(batchBuffer), BATCH_SAMPLES, BATCH_MAX_AGE);
+
+  hl7800.powerOn();
+  delay(1000);
+
+  int stat = hl7800.begin();
+  if (stat != 0) {
+    mgSERIAL_MONITOR.println("hl7800(): error");
+    while (1) ;
+  }
+
+  mgSERIAL_MONITOR.println("setup(): done");
+}
+
+void loop() {
+  float t = stts751.getTemperature() / 10.0;
+  am.set(1, t);
+  int stat = am.append();         // 上限に達したら、ここで送信される
+  mgSERIAL_MONITOR.print("append: ");
+  mgSERIAL_MONITOR.print(t, 1);
+  mgSERIAL_MONITOR.print(", samples in batch: ");
+  mgSERIAL_MONITOR.println(am.getBatchCount());
+  if (stat != 0) {
+    mgSERIAL_MONITOR.print("append(): error ");
+    mgSERIAL_MONITOR.println(stat);
+  }
+
+  delay(SAMPLING_INTERVAL);
+}
@@ -0,0 +1,373 @@
+//***********************************************************
+//	gimclient.h -- Arduino Client adapter of GIMCore(3GIM/4GIM)
+//
+//	History:
+//		R1.0 2026/10/19  1st Release, factored out of a3gim2_client(R1.0) and a4gim2_client(R1.0)
+//		R1.1 2026/10/19  Retry partially written data in sendPending(), and keep unsent data on error
+//
+//	Author:
+//		Open wireless Alliance and Atushi Daikoku
+//
+//	Notes:
+//		Header only library, used by a3gim2 and a4gim2(A3GSClient and A4GSClient).
+//		GIMClient is a Client compatible template class over TCP/IP functions of a GIMCore object,
+//		so that libraries using Client(MQTT, HTTP..) can run on 3GIM/4GIM. It is parameterized as below:
+//		- CoreT, core : type of the driver and its global object(ex. A3GS and a3gs)
+//		- RX_SIZE : size of read-ahead buffer, received data is read ahead by one $TR command
+//		- TX_SIZE : size of write coalescing buffer, written data is coalesced into one $TW command,
+//		  and sent by flush(), or before reading
+//***********************************************************
+
+#ifndef _GIMCLIENT_H_
+#define _GIMCLIENT_H_
+
+#include <Arduino.h>
+#include <Client.h>
+#include <IPAddress.h>
+#include "gimcore.h"
+
+/*
+	Declare class
+*/
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+class GIMClient : public Client
+{
+  public:
+	GIMClient() : _connected(false), _rxIndex(0), _rxLength(0), _txLength(0) { };
+
+	// Client methods
+	virtual int connect(IPAddress ip, uint16_t port);
+	virtual int connect(const char *host, uint16_t port);
+	virtual size_t write(uint8_t c);
+	virtual size_t write(const uint8_t *buf, size_t size);
+	virtual int available(void);
+	virtual int read(void);
+	virtual int read(uint8_t *buf, size_t size);
+	virtual int peek(void);
+	virtual void flush(void);
+	virtual void stop(void);
+	virtual uint8_t connected(void);
+	virtual operator bool(void) { return _connected; };
+	using Print::write;
+
+  private:
+	static_assert(RX_SIZE > 0 && RX_SIZE <= gimMAX_DATA_LENGTH, "RX_SIZE must be 1..gimMAX_DATA_LENGTH");
+	static_assert(TX_SIZE > 0 && TX_SIZE <= gimMAX_DATA_LENGTH, "TX_SIZE must be 1..gimMAX_DATA_LENGTH");
+	boolean _connected;
+	uint8_t _rxBuffer[RX_SIZE];
+	size_t _rxIndex;		// Next position to read in _rxBuffer
+	size_t _rxLength;		// Valid bytes in _rxBuffer
+	uint8_t _txBuffer[TX_SIZE];
+	size_t _txLength;		// Pending bytes in _txBuffer
+	int readAhead(void);
+	int sendPending(void);
+};
+
+//***************************
+//	connect
+//
+//	@description
+//		Connect to server by IP address
+//	@return value
+//		1 .. OK
+//		0 .. NG
+//	@param
+//		ip : IP address of server
+//		port : port number
+//***************************
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+int GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::connect(IPAddress ip, uint16_t port)
+{
+	char	host[16];		// "nnn.nnn.nnn.nnn"
+//--
+	sprintf(host, "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+
+	return connect(host, port);
+}
+
+//***************************
+//	connect
+//
+//	@description
+//		Connect to server by host name
+//	@return value
+//		1 .. OK
+//		0 .. NG
+//	@param
+//		host : server name(ex. "www.google.com")
+//		port : port number
+//***************************
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+int GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::connect(const char *host, uint16_t port)
+{
+	if (_connected)
+		stop();
+
+	_rxIndex = _rxLength = _txLength = 0;
+	if (core.connectTCP(host, port) != 0)
+		return 0;	// NG -- Can't connect
+
+	_connected = true;
+
+	return 1;	// OK
+}
+
+//***************************
+//	write
+//
+//	@description
+//		Write byte into the connection(coalesced until flush())
+//	@return value
+//		1 .. OK
+//		0 .. NG
+//	@param
+//		c : byte data to write
+//***************************
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+size_t GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::write(uint8_t c)
+{
+	return write(&c, 1);
+}
+
+//***************************
+//	write
+//
+//	@description
+//		Write byte data into the connection(coalesced until flush())
+//	@return value
+//		0 < .. OK (= wrote bytes)
+//		0 .. NG
+//	@param
+//		buf : data to write(byte array)
+//		size : data size(in byte)
+//	@note
+//		When the buffer is filled, it is sent by one $TW command.
+//***************************
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+size_t GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::write(const uint8_t *buf, size_t size)
+{
+	size_t	written = 0;
+//--
+	if (! _connected) {
+		setWriteError();
+		return 0;	// NG -- not connected
+	}
+
+	while (written < size) {
+		size_t n = size - written;
+		if (n > sizeof(_txBuffer) - _txLength)
+			n = sizeof(_txBuffer) - _txLength;
+		memcpy(_txBuffer + _txLength, buf + written, n);
+		_txLength += n;
+		written += n;
+
+		if (_txLength == sizeof(_txBuffer) && sendPending() != 0) {
+			setWriteError();
+			return 0;	// NG -- Can't write
+		}
+	}
+
+	return written;		// OK
+}
+
+//***************************
+//	available
+//
+//	@description
+//		Get number of bytes which can be read
+//	@return value
+//		0 <= .. number of bytes
+//	@param
+//		none
+//	@note
+//		If no data is in the buffer, pending data is sent and then data is read ahead by one $TR command.
+//***************************
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+int GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::available(void)
+{
+	if (_rxIndex < _rxLength)
+		return (int)(_rxLength - _rxIndex);
+
+	if (! _connected)
+		return 0;
+
+	readAhead();
+
+	return (int)(_rxLength - _rxIndex);
+}
+
+//***************************
+//	read
+//
+//	@description
+//		Read byte from the connection
+//	@return value
+//		-1 .. No data
+//		0..0xFF .. OK (= read byte)
+//	@param
+//		none
+//***************************
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+int GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::read(void)
+{
+	if (available() <= 0)
+		return (-1);	// No data
+
+	return _rxBuffer[_rxIndex++];
+}
+
+//***************************
+//	read
+//
+//	@description
+//		Read byte data from the connection
+//	@return value
+//		-1 .. No data
+//		0 < .. OK (= read bytes)
+//	@param
+//		buf : [OUT] read data(byte array)
+//		size : buffer size(in byte)
+//***************************
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+int GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::read(uint8_t *buf, size_t size)
+{
+	int	nbytes = available();
+//--
+	if (nbytes <= 0)
+		return (-1);	// No data
+
+	if ((size_t)nbytes > size)
+		nbytes = size;
+	memcpy(buf, _rxBuffer + _rxIndex, nbytes);
+	_rxIndex += nbytes;
+
+	return nbytes;	// OK
+}
+
+//***************************
+//	peek
+//
+//	@description
+//		Get next byte without removing it
+//	@return value
+//		-1 .. No data
+//		0..0xFF .. OK (= next byte)
+//	@param
+//		none
+//***************************
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+int GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::peek(void)
+{
+	if (available() <= 0)
+		return (-1);	// No data
+
+	return _rxBuffer[_rxIndex];
+}
+
+//***************************
+//	flush
+//
+//	@description
+//		Send pending data
+//	@return value
+//		none
+//	@param
+//		none
+//	@note
+//		Data which can't be sent is kept in the buffer, and write error is set(getWriteError()). --@add R1.1
+//***************************
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+void GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::flush(void)
+{
+	if (sendPending() != 0)
+		setWriteError();
+}
+
+//***************************
+//	stop
+//
+//	@description
+//		Send pending data and disconnect
+//	@return value
+//		none
+//	@param
+//		none
+//***************************
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+void GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::stop(void)
+{
+	if (_connected) {
+		sendPending();
+		core.disconnectTCP();
+		_connected = false;
+	}
+	_rxIndex = _rxLength = _txLength = 0;
+}
+
+//***************************
+//	connected
+//
+//	@description
+//		Check the connection
+//	@return value
+//		1 .. connected, or data remains in the buffer
+//		0 .. disconnected
+//	@param
+//		none
+//	@note
+//		Disconnection by other side is detected when data is read ahead.
+//***************************
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+uint8_t GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::connected(void)
+{
+	if (_rxIndex < _rxLength)
+		return 1;
+
+	return _connected ? 1 : 0;
+}
+
+//***
+//  Private methods
+//***
+
+// readAhead() -- send pending data and read data into the buffer by one $TR command
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+int GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::readAhead(void)
+{
+	sendPending();		// request must be sent before waiting for its response
+
+	_rxIndex = _rxLength = 0;
+	int nbytes = core.read(_rxBuffer, sizeof(_rxBuffer));
+	if (nbytes == -2)
+		_connected = false;		// Closed connection by other side
+	if (nbytes <= 0)
+		return nbytes;
+
+	_rxLength = nbytes;
+
+	return nbytes;
+}
+
+// sendPending() -- send coalesced data by $TW command(s) --@change R1.1
+//	Data partially written by $TW is sent again from the unsent byte, and data which can't be sent
+//	is kept at the front of _txBuffer(returns -1), so that the caller sets write error.
+template <class CoreT, CoreT& core, size_t RX_SIZE, size_t TX_SIZE>
+int GIMClient<CoreT, core, RX_SIZE, TX_SIZE>::sendPending(void)
+{
+	size_t	sent = 0;
+//--
+	while (sent < _txLength) {
+		int nbytes = core.write(_txBuffer + sent, _txLength - sent);
+		if (nbytes <= 0)
+			break;		// NG -- Can't write
+		sent += ((size_t)nbytes < _txLength - sent) ? (size_t)nbytes : _txLength - sent;
+	}
+
+	if (sent > 0 && sent < _txLength)
+		memmove(_txBuffer, _txBuffer + sent, _txLength - sent);
+	_txLength -= sent;
+
+	return (_txLength == 0) ? 0 : (-1);
+}
+
+#endif // _GIMCLIENT_H_
@@ -0,0 +1,2953 @@
+//***********************************************************
+//	gimcore.h -- Driver core of Arduino Control Library for 3GIM(V2.x) and 4GIM(V1)
+//
+//	History:
+//		R1.0 2026/10/19  1st Release, factored out of a3gim(R4.4), a3gim2(R4.5), a4gim(R1.1) and a4gim2(R1.2)
+//		R1.1 2026/10/19  Add httpGET()/httpPOST() to pass response body to Print in blocks
+//		R1.2 2026/10/19  Add binary-safe httpPOST()(body by length, from buffer or Stream)
+//		R1.3 2026/10/19  Serve getTime()/getTime2() from clock synced with $YT occasionally(drift corrected),
+//						 add syncClock(), setClockResync(), getClockDrift(), toSeconds() and fromSeconds()
+//		R1.4 2026/10/19  Move asynchronous positioning of a3gim(R4.6) and a3gim2(R4.7) here:
+//						 startLocation(), startLocation2(), pollLocation() and getLastLocation(), getLastLocation2()
+//		R1.5 2026/10/19  Count escaped size of binary body before sending $WP command(escapedSize())
+//		R1.6 2026/10/19  Limits can drop status lines(MAX_STATUS_LINES = 0) and the cache of the last fix
+//						 (LOCATION_CACHE = false) to save RAM of small AVRs, add MAX_RESULT_LENGTH to Limits
+//
+//	Author:
+//		Open wireless Alliance and Atushi Daikoku
+//
+//	Notes:
+//		Header only library, used by a3gim, a3gim2, a4gim and a4gim2.
+//		GIMCore is a template class, parameterized as below:
+//		- SerialT : type of serial port connected to 3GIM/4GIM(SoftwareSerial, HardwareSerial, Uart..)
+//		- Limits : limits policy(buffer sizes, maximum lengths, timeouts..) of the library,
+//		  derived from GIMDefaultLimits and override members if needed.
+//		Only the functions called by the sketch are instantiated, so that the small AVRs
+//		carry only the code they use.
+//		Define "GIMCORE_DEBUG" symbol before #include "gimcore.h" to debug this library.
+//***********************************************************
+
+#ifndef _GIMCORE_H_
+#define _GIMCORE_H_
+
+#include <Arduino.h>
+
+/*
+	Define constants
+*/
+//	Basic constants
+#define	gimDATE_SIZE				11			// date space size ("YYYY/MM/DD\0" format, used in getTime(), included '\0')
+#define	gimTIME_SIZE				9			// time space size ("HH:MM:SS\0" format(hour is 24h-way), used in getTime(), included '\0')
+#define	gimIMEI_SIZE				16			// imei space size ("99..9\0" format, used in getIMEI(), included '\0')
+#define	gimDEFAULT_PORT				0			// Default port number(for httpGET() and httpPOST())
+
+//	Return values in general
+#define	gimSUCCESS					0
+#define	gimERROR					(-1)
+
+//	Maximum lengths
+#define	gimMAX_VERSION_LENGTH		5			// Maximum bytes of Version number(used in getVersion())
+#define	gimMAX_MSN_LENGTH			11			// Maximum bytes of Phone Number in Japan(used in readSMS())
+#define	gimMAX_HOST_LENGTH			96			// Maximum length of host name
+#define	gimMAX_DATA_LENGTH			1024		// Maximum length of data(at read/write)
+#define	gimMAX_TUNNEL_DATA_LENGTH	32000		// Maximum length of data in writeBegin()
+
+//	Return values of getService()
+#define	gimSRV_NO					0			// Out of service
+#define	gimSRV_PS					1			// Data(packet) only
+#define	gimSRV_CS					2			// Voice only -- @Not used
+#define	gimSRV_BOTH					3			// Data and voice both -- @Not used
+
+//	Method of positioning(used in startLocation()) --@add R1.4
+#define	gimMPBASED					0			// GPS + AGPS
+#define	gimMPASSISTED				1			// AGPS
+#define	gimMPSTANDALONE				2			// GPS only
+#define	gimLOCATION_SIZE			16			// latitude/longitude/height/utc space size(used in getLastLocation(), included '\0')
+
+// Macros
+#ifdef GIMCORE_DEBUG
+#  define gimDEBUG_PRINT(m,v)		do { Serial.print("** "); Serial.print((m)); Serial.print(":"); Serial.println((v)); } while (0)
+#  define gimDEBUGP(m)				Serial.print((m))
+#else
+#  define gimDEBUG_PRINT(m,v)		do { } while (0)	// do nothing(still a statement, ex. after "else")
+#  define gimDEBUGP(m)				do { } while (0)	// do nothing
+#endif
+	// Constants for getTime2()
+#define	gimSECS_PER_MIN				(60UL)
+#define	gimSECS_PER_HOUR			(3600UL)
+#define	gimSECS_PER_DAY				(gimSECS_PER_HOUR * 24UL)
+#define	gimMAX_CLOCK_DRIFT			50000L		// Larger drift than this [ppm] is regarded as time adjustment of the module
+	// Misc.
+#define	gimISDIGIT(c)				((c) >= '0' && (c) <= '9')
+#define	gimMAX_RETRY				3			// Max retry count for begin()
+
+/*
+	Default limits policy
+*/
+struct GIMDefaultLimits
+{
+	//	UART
+	static const uint32_t	BAUDRATE = 9600;			// Baudrate used in begin()
+	static const uint32_t	START_BAUDRATE = 0;			// Baudrate to begin serial port in start()(0 .. not begin)
+	//	Firmware
+	static const int		MIN_FIRMWARE_VERSION = 330;	// A necessary minimum firmware version(x100, ex. 330 means 3.3)
+	//	Buffers
+	static const int		WORK_BUFFER_SIZE = 256;		// Size of buffer for working
+	static const int		RX_BUFFER_SIZE = 256;		// Size of ring buffer for received bytes(power of 2)
+	static const int		LINE_BUFFER_SIZE = 256;		// Maximum length of line(result or status)
+	static const int		MAX_STATUS_LINES = 4;		// Number of status lines to be kept(older ones are discarded, 0 .. not kept) --@change R1.6
+	static const int		MAX_STATUS_LENGTH = 48;		// Maximum length of status line(used in readStatus())
+	static const int		ESCAPE_BLOCK_SIZE = 64;		// Size of staging block to write escaped data
+	static const int		HTTP_BLOCK_SIZE = 64;		// Size of block to pass response body to Print --@add R1.1
+	//	Maximum lengths
+	static const int		MAX_URL_LENGTH = 192;		// Maximum length of URL(used in httpGET() and httpPOST())
+	static const int		MAX_HEADER_LENGTH = 512;	// Maximum length of header(used in httpPOST())
+	static const int		MAX_BODY_LENGTH = 1024;		// Maximum length of body(used in httpPOST())
+	static const int		MAX_RESULT_LENGTH = 1024;	// Maximum length of result(used in httpGET() and httpPOST() into char array) --@add R1.6
+	static const int		MAX_TWEET_LENGTH = 140;		// Maximum length of Tweet message(used in tweet())
+	//	Command execution timeout values
+	static const uint32_t	TIMEOUT_LOCAL = 5000;		// Timeout value of local functions [mS]
+	static const uint32_t	TIMEOUT_NETWORK = 65000;	// Timeout value of communication functions [mS]
+	static const uint32_t	TIMEOUT_GPS = 185000;		// Timeout value of GPS locationing [mS]
+	//	Clock(getTime()/getTime2())
+	static const uint32_t	CLOCK_RESYNC_INTERVAL = 3600000UL;	// Interval to sync the clock with the module [mS](0 .. every call)
+	static const uint32_t	CLOCK_DRIFT_SPAN = 600000UL;		// Minimum span to measure drift of millis() [mS]
+	//	Positioning
+	static const boolean	LOCATION_CACHE = true;		// Keep the last fix in the object(false .. parse it from the work buffer) --@add R1.6
+
+	//	Called before sending to the serial port(SoftwareSerial needs listen())
+	template <class S> static void listen(S& serial) { (void)serial; }
+};
+
+/*
+	Print to store response body into char array('\0' terminated, overflowed bytes are dropped) --@add R1.1
+*/
+class GIMBufferPrint : public Print
+{
+  public:
+	GIMBufferPrint(char* buffer, int size) : _buffer(buffer), _size(size), _length(0) {
+		if (size > 0)
+			buffer[0] = '\0';
+	};
+	size_t write(uint8_t c) { return write(&c, 1); };
+	size_t write(const uint8_t* data, size_t sz) {
+		size_t n = (_length + (int)sz < _size) ? sz : (size_t)(_size - 1 - _length);
+		if (_size > 0) {
+			memcpy(_buffer + _length, data, n);
+			_length += n;
+			_buffer[_length] = '\0';
+		}
+		return sz;
+	};
+	using Print::write;
+	int length(void) { return _length; };
+
+  private:
+	char* _buffer;
+	int _size;
+	int _length;
+};
+
+/*
+	Ring of status lines kept for readStatus() --@add R1.6
+*/
+template <int LINES, int LENGTH>
+class GIMStatusLines
+{
+  public:
+	GIMStatusLines() : _head(0), _count(0) { };
+	void clear(void) { _head = _count = 0; };
+	int available(void) { return _count; };
+	void push(const char* line) {		// overwrite the oldest one if full
+		int index = (_head + _count) % LINES;
+		strncpy(_lines[index], line, LENGTH);
+		_lines[index][LENGTH] = '\0';
+		if (_count < LINES)
+			_count++;
+		else
+			_head = (_head + 1) % LINES;
+	};
+	int read(char* buf, int len) {
+		if (_count == 0 || len <= 0)
+			return 0;
+		strncpy(buf, _lines[_head], len - 1);
+		buf[len - 1] = '\0';
+		_head = (_head + 1) % LINES;
+		_count--;
+		return strlen(buf);
+	};
+
+  private:
+	char _lines[LINES][LENGTH + 1];
+	int _head, _count;
+};
+
+template <int LENGTH>
+class GIMStatusLines<0, LENGTH>		// MAX_STATUS_LINES = 0 .. status lines are discarded
+{
+  public:
+	void clear(void) { };
+	int available(void) { return 0; };
+	void push(const char* line) { (void)line; };
+	int read(char* buf, int len) { (void)buf; (void)len; return 0; };
+};
+
+/*
+	Cache of the last fix(getLastLocation()/getLastLocation2()) --@add R1.6
+*/
+template <boolean CACHED>
+class GIMLocationFix
+{
+  public:
+	char* latitude(void) { return _latitude; };
+	char* longitude(void) { return _longitude; };
+	char* height(void) { return _height; };
+	char* utc(void) { return _utc; };
+	int* quality(void) { return &_quality; };
+	int* number(void) { return &_number; };
+
+  private:
+	char _latitude[gimLOCATION_SIZE], _longitude[gimLOCATION_SIZE], _height[gimLOCATION_SIZE], _utc[gimLOCATION_SIZE];
+	int _quality, _number;
+};
+
+template <>
+class GIMLocationFix<false>		// LOCATION_CACHE = false .. no storage, the fix is parsed from the work buffer
+{
+  public:
+	char* latitude(void) { return NULL; };
+	char* longitude(void) { return NULL; };
+	char* height(void) { return NULL; };
+	char* utc(void) { return NULL; };
+	int* quality(void) { return NULL; };
+	int* number(void) { return NULL; };
+};
+
+/*
+	Declare class
+*/
+template <class SerialT, class Limits = GIMDefaultLimits>
+class GIMCore
+{
+  public:
+	GIMCore(SerialT& serial) : _serial(serial), _status(IDLE), _powerPin(0), _missingBytes(0), _streamRemains(0), _tunnelRemains(0),
+		_clockSynced(false), _clockBase(0), _clockMillis(0), _clockChecked(0), _clockResync(Limits::CLOCK_RESYNC_INTERVAL), _clockDrift(0),
+		_locating(0), _fixType(0), _rxHead(0), _rxTail(0), _lineLength(0) { };
+	enum gim_st_e { ERROR, IDLE, READY, TCPCONNECTEDCLIENT };
+
+	// compatible methods with Arduino GSM/GPRS Shield library
+	int getStatus() { return _status; };
+	int begin(char* pin = 0);
+	int begin(char* pin, uint32_t baudrate);
+	int end(void);
+	int restart(int pin = 0);
+	int start(int pin = 0);
+	int shutdown(void);
+		//-- This library do not use "pin" parameter, so ignore it.
+	int getIMEI(char* imei);
+	int connectTCP(const char* server, int port);
+	int disconnectTCP(void);
+	int getStatusTCP(int *status, int *tcpnotif, long *remainedBytes, long *receivedBytes);
+	int setTCPParams(int timeout1, int timeout2);
+	int write(uint8_t c);	// support binary data
+	int write(const char* str);	// doesn't support binary data
+	int write(const uint8_t* buffer, size_t sz);	// support binary data
+	int writeBegin(size_t sz);
+	int tunnelBegin(uint32_t total);
+	int tunnelWrite(const uint8_t* data, size_t sz);
+	int tunnelEnd(void);
+	uint32_t tunnelRemains(void) { return _streamRemains + _tunnelRemains; };
+	int read(char* result, int resultlength);	// non-blocking I/O and doesn't support binary data
+	int read(void);		// non-blocking I/O and support binary data
+	int read(uint8_t* buffer, size_t sz);	// non-blocking I/O and support binary data
+	int getMissingBytes(void) { return (int)_missingBytes; };
+			//-- bytes which last read() couldn't receive within timeout(partial read)
+		//-- This library do not support tcp/ip server functions.
+	int httpGET(const char* server, uint16_t port, const char* path, char* result, int resultlength, boolean ssled = false, const char* header = NULL);
+	int httpPOST(const char* server, uint16_t port, const char* path, const char* header, const char* body, char* result, int* resultlength, boolean ssled = false);
+			//-- httpPOST() is not compatible parameters with Arduino GSM/GPRS Shield library
+	int httpGET(const char* server, uint16_t port, const char* path, Print& out, boolean ssled = false, const char* header = NULL);	//@add R1.1
+	int httpPOST(const char* server, uint16_t port, const char* path, const char* header, const char* body, Print& out, boolean ssled = false);	//@add R1.1
+			//-- response body is written into "out" by block as it arrives(no size limit)
+	int httpPOST(const char* server, uint16_t port, const char* path, const char* header, const uint8_t* body, size_t sz, Print& out, boolean ssled = false);	//@add R1.2
+	int httpPOST(const char* server, uint16_t port, const char* path, const char* header, Stream& body, size_t sz, Print& out, boolean ssled = false);	//@add R1.2
+			//-- body is binary(sz bytes), escaped on the fly, or sent through TCP tunnel if it doesn't fit in MAX_BODY_LENGTH
+	int tweet(const char* token, const char* msg);
+		//-- tweet() sends a message to twitter with the text "msg"and the token "token".
+		//-- Get the token from http://arduino-tweet.appspot.com/
+
+	//-- Extended methods --//
+	int getServices(int& status);
+	int getRSSI(int& rssi);
+	int getTime(char* date, char* time);
+	int getTime2(uint32_t& seconds);
+	int syncClock(void);	//@add R1.3
+	void setClockResync(uint32_t interval) { _clockResync = interval; };	//@add R1.3
+	int32_t getClockDrift(void) { return _clockDrift; };	//@add R1.3
+			//-- drift of millis() against the module [ppm](positive .. millis() is slow)
+	static uint32_t toSeconds(int year, int month, int day, int hour, int minute, int second);	//@add R1.3
+	static void fromSeconds(uint32_t seconds, char* date, char* time);	//@add R1.3
+	int getVersion(char *version);
+	int setDefaultProfile(const char *apn, const char *user, const char *password);
+	int getDefaultProfile(char *apn, char *user, char *password);
+	int setBaudrate(uint32_t baudrate);
+	int setLED(boolean sw);
+	int setAirplaneMode(boolean sw);
+	int enterAT(uint32_t duration);
+	int getResult(char *buf, int *len, uint32_t timeout);
+	int pollResult(char *buf, int *len);
+	int availableStatus(void);
+	int readStatus(char *buf, int len);
+	int startLocation(int method);	//@add R1.4
+	int startLocation2(void);	//@add R1.4
+	int pollLocation(void);	//@add R1.4
+	boolean isLocating(void) { return _locating != 0; };	//@add R1.4
+		//-- Don't call other functions which send command to 3GIM while isLocating() is true
+	int getLastLocation(char* latitude, char* longitude, uint32_t* age);	//@add R1.4
+	int getLastLocation2(char* latitude, char* longitude, char *height, char *utc, int *quality, int *number, uint32_t* age);	//@add R1.4
+		//-- Positioning is supported by 3GIM only
+
+  protected:
+	SerialT&	_serial;		// Serial port connected to 3GIM/4GIM
+	int _status;		// for Compatible with GSM.h
+	int _powerPin;
+	size_t _missingBytes;
+	uint32_t _streamRemains;		// Bytes not yet opened tunnel in stream
+	size_t _tunnelRemains;		// Bytes to be written into current tunnel
+	boolean _clockSynced;		// Clock has been synced with the module at least once
+	uint32_t _clockBase;		// Seconds since Jan 1 1970(JST) at the last sync
+	uint32_t _clockMillis;		// millis() at the last sync
+	uint32_t _clockChecked;		// millis() at the last sync attempt
+	uint32_t _clockResync;		// Interval to sync the clock [mS]
+	int32_t _clockDrift;		// Drift of millis() [ppm]
+	char _workBuffer[Limits::WORK_BUFFER_SIZE];		// Buffer for working
+	void sendCommand(const char* cmd);
+	void sendData(const char* data);
+	void discardUntil(const char match);
+	size_t writeEscaped(const uint8_t* data, size_t sz);
+	static size_t escapedSize(const uint8_t* data, size_t sz, size_t limit);	//@add R1.5
+	int openTunnel(void);
+	int closeTunnel(void);
+	size_t readBody(uint8_t* buffer, size_t keep, size_t nbytes);
+	void discardInput(void);
+	void fillRxBuffer(void);
+	int readRx(void);
+	long requestGET(const char* server, uint16_t port, const char* path, boolean ssled, const char* header);	//@add R1.1
+	long requestPOST(const char* server, uint16_t port, const char* path, const char* header, const char* body, const uint8_t* data, Stream* src, size_t sz, boolean ssled);	//@add R1.1 @change R1.2
+	int readHttpBody(long nbytes, Print& out);	//@add R1.1
+	int requestTime(uint32_t& seconds);	//@add R1.3
+	uint32_t countClock(void);	//@add R1.3
+	int postBinary(const char* server, uint16_t port, const char* path, const char* header, const uint8_t* data, Stream* src, size_t sz, Print& out, boolean ssled);	//@add R1.2
+	int postTunnel(const char* server, uint16_t port, const char* path, const char* header, const uint8_t* data, Stream* src, size_t sz, Print& out);	//@add R1.2
+	size_t sendBody(const uint8_t* data, Stream* src, size_t sz, boolean escape);	//@add R1.2
+	static int parseLocation(const char* res, boolean full, char* latitude, char* longitude, char* height, char* utc, int* quality, int* number);	//@add R1.4 @change R1.6
+	static const char* nextToken(const char* cp, char* dst, int size, char stop);	//@add R1.4
+	int _locating;		// Started positioning(0 .. none, 1 .. "$LG method", 2 .. "$LG - 1")
+	uint32_t _locationStarted;		// millis() at startLocation()/startLocation2()
+	int _fixType;		// Last fix(0 .. none, 1 .. latitude and longitude only, 2 .. all of getLocation2())
+	uint32_t _fixMillis;		// millis() at the last fix
+	GIMLocationFix<Limits::LOCATION_CACHE> _fix;		// The last fix(no storage if not LOCATION_CACHE) --@change R1.6
+
+  private:
+	static_assert((Limits::RX_BUFFER_SIZE & (Limits::RX_BUFFER_SIZE - 1)) == 0, "RX_BUFFER_SIZE must be power of 2");
+		// Received bytes are kept in the ring buffer, and lines are framed from it
+		// Bytes after a result line(ex. body of $WG) are left in the ring buffer and read as raw data
+	uint8_t _rxBuffer[Limits::RX_BUFFER_SIZE];
+	uint16_t _rxHead, _rxTail;		// Next position to write/read
+	char _lineBuffer[Limits::LINE_BUFFER_SIZE];		// Line being framed
+	int _lineLength;
+	GIMStatusLines<Limits::MAX_STATUS_LINES, Limits::MAX_STATUS_LENGTH> _statusLines;	// Status lines(ring) --@change R1.6
+		// Length of escaped character for 0x00..0x3f(others are not escaped)
+		//   4 .. control character("$xhh"), 2 .. '"' or '$'("$\"" or "$$"), 1 .. as is
+	static const uint8_t _escapedLength[0x40];
+	static const char _hexDigits[17];
+};
+
+template <class SerialT, class Limits>
+const uint8_t GIMCore<SerialT, Limits>::_escapedLength[0x40] = {
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1
+};
+
+template <class SerialT, class Limits>
+const char GIMCore<SerialT, Limits>::_hexDigits[17] = "0123456789abcdef";
+
+
+//***************************
+//	begin()
+//
+//	@description
+//		Begin to use 3GIM/4GIM function
+//	@return value
+//		0 .. OK(at least, Packet Switch or Circuit Switch is availabled)
+//		otherwise .. NG
+//	@param
+//		pin : Not used
+//	@note
+//		Change at R3.1 for 3GIM
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::begin(char* pin)
+{
+	char	version[gimMAX_VERSION_LENGTH+1];
+//--
+	gimDEBUG_PRINT(">begin()", Limits::BAUDRATE);
+
+	// Begin serial port
+	_serial.begin(Limits::BAUDRATE);
+
+	// Initilalize global variables
+	_status = IDLE;
+
+	// Get iem version and check it
+	int n;
+	for (n = 0; n < gimMAX_RETRY; n++) {
+		if (getVersion(version) == 0)
+			break;
+		delay(10);
+	}
+	if (n == gimMAX_RETRY)
+		return 1;	// NG -- Can't get version
+
+	if ((int)(atof(version) * 100 + 0.5) < Limits::MIN_FIRMWARE_VERSION) {
+		gimDEBUG_PRINT(">getVersion()", "IEM version is old");
+		return 2;	// NG -- IEM Version is old
+	}
+
+	return gimSUCCESS;  // OK
+}
+
+//***************************
+//	begin()
+//
+//	@description
+//		Begin to use 3GIM/4GIM function
+//	@return value
+//		0 .. OK(at least, Packet Switch or Circuit Switch is availabled)
+//		otherwise .. NG
+//	@param
+//		pin : Not used
+//		baudrate : baudrate to begin (2400/4800/9600/19200/38400/57600/115200)
+//	@note
+//		This function use to specify non-default baudrate.
+//		Change at R3.1 for 3GIM
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::begin(char* pin, uint32_t baudrate)
+{
+	char	version[gimMAX_VERSION_LENGTH+1];
+//--
+	gimDEBUG_PRINT(">begin()", baudrate);
+
+	// Begin serial port
+	_serial.end();
+	_serial.begin(baudrate);
+
+	// Initilalize global variables
+	_status = IDLE;
+
+	// Get iem version and check it
+	int n = 0;
+	for (n = 0; n < gimMAX_RETRY; n++) {
+		if (getVersion(version) == 0)
+			break;
+		delay(10);
+	}
+	if (n == gimMAX_RETRY)
+		return 1;	// NG -- Can't get version
+
+	if ((int)(atof(version) * 100 + 0.5) < Limits::MIN_FIRMWARE_VERSION) {
+		gimDEBUG_PRINT(">getVersion()", "IEM version is old");
+		return 2;	// NG -- IEM Version is old
+	}
+
+	return gimSUCCESS;  // OK
+}
+
+//***************************
+//	end()
+//
+//	@description
+//		End to use 3GIM/4GIM function
+//	@return value
+//		0 .. always
+//	@param
+//		none
+//	@note
+//		re-enable serial communication, call begin()
+//		Change at R3.1 for 3GIM
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::end(void)
+{
+	// End serial port
+	_serial.flush();	//--@R3.0 add
+	_serial.end();
+
+	// Clear receive buffers --@add R1.0
+	_rxHead = _rxTail = 0;
+	_lineLength = 0;
+	_statusLines.clear();		//@change R1.6
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	restart()
+//
+//	@description
+//		Restart 3GIM/4GIM
+//	@return value
+//		0 .. always
+//	@param
+//		pin : Not used
+//	@note
+//		Reboot time is about 40 Sec.
+//		Change at R3.1 for 3GIM
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::restart(int pin)
+{
+	sendCommand("$YE");		// Send "Reset IEM" Command
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	start()
+//
+//	@description
+//		Power on 3GIM/4GIM and wait for ready to use
+//	@return value
+//		0 .. always
+//	@param
+//		pin : 3GIM power control pin(if > 0) or not used(if <= 0)
+//	@note
+//		Start up time is about 15 Sec.
+//		Change at R3.1 for 3GIM
+//		Change at R4.0 for 3GIM(V2)
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::start(int pin)
+{
+	if (pin > 0)
+		_powerPin = pin;
+
+	// Turn on 3GIM
+	if (_powerPin > 0) {
+		pinMode(_powerPin, OUTPUT);
+		digitalWrite(_powerPin, HIGH);
+		delay(200);
+		digitalWrite(_powerPin, LOW);
+	}
+
+	if (Limits::START_BAUDRATE > 0)
+		_serial.begin(Limits::START_BAUDRATE);
+
+	gimDEBUG_PRINT(">start()", "Turn on and wait for a moment..");
+
+	delay(15000);	// Wait for ready IEM
+
+	gimDEBUG_PRINT(">start()", "IEM is available now.");
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	shutdown()
+//
+//	@description
+//		Power off 3GIM/4GIM
+//	@return value
+//		0 .. always
+//	@param
+//		none
+//	@note
+//		Shutdown time is about 15 Sec.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::shutdown(void)
+{
+	sendCommand("$YE");		// Send "Reset 3GIM" Command
+	delay(2000);		// Wait a moment
+
+	// Turn off 3GIM
+	if (_powerPin > 0)
+		digitalWrite(_powerPin, HIGH);
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	getService
+//
+//	@description
+//		Get network service status
+//	@return value
+//		0 .. Succeeded, otherwise .. Failed
+//	@param
+//		status .. [OUT] SRV* (see gimcore.h)
+//	@note
+//		
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::getServices(int& status)
+{
+	char responses[12];		// Format "$YS=OK 9" or "$YS=NG errno"
+	int  length = sizeof(responses);
+//--
+	sendCommand("$YS");	// Send "Get Services" command
+
+	if (getResult(responses, &length, Limits::TIMEOUT_LOCAL))
+		return 1;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">getServices()", responses);
+
+	// parse response
+	switch (responses[7]) {
+		case '0' :		// NO_SRV
+			status = gimSRV_NO;
+			break;
+		case '1' :		// PS_ONLY
+			status = gimSRV_PS;
+			break;
+		case '2' :		// CS_ONLY
+			status = gimSRV_CS;
+			break;
+		case '3' :		// BOTH
+			status = gimSRV_BOTH;
+			break;
+		default : 		// bug
+			return 1;		// NG -- Can't get service
+	}
+
+	return gimSUCCESS;		// OK
+}
+
+//***************************
+//	getIMEI()
+//
+//	@description
+//		Get IEM's IMEI
+//	@return value
+//		0 .. Succeeded
+//		otherwise .. Failed
+//	@param
+//		imei : [OUT] IMEI (gimIMEI_SIZE bytes space requred)
+//	@note
+//		
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::getIMEI(char* imei)
+{
+	char responses[gimIMEI_SIZE+10];  // Format "$YI=OK 99..99" or "$YI=NG errno"
+	int  length = sizeof(responses);
+//--
+	sendCommand("$YI");		// Send "Get IMEI" command
+
+	if (getResult(responses, &length, Limits::TIMEOUT_LOCAL))
+		return 1;  // NG -- maybe timeout
+
+	gimDEBUG_PRINT(">getIMEI()", responses);
+
+	// parse response
+	if (strncmp(responses, "$YI=OK", 6))
+		return 1;	// NG -- Can't get IMEI
+
+	strncpy(imei, responses+7, gimIMEI_SIZE);
+	imei[gimIMEI_SIZE-1] = '\0';
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	setBaudrate
+//
+//	@description
+//		Set UART baudrate
+//	@return value
+//		0 .. OK
+//		1 .. NG
+//	@param
+//		baudrate : baudrate to set (2400/4800/9600/19200/38400/57600/115200)
+//	@note
+//		New baudrate will be validated after reset IEM
+//		Change at R4.0 for 3GIM(V2)
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::setBaudrate(uint32_t baudrate)
+{
+	char command[13];
+	char responses[12];  // Format "$YB=OK" or "$YB=NG errno"
+	int  length = sizeof(responses);
+//--
+	switch (baudrate) {
+//	case 2400 :
+//	case 4800 :
+		case 9600 :
+		case 19200 :
+		case 38400 :
+		case 57600 :
+		case 115200 :
+			break;
+		default :
+			return 1;	// NG -- Bad parameter
+	}
+
+	// Make command and send it
+	sprintf(command, "$YB %lu", baudrate);
+	sendCommand(command);	// Send "Set Baudrate" command
+
+	if (getResult(responses, &length, Limits::TIMEOUT_LOCAL))
+		return 1;  // NG -- maybe timeout
+
+	gimDEBUG_PRINT(">setBaudrate()", responses);
+
+	// parse response
+	if (strncmp(responses, "$YB=OK", 6))
+		return 1;	// NG -- Can't set baudrate
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	setLED
+//
+//	@description
+//		Set LED On/Off
+//	@return value
+//		0 .. OK
+//		1 .. NG
+//	@param
+//		sw : true is On, false is Off
+//	@note
+//		There is LED on 3G shield board(named LED1)
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::setLED(boolean sw)
+{
+	char command[10];
+	char responses[12];  // Format "$YL=OK" or "$YL=NG errno"
+	int  length = sizeof(responses);
+//--
+	// Make command and send it
+	sprintf(command, "$YL %d", (sw ? 1 : 0));
+	sendCommand(command);	// Send "Set LED" command
+
+	if (getResult(responses, &length, Limits::TIMEOUT_LOCAL))
+		return 1;  // NG -- maybe timeout
+
+	gimDEBUG_PRINT(">setLED()", responses);
+
+	// parse response
+	if (strncmp(responses, "$YL=OK", 6))
+		return 1;	// NG -- Can't set led
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	setAirplaneMode
+//
+//	@description
+//		Set airplane mode
+//	@return value
+//		0 .. OK
+//		1 .. NG
+//	@param
+//		sw : true is On(Airplane mode), false is Off(Normal mode)
+//	@note
+//		R3.0 add
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::setAirplaneMode(boolean sw)
+{
+	char command[10];
+	char responses[12];  // Format "$YP=OK" or "$YP=NG errno"
+	int  length = sizeof(responses);
+//--
+	// Make command and send it
+	sprintf(command, "$YP %d", (sw ? 1 : 0));
+	sendCommand(command);	// Send "Set Airplane mode" command
+
+	if (getResult(responses, &length, Limits::TIMEOUT_LOCAL))
+		return 1;  // NG -- maybe timeout
+
+	gimDEBUG_PRINT(">setAirplaneMode()", responses);
+
+	// parse response
+	if (strncmp(responses, "$YP=OK", 6))
+		return 1;	// NG -- Can't set airplane mode
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	httpGET
+//
+//	@description
+//		Request HTTP/GET to server and port
+//
+//	@return value
+//		0 .. OK
+//		otherwise .. NG
+//	@param
+//		server : server name(ex. "www,google.com")
+//		port : port number(ex. 80)
+//		path : path(ex. service/index.html)
+//		result : [OUT] responce raw data(no escaped, '\0' terminated)
+//		resultlength ; "result" size(body longer than Limits::MAX_RESULT_LENGTH is truncated)
+//		ssled : if true then use https(SSL), otherwise use http
+//	@note
+//		This function is synchronized.
+//		Support optional parameter "header" since @R3.0
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::httpGET(const char* server, uint16_t port, const char* path, char* result, int resultlength, boolean ssled, const char* header)
+{
+	GIMBufferPrint	out(result, (resultlength <= Limits::MAX_RESULT_LENGTH) ? resultlength : Limits::MAX_RESULT_LENGTH + 1);	//@change R1.6
+//--
+	long nbytes = requestGET(server, port, path, ssled, header);		//@change R1.1
+	if (nbytes < 0)
+		return 1;	// NG -- Can't get response
+
+	// Copy response body into "result"
+	return readHttpBody(nbytes, out);		//@change R1.1
+}
+
+//***************************
+//	httpGET
+//
+//	@description
+//		Request HTTP/GET to server and port, and write response body into "out"
+//
+//	@return value
+//		0 .. OK
+//		1 .. NG (Bad parameter or can't get response)
+//		2 .. NG (Timeout while receiving response body)
+//	@param
+//		server : server name(ex. "www,google.com")
+//		port : port number(ex. 80)
+//		path : path(ex. service/index.html)
+//		out : [OUT] Print(ex. File) to write response body(raw data, no escaped)
+//		ssled : if true then use https(SSL), otherwise use http
+//		header : extra header or NULL
+//	@note
+//		Add @R1.1
+//		Response body is written by block(HTTP_BLOCK_SIZE bytes) as it arrives,
+//		so that the body larger than RAM can be parsed or stored.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::httpGET(const char* server, uint16_t port, const char* path, Print& out, boolean ssled, const char* header)
+{
+	long nbytes = requestGET(server, port, path, ssled, header);
+	if (nbytes < 0)
+		return 1;	// NG -- Can't get response
+
+	return readHttpBody(nbytes, out);
+}
+
+//***************************
+//	httpPOST
+//
+//	@discription
+//		Request HTTP/POST to server and port
+//
+//	@return value
+//		0 .. OK
+//		otherwise .. NG
+//  @param
+//		server : server name(ex. "www,google.com")
+//		port : port number(ex. 80)
+//		path : path(ex. service/index.html)
+//		header : header(without Content-Length, nul terminate, max MAX_HEADER_LENGTH)
+//		body : request body(nul terminate, max MAX_BODY_LENGTH, escaped by the caller, see @note)
+//		result : [OUT] responce raw data(no escaped)
+//		resultlength ; [IN/OUT] "result" size and body length(body longer than Limits::MAX_RESULT_LENGTH is truncated)
+//		ssled : if true then use https(SSL), otherwise use http
+//	@note
+//		This function is synchronized.
+//		"header" and "body" are sent into $WP command as is(not escaped by this function), so the caller
+//		escapes them as the command requires: '"' -> "$\"", '$' -> "$$", CR/LF -> "$r"/"$n", other control
+//		characters -> "$xhh" (ex. "{$\"value$\" : 1}"). MAX_BODY_LENGTH limits the escaped length.
+//		Use httpPOST() with binary body(uint8_t*, sz) to have raw data escaped by this library.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::httpPOST(const char* server, uint16_t port, const char* path, const char *header, const char *body, char* result, int* resultlength, boolean ssled)
+{
+	int		size = (*resultlength <= Limits::MAX_RESULT_LENGTH) ? *resultlength : Limits::MAX_RESULT_LENGTH + 1;	//@add R1.6
+	GIMBufferPrint	out(result, size);
+//--
+	long nbytes = requestPOST(server, port, path, header, body, NULL, NULL, 0, ssled);		//@change R1.1
+	if (nbytes < 0)
+		return 1;	// NG -- Can't post or get response
+
+	// Copy response body into "result" and set "resultlength"
+	int rc = readHttpBody(nbytes, out);		//@change R1.1
+	if (nbytes <= size - 1)		//@change R1.6
+		*resultlength = (int)nbytes;
+
+	return rc;
+}
+
+//***************************
+//	httpPOST
+//
+//	@discription
+//		Request HTTP/POST to server and port, and write response body into "out"
+//
+//	@return value
+//		0 .. OK
+//		1 .. NG (Bad parameter or can't post)
+//		2 .. NG (Timeout while receiving response body)
+//  @param
+//		server : server name(ex. "www,google.com")
+//		port : port number(ex. 80)
+//		path : path(ex. service/index.html)
+//		header : header(without Content-Length, nul terminate, max MAX_HEADER_LENGTH)
+//		body : request body(nul terminate, max MAX_BODY_LENGTH, escaped by the caller, see @note)
+//		out : [OUT] Print(ex. File) to write response body(raw data, no escaped)
+//		ssled : if true then use https(SSL), otherwise use http
+//	@note
+//		Add @R1.1
+//		Response body is written by block(HTTP_BLOCK_SIZE bytes) as it arrives.
+//		Same as above about escaping of "header" and "body".
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::httpPOST(const char* server, uint16_t port, const char* path, const char *header, const char *body, Print& out, boolean ssled)
+{
+	long nbytes = requestPOST(server, port, path, header, body, NULL, NULL, 0, ssled);
+	if (nbytes < 0)
+		return 1;	// NG -- Can't post or get response
+
+	return readHttpBody(nbytes, out);
+}
+
+//***************************
+//	httpPOST
+//
+//	@discription
+//		Request HTTP/POST with binary body to server and port, and write response body into "out"
+//
+//	@return value
+//		0 .. OK
+//		1 .. NG (Bad parameter or can't post)
+//		2 .. NG (Timeout while receiving response body)
+//  @param
+//		server : server name(ex. "www,google.com")
+//		port : port number(ex. 80)
+//		path : path(ex. service/index.html)
+//		header : header(without Content-Length, nul terminate, max MAX_HEADER_LENGTH)
+//		body : request body(binary data, may contain '\0')
+//		sz : size of "body" in bytes
+//		out : [OUT] Print(ex. File) to write response body(raw data, no escaped)
+//		ssled : if true then use https(SSL), otherwise use http
+//	@note
+//		Add @R1.2
+//		The escaped size of "body" is counted before sending(escapedSize()).
+//		If escaped "body" fits in MAX_BODY_LENGTH, it is escaped on the fly into $WP command(no staging buffer).
+//		Otherwise the request is sent as HTTP/1.0 through TCP tunnel($TT), http only(ssled must be false),
+//		and the response body(after headers) is written into "out" until the server closes the connection.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::httpPOST(const char* server, uint16_t port, const char* path, const char *header, const uint8_t* body, size_t sz, Print& out, boolean ssled)
+{
+	return postBinary(server, port, path, header, body, NULL, sz, out, ssled);
+}
+
+//***************************
+//	httpPOST
+//
+//	@discription
+//		Request HTTP/POST with body read from Stream to server and port, and write response body into "out"
+//
+//	@return value
+//		0 .. OK
+//		1 .. NG (Bad parameter, can't post or "body" ran short)
+//		2 .. NG (Timeout while receiving response body)
+//  @param
+//		server : server name(ex. "www,google.com")
+//		port : port number(ex. 80)
+//		path : path(ex. service/index.html)
+//		header : header(without Content-Length, nul terminate, max MAX_HEADER_LENGTH)
+//		body : Stream(ex. File) to read request body from(binary data)
+//		sz : bytes to be read from "body" and posted
+//		out : [OUT] Print(ex. File) to write response body(raw data, no escaped)
+//		ssled : if true then use https(SSL), otherwise use http
+//	@note
+//		Add @R1.2
+//		"body" is read by block(HTTP_BLOCK_SIZE bytes), so large body(ex. file on SD) can be posted with small RAM.
+//		If "body" runs short(timeout), the request is already on the way and can't be canceled,
+//		so the rest is padded with 0x00 up to "sz" bytes, the response is discarded and NG(1) is returned.
+//		Same as above about MAX_BODY_LENGTH and TCP tunnel, but "body" is assumed to be escaped to 4 times
+//		(sz > MAX_BODY_LENGTH / 4 is sent through TCP tunnel).
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::httpPOST(const char* server, uint16_t port, const char* path, const char *header, Stream& body, size_t sz, Print& out, boolean ssled)
+{
+	return postBinary(server, port, path, header, NULL, &body, sz, out, ssled);
+}
+
+//***************************
+//	tweet
+//
+//	@description
+//		Tweet a message
+//
+//	@return value
+//		0 .. OK
+//		otherwise .. NG
+//	@param
+//		token .. token from http://arduino-tweet.appspot.com/
+//		msg .. message to tweet(in UTF-8)
+//	@note
+//		This function use cloud service on "arduino-tweet.appspot.com".
+//		Notice from this service:
+//		- The library uses this site as a proxy server for OAuth stuff. Your tweet may not be applied during maintenance of this site.
+//		- Please avoid sending more than 1 request per minute not to overload the server.
+//		- Twitter seems to reject repeated tweets with the same contenet (returns error 403).
+//		Use _workBuffer and destory it
+
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::tweet(const char* token, const char* msg)
+{
+	int	resultlength = sizeof(_workBuffer);
+//--
+	if (strlen(msg) > Limits::MAX_TWEET_LENGTH)
+		return 8;  // Too long message. (@@ check by number of characters, not bytes)
+
+	sprintf(_workBuffer, "token=%s&status=%s", token, msg);
+
+	// request POST to http://arduino-tweet.appspot.com
+	return httpPOST("arduino-tweet.appspot.com", 80, "update", NULL, _workBuffer, _workBuffer, &resultlength);
+}
+
+//***************************
+//	getTime
+//
+//	@description
+//		Get current date and time
+//	@return value
+//		0 .. OK
+//		otherwise .. NG
+//	@param
+//		date : [OUT] current date(JST) ("YYYY/MM/DD" format)
+//		time : [OUT] current time(JST) ("HH:MM:SS" format)
+//	@note
+//		Change at R4.0 for 3GIM(V2)
+//		Change at R1.3: Served from the clock(see getTime2())
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::getTime(char date[], char time[])
+{
+	uint32_t	seconds;
+//--
+	if (getTime2(seconds) != 0)		//@change R1.3
+		return 1;	// NG -- Can't get time
+
+	fromSeconds(seconds, date, time);
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	getTime2
+//
+//	@description
+//		Get the current time as seconds since Jan 1 1970
+//	@return value
+//		0 .. OK
+//		otherwise .. NG
+// 	@param
+//		seconds : [OUT] Current seconds since Jan 1 1970(JST)
+//	@note
+//		Change at R1.3:
+//		The clock is synced with the module($YT) only when the resync interval(setClockResync()) has passed,
+//		and the time between syncs is counted by millis() corrected with measured drift.
+//		If the sync fails after the clock has been synced, the counted time is returned and
+//		the next sync is tried after the resync interval.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::getTime2(uint32_t& seconds)
+{
+	if (! _clockSynced || millis() - _clockChecked >= _clockResync) {	//@change R1.3
+		if (syncClock() != 0 && ! _clockSynced)
+			return 1;	// NG -- can't get time, Failed.
+	}
+
+	seconds = countClock();
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	syncClock
+//
+//	@description
+//		Sync the clock with the module now, and measure drift of millis()
+//	@return value
+//		0 .. OK
+//		otherwise .. NG
+// 	@param
+//		none
+//	@note
+//		Add @R1.3
+//		Drift is measured over CLOCK_DRIFT_SPAN or longer, and smoothed over syncs.
+//		The module has 1 second resolution, so longer resync interval gives more accurate drift.
+//		A sample over gimMAX_CLOCK_DRIFT is regarded as time adjustment of the module and not used for drift.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::syncClock(void)
+{
+	uint32_t	seconds;
+//--
+	_clockChecked = millis();
+	if (requestTime(seconds) != 0)
+		return 1;	// NG -- can't get time
+
+	uint32_t now = millis();
+	uint32_t elapsed = now - _clockMillis;
+	boolean rebase = ! _clockSynced;
+	if (_clockSynced && elapsed >= Limits::CLOCK_DRIFT_SPAN) {
+		// Compare elapsed time of the module with millis()
+		int64_t error = ((int64_t)seconds - _clockBase) * 1000L - elapsed;
+		// Large error(ex. time adjusted by NTP) is rejected before dividing, so drift always fits in int32_t
+		int64_t limit = (int64_t)elapsed * gimMAX_CLOCK_DRIFT / 1000000L;
+		if (error > -limit && error < limit) {
+			int32_t drift = (int32_t)(error * 1000000L / elapsed);
+			_clockDrift = (_clockDrift == 0) ? drift : (_clockDrift + drift) / 2;
+		}
+		gimDEBUG_PRINT(">syncClock() drift", _clockDrift);
+		rebase = true;
+	}
+	else if (_clockSynced) {
+		// Keep the base for drift measurement until the span has passed, unless the module time was adjusted
+		uint32_t counted = countClock();
+		rebase = (seconds > counted + 1 || counted > seconds + 1);
+	}
+	if (rebase) {
+		_clockBase = seconds;
+		_clockMillis = now;
+	}
+	_clockSynced = true;
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	toSeconds
+//
+//	@description
+//		Convert date and time into seconds since Jan 1 1970
+//	@return value
+//		seconds since Jan 1 1970
+// 	@param
+//		year : year(1970..2105)
+//		month : month(1..12)
+//		day : day(1..31)
+//		hour, minute, second : time(24h-way)
+//	@note
+//		Add @R1.3
+//		Closed-form(no loop) calculation with year starting from March, leap day is the last day of year.
+//***************************
+template <class SerialT, class Limits>
+uint32_t GIMCore<SerialT, Limits>::toSeconds(int year, int month, int day, int hour, int minute, int second)
+{
+	if (month <= 2)
+		year--;		// Jan. and Feb. belong to the previous year
+	int32_t era = year / 400;
+	int32_t yoe = year - era * 400;									// [0, 399]
+	int32_t doy = (153L * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;	// [0, 365]
+	int32_t doe = yoe * 365L + yoe / 4 - yoe / 100 + doy;				// [0, 146096]
+	int32_t days = era * 146097L + doe - 719468L;						// days since 1970/01/01
+
+	return (uint32_t)days * gimSECS_PER_DAY + hour * gimSECS_PER_HOUR + minute * gimSECS_PER_MIN + second;
+}
+
+//***************************
+//	fromSeconds
+//
+//	@description
+//		Convert seconds since Jan 1 1970 into date and time
+//	@return value
+//		none
+// 	@param
+//		seconds : seconds since Jan 1 1970
+//		date : [OUT] date ("YYYY/MM/DD" format, at least gimDATE_SIZE bytes)
+//		time : [OUT] time ("HH:MM:SS" format, at least gimTIME_SIZE bytes)
+//	@note
+//		Add @R1.3
+//		Closed-form(no loop) calculation, inverse of toSeconds().
+//***************************
+template <class SerialT, class Limits>
+void GIMCore<SerialT, Limits>::fromSeconds(uint32_t seconds, char* date, char* time)
+{
+	uint32_t secs = seconds % gimSECS_PER_DAY;
+	int32_t days = (int32_t)(seconds / gimSECS_PER_DAY) + 719468L;	// days since 0000/03/01
+	int32_t era = days / 146097L;
+	int32_t doe = days - era * 146097L;									// [0, 146096]
+	int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;	// [0, 399]
+	int32_t doy = doe - (365L * yoe + yoe / 4 - yoe / 100);				// [0, 365]
+	int mp = (int)((5 * doy + 2) / 153);								// [0, 11] from March
+	int day = (int)(doy - (153L * mp + 2) / 5 + 1);
+	int month = (mp < 10) ? mp + 3 : mp - 9;
+	int year = (int)(yoe + era * 400) + (month <= 2 ? 1 : 0);
+
+	sprintf(date, "%04d/%02d/%02d", year, month, day);
+	sprintf(time, "%02d:%02d:%02d", (int)(secs / gimSECS_PER_HOUR), (int)(secs % gimSECS_PER_HOUR / gimSECS_PER_MIN), (int)(secs % gimSECS_PER_MIN));
+}
+
+//***************************
+//	getRSSI
+//
+//	@description
+//		Get 3G RSSI
+//	@return value
+//		0 .. OK
+//		1 .. NG
+//	@param
+//		rssi : [OUT] rssi (dBm)
+//	@note
+//		
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::getRSSI(int& rssi)
+{
+	char	responses[13];  // Format "$YR=OK -999"
+	int	length = sizeof(responses);
+//--
+	sendCommand("$YR");	// Send "Get RSSI" command
+
+	if (getResult(responses, &length, Limits::TIMEOUT_LOCAL))
+		return 1;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">getRSSI()", responses);
+
+	// Check response is ok --@add R4.3
+	if (responses[4] != 'O' || responses[5] != 'K')
+		return 1;	// NG -- can't get rssi
+
+	// Parse response
+	rssi = atoi(responses + 7);
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	getVersion
+//
+//	@description
+//		Get Version
+//	@return value
+//		0 .. OK
+//		1 .. NG
+//	@param
+//		version : [OUT] version ("X.YY")
+//	@note
+//		
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::getVersion(char *version)
+{
+	char	responses[13];  // Format "$YV=OK 9.99"
+	int	length = sizeof(responses);
+//--
+	sendCommand("$YV");	// Send "Get Version" command
+
+	if (getResult(responses, &length, Limits::TIMEOUT_LOCAL))
+		return 1;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">getVersion()", responses);
+
+	// Copy version
+	if (strncmp(responses, "$YV", 3) != 0)
+		return 2;	// NG -- can't get version
+
+	strcpy(version, responses + 7);
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	setDefaultProfile
+//
+//	@description
+//		Set default profile(APN) number
+//	@return value
+//		0 .. OK
+//		1 .. NG(Bad parameters)
+//		2 .. NG(Internal error - timeout)
+//		3 .. NG(Internal error - $PS error)
+//	@param
+//		apn : APN
+//		user : Auth user name
+//		password : Auth password
+//	@note
+//		Change interface from R4.0
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::setDefaultProfile(const char *apn, const char *user, const char *password)
+{
+	char responses[20];  // Format "$PS=OK\n" or "$PS=NG 999\n"
+	int	length = sizeof(responses);
+//--
+	if (strlen(apn) + strlen(user) + strlen(password) > 51)
+		return 1;	// NG -- Bad parameter(too long)
+
+	sprintf(_workBuffer, "$PS \"%s\" \"%s\" \"%s\"", apn, user, password);
+	sendCommand(_workBuffer);		// Send "Set Profile" command
+
+	if (getResult(responses, &length, Limits::TIMEOUT_NETWORK))
+		return 2;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">setDefaultProfile()", responses);
+
+	// parse response
+	if (! strncmp(responses, "$PS=NG", 6))
+		return 3;	// NG --  Can't set prfoile number
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	getDefaultProfile
+//
+//	@description
+//		Get default profile(APN) number
+//	@return value
+//		0 .. OK
+//		1 .. NG
+//	@param
+//		apn : [OUT] APN
+//		user : [OUT] Auth user name
+//		password : [OUT] Auth password
+//	@note
+//		Change interface from R4.0
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::getDefaultProfile(char *apn, char *user, char *password)
+{
+	int	length = sizeof(_workBuffer);
+	char *p;
+//--
+	sendCommand("$PS");	// Send "Get Profile" command
+
+	if (getResult(_workBuffer, &length, Limits::TIMEOUT_LOCAL))
+		return 1;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">getDefaultProfile()", _workBuffer);
+
+	// parse response and set out parameters
+	for (p = _workBuffer + 8; *p != '"'; p++)
+		*apn++ = *p;
+	*apn = '\0';
+	for (p += 3; *p != '"'; p++)
+		*user++ = *p;
+	*user = '\0';
+	for (p += 3; *p != '"'; p++)
+		*password++ = *p;
+	*password = '\0';
+	
+	return gimSUCCESS;  // Succeeded
+}
+
+//***************************
+//	connectTCP
+//
+//	@description
+//		Connect to server with TCP/IP connection
+//	@return value
+//		0 .. OK
+//		1 .. NG
+//	@param
+//		server : server name or IP address(ex. "www,google.com", "192.161.10.1")
+//		port : port number(ex. 80)
+//	@note
+//		
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::connectTCP(const char* server, int port)
+{
+	char	responses[30];		// FORMAT: "$TC=OK\n" or "$TC=NG errno [info]\n"
+	int	length = sizeof(responses);
+//--
+	// Check parameter size
+	if (strlen(server) > gimMAX_HOST_LENGTH)
+		return 1;	// NG -- too long host name
+	// Make command and send it
+	sprintf(_workBuffer, "$TC %s %d", server, port);
+	sendCommand(_workBuffer);
+
+	if (getResult(responses, &length, Limits::TIMEOUT_NETWORK))
+		return 1;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">connectTCP()", responses);
+
+	// parse response
+	if (! strncmp(responses, "$TC=NG", 6))
+		return 1;	// NG --  Can't connect
+
+	// Change status
+	_status = TCPCONNECTEDCLIENT;
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	disconnectTCP
+//
+//	@description
+//		Disconnect from server with current TCP/IP connection
+//	@return value
+//		0 .. OK
+//		1 .. NG
+//	@param
+//		none
+//	@note
+//		
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::disconnectTCP()
+{
+	char	responses[30];		// FORMAT: "$TD=OK\n" or "$TD=NG errno [info]\n"
+	int	length = sizeof(responses);
+//--
+	// Send command
+	sendCommand("$TD");
+
+	if (getResult(responses, &length, Limits::TIMEOUT_NETWORK))
+		return 1;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">disconnectTCP()", responses);
+
+	// parse response
+	if (! strncmp(responses, "$TD=NG", 6))
+		return 1;	// NG --  Can't connect
+
+	// Change status
+	_status = READY;
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	getStatusTCP
+//
+//	@description
+//		Get TCP/IP status
+//	@return value
+//		0 .. OK
+//		1 .. NG (Internal error, etc.)
+//	@param
+//		status : [out] See this library user manual.
+//		tcpnotif : [out] See this library user manual.
+//		remainedBytes : [out] Number of bytes waiting to be sent
+//		receivedBytes :  [out] Number of received bytes
+//	@note
+//		Add ths function from R4.3
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::getStatusTCP(int *status, int *tcpnotif, long *remainedBytes, long *receivedBytes)
+{
+	int	length = sizeof(_workBuffer);
+	char *p;
+	// $TS=OK status tcpnotif remainedBytes receivedBytes\n
+//--
+	// Send command
+	sendCommand("$TS1");
+
+	if (getResult(_workBuffer, &length, Limits::TIMEOUT_LOCAL))
+		return 1;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">getStatusTCP()", _workBuffer);
+	
+	// parse response and set out parameters
+	for (p = _workBuffer + 7; isspace(*p); p++)
+		;
+	*status = atoi(p);
+	while (gimISDIGIT(*p))
+		p++;	// skip number(status)
+	while (isspace(*p))
+		p++;	// skip space(s)
+	*tcpnotif = atoi(p);
+	while (gimISDIGIT(*p))
+		p++;	// skip number(status)
+	while (isspace(*p))
+		p++;	// skip space(s)
+	*remainedBytes = atol(p);
+	while (gimISDIGIT(*p))
+		p++;	// skip number(status)
+	while (isspace(*p))
+		p++;	// skip space(s)
+	*receivedBytes = atol(p);
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	setTCPParams
+//
+//	@description
+//		Set TCP/IP parameters
+//	@return value
+//		0 .. OK
+//		1 .. NG (Bad parameter)
+//		2 .. NG (Internal error, etc.)
+//	@param
+//		timeout1 : timeout to connectTCP() [10mS]
+//		timeout2 : timeout to read() and write() [10mS]
+//	@note
+//		Add ths function from R4.3
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::setTCPParams(int timeout1, int timeout2)
+{
+	char command[30], responses[20];  // Format "$TX=OK" or "$TX=NG errno"
+	int  length = sizeof(responses);
+
+	// Check parameters
+	if (timeout1 < 0 || timeout1 > 6000)
+		return 1;			// NG -- Bad params
+	if (timeout2 < 0 || timeout2 > 6000)
+		return 1;			// NG -- Bad params
+		
+	// Make command and send it
+	sprintf(command, "$TX %d %d", timeout1, timeout2);
+	sendCommand(command);	// Send "Set TCP/IP parameters" command
+
+	// Get response
+	if (getResult(responses, &length, Limits::TIMEOUT_LOCAL))
+		return 2;  			// NG -- maybe internal error
+
+	// parse response
+	if (strncmp(responses, "$TX=OK", 6))
+		return 1;			// NG(Bad params, etc.)
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	write
+//
+//	@description
+//		Write byte into current TCP/IP connection
+//	@return value
+//		-1 .. NG (Error)
+//		 1 .. OK
+//	@param
+//		c : byte data to write
+//	@note
+//		R2.3 bug fix(binary data escaping)
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::write(uint8_t c)
+{
+	char	responses[30];		// FORMAT: "$TW=OK nbytes\n" or "$TW=NG errno [info]\n"
+	int	length = sizeof(responses);
+//--
+	// Make command and send it
+	sendData("$TW \"");
+	writeEscaped(&c, 1);		//@change R1.0
+	sendCommand("\"");
+
+	if (getResult(responses, &length, Limits::TIMEOUT_NETWORK))
+		return -1;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">write()", responses);
+
+	// parse response
+	if (! strncmp(responses, "$TW=NG", 6))
+		return -1;	// NG --  Can't connect
+
+	int	nbytes = atoi(responses + 7);
+
+	return nbytes;	// OK
+}
+
+//***************************
+//	write
+//
+//	@description
+//		Write string into current TCP/IP connection
+//	@return value
+//		-1 .. NG (Error)
+//		0 < .. OK (= wrote bytes)
+//	@param
+//		str : string(= '\0' terminated byte array) to write
+//	@note
+//		"str" must be encoded by $ escape sequence
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::write(const char* str)
+{
+	char	responses[30];		// FORMAT: "$TW=OK nbytes" or "$TW=NG errno [info]\n"
+	int	length = sizeof(responses);
+//--
+	if (strlen(str) > gimMAX_DATA_LENGTH)
+		return -1;	// NG -- too large data
+
+	// Make command and send it
+	sendData("$TW \"");
+	sendData(str);
+	sendCommand("\"");
+
+	if (getResult(responses, &length, Limits::TIMEOUT_NETWORK))
+		return -1;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">write()", responses);
+
+	// parse response
+	if (! strncmp(responses, "$TW=NG", 6))
+		return -1;	// NG --  Can't connect
+
+	int	nbytes = atoi(responses + 7);
+
+	return nbytes;	// OK
+}
+
+//***************************
+//	write
+//
+//	@description
+//		Write byte data into current TCP/IP connection
+//	@return value
+//		-1 .. NG (Error)
+//		0 < .. OK (= wrote bytes)
+//	@param
+//		buffer : data to write(byte array)
+//		sz : data size(in byte)
+//	@note
+//		R2.3 bug fix(binary data escaping)
+//		gimMAX_DATA_LENGTH limits "sz"(raw bytes), the escaped data sent by writeEscaped() is at most 4 times of it.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::write(const uint8_t* buffer, size_t sz)
+{
+	char	responses[30];		// FORMAT: "$TW=OK nbytes\n" or "$TW=NG errno [info]\n"
+	int	length = sizeof(responses);
+//--
+	if (sz > (size_t)gimMAX_DATA_LENGTH)
+		return -1;	// NG -- too large data
+
+	// Make command and send it
+	sendData("$TW \"");
+	writeEscaped(buffer, sz);		//@change R1.0
+	sendCommand("\"");
+
+	if (getResult(responses, &length, Limits::TIMEOUT_NETWORK))
+		return -1;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">write()", responses);
+
+	// parse response
+	if (! strncmp(responses, "$TW=NG", 6))
+		return -1;	// NG --  Can't connect
+
+	int	nbytes = atoi(responses + 7);
+
+	return nbytes;	// OK
+}
+
+//***************************
+//	writeBegin
+//
+//	@description
+//		Begin to write byte stream into current TCP/IP connection
+//		User will write binary/text data _serial directly
+//	@return value
+//		-1 .. NG (Error)
+//		0 < .. OK (= wrote bytes)
+//	@param
+//		sz : data size(in byte)
+//	@note
+//		Add R4.0 for 3GIM(V2)
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::writeBegin(size_t sz)
+{
+	int	length = sizeof(_workBuffer);
+//--
+	if (sz > gimMAX_TUNNEL_DATA_LENGTH)
+		return -1;	// NG -- Bad parameter
+
+	// Make command and send it
+	sprintf(_workBuffer, "$TT %u", (unsigned int)sz);		//@change R1.0 bug fix("%ud" sent extra 'd')
+	sendCommand(_workBuffer);
+
+	if (getResult(_workBuffer, &length, Limits::TIMEOUT_LOCAL))
+		return (-1);		// NG -- can't read
+
+	gimDEBUG_PRINT(">writeBegin()", _workBuffer);
+
+	if (! strncmp(_workBuffer, "$TT=NG", 6))
+		return (-1);		// NG -- can't open tunnel --@add R1.0
+
+	return gimSUCCESS;		// OK
+}
+
+//***************************
+//	tunnelBegin
+//
+//	@description
+//		Begin to stream byte data into current TCP/IP connection through tunnel($TT)
+//	@return value
+//		-1 .. NG (Error)
+//		 0 .. OK
+//	@param
+//		total : total data size(in byte), it may be larger than gimMAX_TUNNEL_DATA_LENGTH
+//	@note
+//		Add R1.0
+//		Write data by tunnelWrite() in pieces, and finish by tunnelEnd().
+//		Data larger than gimMAX_TUNNEL_DATA_LENGTH is split into several tunnels automatically.
+//		Data is not escaped, so it is faster than write() for binary data.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::tunnelBegin(uint32_t total)
+{
+	if (total == 0 || _streamRemains > 0 || _tunnelRemains > 0)
+		return (-1);		// NG -- Bad parameter or previous stream is not completed
+
+	_streamRemains = total;
+
+	return openTunnel();
+}
+
+//***************************
+//	tunnelWrite
+//
+//	@description
+//		Write byte data into tunnel began by tunnelBegin()
+//	@return value
+//		-1 .. NG (Error)
+//		0 <= .. OK (= wrote bytes, less than "sz" if it exceeds remained bytes)
+//	@param
+//		data : data to write(byte array)
+//		sz : data size(in byte)
+//	@note
+//		Add R1.0
+//		When a tunnel is filled, wait for its result and open the next tunnel if needed.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::tunnelWrite(const uint8_t* data, size_t sz)
+{
+	size_t	written = 0;
+//--
+	while (written < sz) {
+		if (_tunnelRemains == 0) {
+			if (_streamRemains == 0)
+				break;		// All data has been written
+			if (openTunnel())
+				return (-1);	// NG -- can't open next tunnel
+		}
+
+		size_t n = sz - written;
+		if (n > _tunnelRemains)
+			n = _tunnelRemains;
+		_serial.write(data + written, n);
+		written += n;
+		_tunnelRemains -= n;
+
+		if (_tunnelRemains == 0 && closeTunnel())
+			return (-1);	// NG -- tunnel was failed
+	}
+
+	return (int)written;	// OK
+}
+
+//***************************
+//	tunnelEnd
+//
+//	@description
+//		End to stream byte data through tunnel
+//	@return value
+//		-1 .. NG (Error, not all data has been written)
+//		 0 .. OK
+//	@param
+//		none
+//	@note
+//		Add R1.0
+//		Opened tunnel can't be canceled, so 3GIM/4GIM waits for the rest of data even if this returns NG.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::tunnelEnd(void)
+{
+	if (_streamRemains > 0 || _tunnelRemains > 0) {
+		gimDEBUG_PRINT(">tunnelEnd() remains", tunnelRemains());
+		_streamRemains = 0;
+		_tunnelRemains = 0;
+		return (-1);		// NG -- data is short
+	}
+
+	return gimSUCCESS;		// OK
+}
+
+//***************************
+//	read
+//
+//	@description
+//		Read data from current TCP/IP connection
+//	@return value
+//		-2  .. NG (Closed connection by other side)
+//		-1  .. NG (Error)
+//		 0  .. OK (No data)
+//		0 < .. OK (= read bytes)
+//	@param
+//		result : [OUT] read data(byte array, not '\0' terminated)
+//		resultlength : data length(in byte)
+//	@note
+//		R2.3 fix return value bug
+//		This function leaves for compatibility
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::read(char* result, int resultlength)
+{
+	int	length = sizeof(_workBuffer);
+//--
+	if (resultlength > gimMAX_DATA_LENGTH)
+		return -1;	// NG -- Bad parameter
+
+	// Make command and send it
+	sprintf(_workBuffer, "$TR %d", resultlength);
+	sendCommand(_workBuffer);
+
+	if (getResult(_workBuffer, &length, Limits::TIMEOUT_NETWORK))
+		return (-1);		// NG -- can't read
+
+	gimDEBUG_PRINT(">read()", _workBuffer);
+
+	// Parse response
+	if (! strncmp(_workBuffer, "$TR=NG", 6)) {
+		int errcode = atoi(_workBuffer + 7);
+		switch (errcode) {
+		  case 635 :		// Connection closed
+		  case 636 :
+			return (-2);
+		  default :			// Other error
+			return (-1);
+		}
+	}
+
+	int nbytes = atoi(_workBuffer + 7);
+	gimDEBUG_PRINT(">read() nbytes", nbytes);
+
+	// Copy response body into "result" within deadline --@change R1.0
+	int keep = (nbytes > resultlength - 1) ? resultlength - 1 : nbytes;
+	int n = (int)readBody((uint8_t *)result, keep, nbytes);
+	result[n] = '\0';
+	if (n == 0 && nbytes > 0)
+		return (-1);	// NG -- timeout
+
+	return n;		// OK (partial read if getMissingBytes() > 0)
+}
+
+//***************************
+//	read
+//
+//	@description
+//		Read (binary) data from current TCP/IP connection
+//	@return value
+//		-2  .. NG (Closed connection by other side)
+//		-1  .. NG (Error)
+//		 0  .. OK (No data)
+//		0 < .. OK (= read bytes)
+//	@param
+//		buffer : [OUT] read data(byte array, not '\0' terminated)
+//		sz     : binary data size(in byte)
+//	@note
+//		R2.3 Add this function
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::read(uint8_t* buffer, size_t sz)
+{
+	int	length = sizeof(_workBuffer);
+//--
+	if (sz > (size_t)gimMAX_DATA_LENGTH)
+		return -1;	// NG -- Bad parameter
+
+	// Make command and send it
+	sprintf(_workBuffer, "$TR %d", sz);
+	sendCommand(_workBuffer);
+
+	if (getResult(_workBuffer, &length, Limits::TIMEOUT_NETWORK))
+		return (-1);		// NG -- can't read
+
+	gimDEBUG_PRINT(">read()", _workBuffer);
+
+	// Parse response
+	if (! strncmp(_workBuffer, "$TR=NG", 6)) {
+		int errcode = atoi(_workBuffer + 7);
+		switch (errcode) {
+		  case 635 :		// Connection closed
+		  case 636 :
+			return (-2);
+		  default :			// Other error
+			return (-1);
+		}
+	}
+
+	size_t nbytes = atoi(_workBuffer + 7);
+	gimDEBUG_PRINT(">read() nbytes", nbytes);
+
+	// Copy response body into "buffer" within deadline --@change R1.0
+	size_t n = readBody(buffer, (nbytes < sz) ? nbytes : sz, nbytes);
+	if (n == 0 && nbytes > 0)
+		return (-1);	// NG -- timeout
+
+	return (int)n;		// OK (partial read if getMissingBytes() > 0)
+}
+
+//***************************
+//	read
+//
+//	@description
+//		Read byte from current TCP/IP connection
+//	@return value
+//		-2  .. NG (Closed connection by other side)
+//		-1  .. NG (Error)
+//		-3  .. OK (No data)
+//		 0..0xFF .. OK (= read byte)
+//	@param
+//		none
+//	@note
+//		This function is synchronized operation.
+//		Change return value type at @R2.0
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::read(void)
+{
+	int	length = sizeof(_workBuffer);
+	int	c;		//@R2.0 Change
+//--
+	// Send command
+	sendCommand("$TR 1");
+
+	if (getResult(_workBuffer, &length, Limits::TIMEOUT_NETWORK))
+		return (-1);	// NG -- can't read
+
+	gimDEBUG_PRINT(">read()", _workBuffer);
+
+	// Parse response
+	if (! strncmp(_workBuffer, "$TR=NG", 6)) {
+		int errcode = atoi(_workBuffer + 7);
+		switch (errcode) {
+		  case 635 :		// Connection closed
+		  case 636 :
+			return (-2);
+		  default :			// Other error
+			return (-1);
+		}
+	}
+
+	size_t nbytes = atoi(_workBuffer + 7);
+	gimDEBUG_PRINT(">read() nbytes", nbytes);
+
+	if (nbytes == 1) {
+		uint8_t	b;
+		if (readBody(&b, 1, 1) != 1)		//@change R1.0
+			return (-1);	// NG -- timeout
+		c = b;
+	}
+	else {	// if (nbytes == 0)
+		readBody(NULL, 0, nbytes);		//@change R1.0
+		c = -3;		// NG -- no data
+	}
+
+	return c;	// OK
+}
+
+//***************************
+//	enterAT
+//
+//	@description
+//		Enter AT command pass-throuh mode only specified time
+//	@return value
+//		0  .. OK
+//		1  .. NG (Parameter error)
+//	@param
+//		duration : The time that You can take advantage of [x100 mS]
+//	@note
+//		AT commands and responses are comminicated via _serial directly.
+//		Add @R4.0
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::enterAT(uint32_t duration)
+{
+	int	length = sizeof(_workBuffer);
+//--
+	if (duration == 0)
+		strcpy(_workBuffer, "$YA");
+	else
+		sprintf(_workBuffer, "$YA %u", (uint16_t)duration);
+	sendCommand(_workBuffer);		// Send "Enter AT command" command
+
+	if (getResult(_workBuffer, &length, Limits::TIMEOUT_LOCAL))
+		return 1;	// NG -- maybe timeout
+
+	delay(10);
+
+	gimDEBUG_PRINT(">AT PASS THROUGH", duration);
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	getResult
+//
+//	@description
+//		Get response from 3GIM(V2)
+//	@return value
+//		0  .. OK
+//		1  .. NG (timeout)
+//	@param
+//		buf : buffer to store result
+//		len : [IN/OUT] buffer size and response length(in bytes)
+//		timeout : [mS]
+//	@note
+//		Add @R4.0(moved from private to public)
+//		Status lines received while waiting are kept, see readStatus() --@add R1.0
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::getResult(char *buf, int *len, uint32_t timeout)
+{
+	gimDEBUGP("getResult()");
+	uint32_t ts = millis();
+	while (pollResult(buf, len) != 0) {		//@change R1.0
+		if (millis() - ts >= timeout) {
+			gimDEBUG_PRINT(">getResult()", "TIMEOUT");
+			return 1;		// NG -- Timeout
+		}
+	}
+
+	gimDEBUG_PRINT("<getResult", buf);
+
+	return 0;	// OK
+}
+
+//***************************
+//	pollResult
+//
+//	@description
+//		Get response from 3GIM(V2) if it has been received (non-blocking)
+//	@return value
+//		0  .. OK (got result)
+//		1  .. not yet
+//	@param
+//		buf : buffer to store result
+//		len : [IN/OUT] buffer size and response length(in bytes), changed only when OK
+//	@note
+//		Add @R1.0
+//		Lines are framed from the ring buffer. Line started with '$' is a result,
+//		otherwise it is a status line and kept for readStatus().
+//		Bytes after the result line(ex. response body) are left in the ring buffer.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::pollResult(char *buf, int *len)
+{
+	int c;
+	while ((c = readRx()) >= 0) {
+		if (c != 0x0a) {
+			if (_lineLength < Limits::LINE_BUFFER_SIZE - 1)
+				_lineBuffer[_lineLength++] = c;
+			continue;
+		}
+
+		// End of line
+		_lineBuffer[_lineLength] = '\0';
+		int length = _lineLength;
+		_lineLength = 0;
+		if (_lineBuffer[0] == '$') {	// got result
+			if (length > *len - 1)
+				length = *len - 1;
+			memcpy(buf, _lineBuffer, length);
+			buf[length] = '\0';
+			*len = length;
+			return 0;	// OK
+		}
+		if (length == 0 || (length == 1 && _lineBuffer[0] == '\r'))
+			continue;	// empty line
+
+		// Got status, so keep it(overwrite the oldest one if full)
+		gimDEBUG_PRINT(">pollResult() status", _lineBuffer);
+		_statusLines.push(_lineBuffer);		//@change R1.6
+	}
+
+	return 1;	// not yet
+}
+
+//***************************
+//	availableStatus
+//
+//	@description
+//		Get number of status lines received from 3GIM(V2)
+//	@return value
+//		number of status lines (0 .. Limits::MAX_STATUS_LINES)
+//	@param
+//		none
+//	@note
+//		Add @R1.0
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::availableStatus(void)
+{
+	return _statusLines.available();		//@change R1.6
+}
+
+//***************************
+//	readStatus
+//
+//	@description
+//		Read the oldest status line received from 3GIM(V2)
+//	@return value
+//		>= 0 .. length of status line(0 means no status line)
+//	@param
+//		buf : buffer to store status line(without '\n')
+//		len : buffer size (Limits::MAX_STATUS_LENGTH + 1 is enough)
+//	@note
+//		Add @R1.0
+//		Status lines are framed only while waiting for a result, call pollResult() to fetch new ones.
+//		If Limits::MAX_STATUS_LINES is 0, status lines are discarded and this always returns 0.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::readStatus(char *buf, int len)
+{
+	return _statusLines.read(buf, len);		//@change R1.6
+}
+
+//***************************
+//	startLocation
+//
+//	@description
+//		Start to locate current position from GPS and Network, and return at once
+//
+//	@return value
+//		0 .. OK(started)
+//		1 .. NG(Bad parameters or already started)
+//	@param
+//		method .. method of locate(gimMP*)
+//	@note
+//		Add this function from R1.4(moved from a3gim/a3gim2)
+//		Call pollLocation() until it returns other than 1, then get the position by getLastLocation().
+//		Don't call other functions which send command to 3GIM until then.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::startLocation(int method)
+{
+	if (_locating != 0)
+		return 1;	// NG -- already started
+
+	// Make command and send it
+	switch (method) {
+		case gimMPBASED :
+			sendCommand("$LG MSBASED");  // Default is method=MSBASED
+			break;
+		case gimMPASSISTED :
+			sendCommand("$LG MSASSISTED");
+			break;
+		case gimMPSTANDALONE :
+			sendCommand("$LG STANDALONE");
+			break;
+		default :
+			return 1;  // bad method
+	}
+
+	_locating = 1;
+	_locationStarted = millis();
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	startLocation2
+//
+//	@description
+//		Start to locate current position(same as getLocation2()), and return at once
+//
+//	@return value
+//		0 .. OK(started)
+//		1 .. NG(already started)
+//	@param
+//		none
+//	@note
+//		Add this function from R1.4(moved from a3gim/a3gim2)
+//		Call pollLocation() until it returns other than 1, then get the position by getLastLocation2().
+//		Don't call other functions which send command to 3GIM until then.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::startLocation2(void)
+{
+	if (_locating != 0)
+		return 1;	// NG -- already started
+
+	sendCommand("$LG - 1");
+
+	_locating = 2;
+	_locationStarted = millis();
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	pollLocation
+//
+//	@description
+//		Check the result of positioning started by startLocation() or startLocation2()
+//
+//	@return value
+//		0 .. OK(located, the position is kept as the last fix)
+//		1 .. not yet
+//		2 .. NG(Can't locate, timeout or not started)
+//	@param
+//		none
+//	@note
+//		Add this function from R1.4(moved from a3gim/a3gim2)
+//		Non-blocking, parse $LG result from received bytes if it has arrived.
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::pollLocation(void)
+{
+	int	length = sizeof(_workBuffer);
+//--
+	if (_locating == 0)
+		return 2;	// NG -- not started
+
+	if (pollResult(_workBuffer, &length) != 0) {
+		if (millis() - _locationStarted < Limits::TIMEOUT_GPS)
+			return 1;	// not yet
+		gimDEBUG_PRINT(">pollLocation()", "TIMEOUT");
+		_locating = 0;
+		return 2;	// NG -- timeout
+	}
+
+	gimDEBUG_PRINT(">pollLocation()", _workBuffer);
+
+	boolean full = (_locating == 2);
+	_locating = 0;
+
+	// Keep the fix in the cache, or leave it in _workBuffer to be parsed by getLastLocation() --@change R1.6
+	if (Limits::LOCATION_CACHE ? parseLocation(_workBuffer, full, _fix.latitude(), _fix.longitude(), _fix.height(), _fix.utc(), _fix.quality(), _fix.number())
+								: strncmp(_workBuffer, "$LG=OK", 6) != 0)
+		return 2;	// NG --  Can't locate
+
+	_fixType = full ? 2 : 1;
+	_fixMillis = millis();
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	getLastLocation
+//
+//	@description
+//		Get the last fix(located by getLocation(), getLocation2() or pollLocation())
+//
+//	@return value
+//		0 .. OK
+//		1 .. NG(No fix yet)
+//	@param
+//		latitude .. [OUT] latitude(gimLOCATION_SIZE bytes)
+//		longitude .. [OUT] longitude(gimLOCATION_SIZE bytes)
+//		age .. [OUT] elapsed time since the fix [mS](NULL if not needed)
+//	@note
+//		Add this function from R1.4(moved from a3gim/a3gim2)
+//		Return at once without communication, check "age" to decide whether to locate again.
+//		If Limits::LOCATION_CACHE is false, the fix is parsed from the work buffer,
+//		so it is lost when the next command is sent(get it just after pollLocation()).
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::getLastLocation(char* latitude, char* longitude, uint32_t* age)
+{
+	if (_fixType == 0)
+		return 1;	// NG -- no fix yet
+
+	if (Limits::LOCATION_CACHE) {		//@change R1.6
+		strcpy(latitude, _fix.latitude());
+		strcpy(longitude, _fix.longitude());
+	}
+	else
+		parseLocation(_workBuffer, false, latitude, longitude, NULL, NULL, NULL, NULL);
+	if (age != NULL)
+		*age = millis() - _fixMillis;
+
+	return gimSUCCESS;	// OK
+}
+
+//***************************
+//	getLastLocation2
+//
+//	@description
+//		Get the last fix located by getLocation2() or startLocation2()
+//
+//	@return value
+//		0 .. OK
+//		1 .. NG(No fix by getLocation2() or startLocation2() is the last)
+//	@param
+//		latitude .. [OUT] latitude(gimLOCATION_SIZE bytes)
+//		longitude .. [OUT] longitude(gimLOCATION_SIZE bytes)
+//		height .. [OUT] (gimLOCATION_SIZE bytes)
+//		utc .. [OUT] (gimLOCATION_SIZE bytes)
+//		quality .. [OUT]
+//		number .. [OUT]
+//		age .. [OUT] elapsed time since the fix [mS](NULL if not needed)
+//	@note
+//		Add this function from R1.4(moved from a3gim/a3gim2)
+//***************************
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::getLastLocation2(char* latitude, char* longitude, char *height, char *utc, int *quality, int *number, uint32_t* age)
+{
+	if (_fixType != 2)
+		return 1;	// NG -- no fix by "$LG - 1"
+
+	if (! Limits::LOCATION_CACHE) {		//@change R1.6
+		parseLocation(_workBuffer, true, latitude, longitude, height, utc, quality, number);
+		if (age != NULL)
+			*age = millis() - _fixMillis;
+		return gimSUCCESS;	// OK
+	}
+	getLastLocation(latitude, longitude, age);
+	strcpy(height, _fix.height());
+	strcpy(utc, _fix.utc());
+	*quality = *_fix.quality();
+	*number = *_fix.number();
+
+	return gimSUCCESS;	// OK
+}
+
+//***
+//  Protected methods
+//***
+
+//  sendCommand() -- send command to iem with \n
+template <class SerialT, class Limits>
+void GIMCore<SerialT, Limits>::sendCommand(const char* cmd)
+{
+	// Send command to IEM with '\n'
+	if (! Limits::LOCATION_CACHE)
+		_fixType = 0;		// The fix in _workBuffer will be overwritten --@add R1.6
+	Limits::listen(_serial);
+	_serial.println(cmd);
+	gimDEBUG_PRINT("<sendCommand()", cmd);
+}
+
+//  sendData() -- send data to iem without \n
+template <class SerialT, class Limits>
+void GIMCore<SerialT, Limits>::sendData(const char* data)
+{
+	// Send data to IEM without '\n'
+	Limits::listen(_serial);
+	_serial.print(data);
+	gimDEBUG_PRINT("<sendData()", data);
+}
+
+// discardUntl() -- discard characters from _serial until match specified character
+template <class SerialT, class Limits>
+void GIMCore<SerialT, Limits>::discardUntil(const char match)
+{
+	int	c;		//@R2.0 Change
+	uint32_t ts = millis();
+	boolean	done = false;
+//--
+	while (! done) {
+		if (millis() - ts >= Limits::TIMEOUT_LOCAL) {
+			gimDEBUG_PRINT(">discardUntil()", "TIMEOUT");
+			break;		// Timeout !
+		}
+
+		if ((c = readRx()) < 0)		//@change R1.0
+			continue;	// discard until valid response -- @R2.1 Change
+
+		if (c == match)
+			done = true;
+	}
+}
+
+// writeEscaped() -- escape data into staging block and write each block at once --@add R1.0
+//	Escape sequence: control character -> "$xhh", '"' -> "$\"", '$' -> "$$"
+//	Escaped data is at most 4 times of "sz". Where the escaped size is limited(ex. MAX_BODY_LENGTH),
+//	callers measure it by escapedSize() before sending the command.
+template <class SerialT, class Limits>
+size_t GIMCore<SerialT, Limits>::writeEscaped(const uint8_t* data, size_t sz)
+{
+	uint8_t	block[Limits::ESCAPE_BLOCK_SIZE];
+	size_t	n = 0, total = 0;
+//--
+	while (sz-- > 0) {
+		uint8_t c = *data++;
+		uint8_t len = (c < sizeof(_escapedLength)) ? _escapedLength[c] : 1;
+		if (n + len > sizeof(block)) {
+			_serial.write(block, n);
+			total += n;
+			n = 0;
+		}
+		if (len == 1)
+			block[n++] = c;
+		else if (len == 2) {
+			block[n++] = '$';
+			block[n++] = c;
+		}
+		else {
+			block[n++] = '$';
+			block[n++] = 'x';
+			block[n++] = _hexDigits[c >> 4];
+			block[n++] = _hexDigits[c & 0x0f];
+		}
+	}
+	if (n > 0) {
+		_serial.write(block, n);
+		total += n;
+	}
+	return total;
+}
+
+// escapedSize() -- count escaped bytes of "data" by the same table as writeEscaped() --@add R1.5
+//	Counting stops as soon as it exceeds "limit", so the result is "limit" + 1..4 for large data.
+template <class SerialT, class Limits>
+size_t GIMCore<SerialT, Limits>::escapedSize(const uint8_t* data, size_t sz, size_t limit)
+{
+	size_t	escaped = 0;
+//--
+	for (size_t i = 0; i < sz && escaped <= limit; i++)
+		escaped += (data[i] < sizeof(_escapedLength)) ? _escapedLength[data[i]] : 1;
+
+	return escaped;
+}
+
+// openTunnel() -- open next tunnel for rest of stream --@add R1.0
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::openTunnel(void)
+{
+	size_t n = (_streamRemains > gimMAX_TUNNEL_DATA_LENGTH) ? gimMAX_TUNNEL_DATA_LENGTH : (size_t)_streamRemains;
+	if (writeBegin(n)) {
+		_streamRemains = 0;
+		return (-1);	// NG -- can't open tunnel
+	}
+	_streamRemains -= n;
+	_tunnelRemains = n;
+
+	return 0;	// OK
+}
+
+// closeTunnel() -- wait for result of filled tunnel --@add R1.0
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::closeTunnel(void)
+{
+	int	length = sizeof(_workBuffer);
+//--
+	_serial.flush();		// Wait until all data is sent
+	if (getResult(_workBuffer, &length, Limits::TIMEOUT_NETWORK) || ! strncmp(_workBuffer, "$TT=NG", 6)) {
+		gimDEBUG_PRINT(">closeTunnel() NG", _workBuffer);
+		_streamRemains = 0;
+		return (-1);	// NG -- timeout or error
+	}
+
+	return 0;	// OK
+}
+
+// readBody() -- read body of $TR response within deadline and discard last '\n' --@add R1.0
+//	First "keep" bytes are stored into "buffer" and the rest of "nbytes" are discarded.
+//	Return value is number of stored bytes, and getMissingBytes() shows bytes not received.
+template <class SerialT, class Limits>
+size_t GIMCore<SerialT, Limits>::readBody(uint8_t* buffer, size_t keep, size_t nbytes)
+{
+	uint32_t	ts = millis();
+	size_t		n = 0;
+	unsigned long	timeout = _serial.getTimeout();		// restored after reading
+//--
+	// Data in the ring buffer first
+	while (n < keep && _rxTail != _rxHead) {
+		buffer[n++] = _rxBuffer[_rxTail];
+		_rxTail = (_rxTail + 1) & (Limits::RX_BUFFER_SIZE - 1);
+	}
+	// The rest directly from _serial
+	while (n < keep) {
+		uint32_t elapsed = millis() - ts;
+		if (elapsed >= Limits::TIMEOUT_LOCAL)
+			break;	// Timeout
+		_serial.setTimeout(Limits::TIMEOUT_LOCAL - elapsed);
+		n += _serial.readBytes(buffer + n, keep - n);
+	}
+	_serial.setTimeout(timeout);
+
+	size_t received = n;
+	if (n == keep) {
+		while (received < nbytes && millis() - ts < Limits::TIMEOUT_LOCAL) {
+			if (readRx() >= 0)
+				received++;
+		}
+	}
+
+	_missingBytes = nbytes - received;
+	if (_missingBytes == 0) {
+		discardUntil('\n');	// discard last '\n'
+	}
+	else {
+		gimDEBUG_PRINT(">readBody() TIMEOUT, missing", _missingBytes);
+	}
+
+	return n;
+}
+
+// discardInput() -- discard received data except status lines --@add R1.0
+template <class SerialT, class Limits>
+void GIMCore<SerialT, Limits>::discardInput(void)
+{
+	char	result[2];
+	int		length;
+//--
+	do {
+		length = sizeof(result);
+	} while (pollResult(result, &length) == 0);		// discard stale results
+	_lineLength = 0;	// discard incomplete line
+}
+
+// fillRxBuffer() -- move received characters from _serial into the ring buffer --@add R1.0
+template <class SerialT, class Limits>
+void GIMCore<SerialT, Limits>::fillRxBuffer(void)
+{
+	while (_serial.available() > 0) {
+		uint16_t next = (_rxHead + 1) & (Limits::RX_BUFFER_SIZE - 1);
+		if (next == _rxTail)
+			break;		// full, so leave the rest in _serial
+		_rxBuffer[_rxHead] = (uint8_t)_serial.read();
+		_rxHead = next;
+	}
+}
+
+// readRx() -- read a character from the ring buffer(-1 if none) --@add R1.0
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::readRx(void)
+{
+	if (_rxTail == _rxHead)
+		fillRxBuffer();
+	if (_rxTail == _rxHead)
+		return (-1);	// no data
+
+	int c = _rxBuffer[_rxTail];
+	_rxTail = (_rxTail + 1) & (Limits::RX_BUFFER_SIZE - 1);
+	return c;
+}
+	
+
+// requestGET() -- send $WG command and get size of response body(-1 if NG) --@add R1.1
+template <class SerialT, class Limits>
+long GIMCore<SerialT, Limits>::requestGET(const char* server, uint16_t port, const char* path, boolean ssled, const char* header)
+{
+	int	length = sizeof(_workBuffer);
+//--
+	// Discard gerbage in input buffer before the command
+	discardInput();
+
+	// Send command line little by little
+	if (ssled) {
+		if (strlen(server) + strlen(path) + 8 > Limits::MAX_URL_LENGTH)
+			return (-1);  // NG -- Too long url
+
+		sendData("$WG https://");
+		sendData(server);
+		if (port != gimDEFAULT_PORT) {
+			char ports[6];
+			sendData(":");
+			sprintf(ports, "%u", port);
+			sendData(ports);
+		}
+	}
+	else {
+		if (strlen(server) + strlen(path) + 7 > Limits::MAX_URL_LENGTH)
+			return (-1);  // NG -- Too long url
+
+		sendData("$WG http://");
+		sendData(server);
+		if (port != gimDEFAULT_PORT) {
+			char ports[6];
+			sendData(":");
+			sprintf(ports, "%u", port);
+			sendData(ports);
+		}
+	}
+
+	sendData(path);	
+
+	// Request with extra header --@R3.0 add
+	if (header != NULL) {
+		sendData(" \"");
+		sendData(header);
+		sendData("\"");
+	}
+	
+	sendCommand("");	// Go HTTP/GET request
+
+	gimDEBUG_PRINT(">httpGET()", "REQ");
+
+	if (getResult(_workBuffer, &length, Limits::TIMEOUT_NETWORK))
+		return (-1);	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">httpGET()", _workBuffer);
+		// result's format: $WG=OK nbytes "response"
+
+	// Parse response
+	if (strncmp(_workBuffer, "$WG=OK", 6))
+		return (-1);	// NG -- Can't get response
+
+	long nbytes = atol(_workBuffer + 7);
+	gimDEBUG_PRINT(">httpGET() nbytes", nbytes);
+
+	return nbytes;
+}
+
+// requestPOST() -- send $WP command and get size of response body(-1 if NG) --@add R1.1
+//	Body is "body"(nul terminated, sent as is) or "sz" bytes from "data"/"src"(escaped on the fly) --@change R1.2
+template <class SerialT, class Limits>
+long GIMCore<SerialT, Limits>::requestPOST(const char* server, uint16_t port, const char* path, const char* header, const char* body, const uint8_t* data, Stream* src, size_t sz, boolean ssled)
+{
+	int	length = sizeof(_workBuffer);
+	boolean	shortBody = false;
+//--
+	if (body != NULL && strlen(body) > Limits::MAX_BODY_LENGTH)
+		return (-1);	// NG -- too long body(binary body is checked by postBinary())
+	if (header != NULL && strlen(header) > Limits::MAX_HEADER_LENGTH)
+		return (-1);	// NG -- too long header
+
+	// Discard gerbage in input buffer before the command
+	discardInput();
+
+	// Send command line little by little
+	if (ssled) {
+		if (strlen(server) + strlen(path) + 8 > Limits::MAX_URL_LENGTH)
+			return (-1);  // NG -- Too long url
+
+		sendData("$WP https://");
+		sendData(server);
+		if (port != gimDEFAULT_PORT) {
+			char ports[6];
+			sendData(":");
+			sprintf(ports, "%u", port);
+			sendData(ports);
+		}
+	}
+	else {
+		if (strlen(server) + strlen(path) + 7 > Limits::MAX_URL_LENGTH)
+			return (-1);  // NG -- Too long url
+
+		sendData("$WP http://");
+		sendData(server);
+		if (port != gimDEFAULT_PORT) {
+			char ports[6];
+			sendData(":");
+			sprintf(ports, "%u", port);
+			sendData(ports);
+		}
+	}
+
+	if (path[0] != '/')
+		sendData("/");		// for compatiblity old version
+	sendData(path);
+
+	sendData(" \"");
+
+	if (body != NULL)
+		sendData(body);
+	else
+		shortBody = (sendBody(data, src, sz, true) != sz);		//@add R1.2
+
+	if (header != NULL && *header != '\0') {
+		sendData("\" \"");
+		sendData(header);
+	}
+
+	sendCommand("\"");	// Go command
+
+	gimDEBUG_PRINT(">httpPOST()", "REQ");
+
+	if (getResult(_workBuffer, &length, Limits::TIMEOUT_NETWORK))
+		return (-1);	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">httpPOST()", _workBuffer);
+		// result's format: $WP=OK nbytes or $WP=NG errno
+
+	// Parse response
+	if (strncmp(_workBuffer, "$WP=OK", 6))
+		return (-1);	// NG -- Can't post or get response
+
+	long nbytes = atol(_workBuffer + 7);
+	gimDEBUG_PRINT(">httpPOST() nbytes", nbytes);
+
+	if (shortBody) {	//@add R1.2
+		// Posted body was padded(sendBody()), so discard the response and fail
+		GIMBufferPrint	none(NULL, 0);
+		readHttpBody(nbytes, none);
+		return (-1);
+	}
+
+	return nbytes;
+}
+
+// readHttpBody() -- read response body by block and write it into "out", then discard last '\n' --@add R1.1
+//	Timeout(TIMEOUT_NETWORK) is counted from the last received block, not from the beginning of the body.
+//	The timeout of the serial port is restored to the caller's value before return.
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::readHttpBody(long nbytes, Print& out)
+{
+	uint8_t		block[Limits::HTTP_BLOCK_SIZE];
+	uint32_t	ts = millis();
+	unsigned long	timeout = _serial.getTimeout();		// restored before return
+//--
+	while (nbytes > 0) {
+		size_t want = (nbytes < (long)sizeof(block)) ? (size_t)nbytes : sizeof(block);
+		size_t n = 0;
+		// Data in the ring buffer first
+		while (n < want && _rxTail != _rxHead) {
+			block[n++] = _rxBuffer[_rxTail];
+			_rxTail = (_rxTail + 1) & (Limits::RX_BUFFER_SIZE - 1);
+		}
+		// The rest directly from the serial port
+		if (n < want) {
+			uint32_t elapsed = millis() - ts;
+			if (elapsed >= Limits::TIMEOUT_NETWORK) {
+				gimDEBUG_PRINT(">readHttpBody() TIMEOUT, remains", nbytes);
+				_serial.setTimeout(timeout);
+				return 2;	// NG -- Timeout
+			}
+			_serial.setTimeout(Limits::TIMEOUT_NETWORK - elapsed);
+			n += _serial.readBytes(block + n, want - n);
+		}
+		if (n > 0) {
+			out.write(block, n);
+			nbytes -= n;
+			ts = millis();
+		}
+	}
+	_serial.setTimeout(timeout);
+	discardUntil('\n');	// discard last '\n'
+
+	return 0;	// OK
+}
+
+// postBinary() -- post "sz" bytes from "data"/"src" by $WP or TCP tunnel, and write response body into "out" --@add R1.2
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::postBinary(const char* server, uint16_t port, const char* path, const char* header, const uint8_t* data, Stream* src, size_t sz, Print& out, boolean ssled)
+{
+	// MAX_BODY_LENGTH limits escaped body, "src" can't be measured in advance so assume the worst
+	size_t escaped = (src != NULL) ? sz * 4 : escapedSize(data, sz, Limits::MAX_BODY_LENGTH);		//@change R1.5
+
+	if (escaped <= Limits::MAX_BODY_LENGTH) {
+		long nbytes = requestPOST(server, port, path, header, NULL, data, src, sz, ssled);
+		if (nbytes < 0)
+			return 1;	// NG -- Can't post or get response
+		return readHttpBody(nbytes, out);
+	}
+
+	if (ssled)
+		return 1;	// NG -- $WP can't carry such a body, and TCP tunnel doesn't support https
+
+	return postTunnel(server, port, path, header, data, src, sz, out);
+}
+
+// postTunnel() -- post as HTTP/1.0 through TCP tunnel and write response body into "out" --@add R1.2
+//	The connection is closed by the server at the end of response(HTTP/1.0), which is the end of body.
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::postTunnel(const char* server, uint16_t port, const char* path, const char* header, const uint8_t* data, Stream* src, size_t sz, Print& out)
+{
+	const char*	format = "POST %s%s HTTP/1.0\r\nHost: %s\r\nContent-Length: %lu\r\n";
+	const char*	slash = (path[0] != '/') ? "/" : "";
+	size_t	headerLength = (header != NULL) ? strlen(header) : 0;
+	size_t	crlfLength = (headerLength > 0 && (headerLength < 2 || strcmp(header + headerLength - 2, "\r\n") != 0)) ? 2 : 0;	// terminate "header"
+	uint8_t		block[Limits::HTTP_BLOCK_SIZE];
+	uint8_t		matched = 0;	// Number of matched characters of "\r\n\r\n"(end of headers)
+	uint32_t	ts;
+	int rc = 1;
+//--
+	if (headerLength > Limits::MAX_HEADER_LENGTH)
+		return 1;	// NG -- too long header
+
+	// Request line and fixed headers are made in _workBuffer, so measure them first
+	int n = snprintf(_workBuffer, sizeof(_workBuffer), format, slash, path, server, (unsigned long)sz);
+	if (n < 0 || n >= (int)sizeof(_workBuffer))
+		return 1;	// NG -- too long path or server
+	size_t lineLength = (size_t)n;
+	uint32_t total = lineLength + headerLength + crlfLength + 2 + sz;
+
+	if (connectTCP(server, (port == gimDEFAULT_PORT) ? 80 : port))
+		return 1;	// NG -- Can't connect
+
+	// Send request (tunnelBegin() uses _workBuffer, so make the request line again after it)
+	if (tunnelBegin(total) == 0) {
+		snprintf(_workBuffer, sizeof(_workBuffer), format, slash, path, server, (unsigned long)sz);
+		if (tunnelWrite((const uint8_t*)_workBuffer, lineLength) == (int)lineLength
+		 && tunnelWrite((const uint8_t*)header, headerLength) == (int)headerLength
+		 && tunnelWrite((const uint8_t*)"\r\n\r\n", crlfLength + 2) == (int)(crlfLength + 2)
+		 && sendBody(data, src, sz, false) == sz)
+			rc = 0;
+		if (tunnelEnd() != 0)
+			rc = 1;
+	}
+	if (rc != 0) {
+		disconnectTCP();
+		return 1;	// NG -- Can't post
+	}
+
+	// Receive response, skip headers and write body into "out" until the connection is closed
+	ts = millis();
+	for (;;) {
+		n = read(block, sizeof(block));
+		if (n == -2)
+			break;		// Closed -- end of response
+		if (n < 0) {
+			rc = 1;		// NG -- Can't receive
+			break;
+		}
+		if (n == 0) {
+			if (millis() - ts >= Limits::TIMEOUT_NETWORK) {
+				rc = 2;		// NG -- Timeout
+				break;
+			}
+			continue;
+		}
+		ts = millis();
+		int i = 0;
+		while (matched < 4 && i < n) {
+			uint8_t c = block[i++];
+			matched = (c == "\r\n\r\n"[matched]) ? matched + 1 : ((c == '\r') ? 1 : 0);
+		}
+		if (i < n)
+			out.write(block + i, n - i);
+	}
+	disconnectTCP();
+
+	if (rc == 0 && matched < 4)
+		rc = 1;		// NG -- Broken response
+
+	return rc;
+}
+
+// sendBody() -- send "sz" bytes from "data"(or "src" if not NULL) escaped into command, or raw into TCP tunnel, and return sent bytes --@add R1.2
+//	If "src" runs short, the rest is padded with 0x00 so that $WP command or the tunnel gets "sz" bytes as declared,
+//	but only the bytes read from "src" are counted in the return value(callers treat it as NG).
+template <class SerialT, class Limits>
+size_t GIMCore<SerialT, Limits>::sendBody(const uint8_t* data, Stream* src, size_t sz, boolean escape)
+{
+	uint8_t	block[Limits::HTTP_BLOCK_SIZE];
+	size_t	sent = 0;
+	boolean	ranShort = false;
+//--
+	while (sent < sz) {
+		size_t n = sz - sent;
+		const uint8_t* p = data + sent;
+		if (src != NULL) {
+			if (n > sizeof(block))
+				n = sizeof(block);
+			n = src->readBytes(block, n);
+			if (n == 0) {
+				ranShort = true;
+				break;		// "src" ran short(timeout)
+			}
+			p = block;
+		}
+		else if (n > gimMAX_DATA_LENGTH)
+			n = gimMAX_DATA_LENGTH;		// keep tunnelWrite()'s return value in int
+		if (escape)
+			writeEscaped(p, n);
+		else if (tunnelWrite(p, n) != (int)n)
+			break;		// Can't write into tunnel
+		sent += n;
+	}
+
+	if (ranShort) {
+		// Opened tunnel(and $WP command line) can't be canceled, so complete it by padding
+		gimDEBUG_PRINT(">sendBody() short, padded", sz - sent);
+		memset(block, 0, sizeof(block));
+		for (size_t padded = sent; padded < sz; ) {
+			size_t n = (sz - padded < sizeof(block)) ? sz - padded : sizeof(block);
+			if (escape)
+				writeEscaped(block, n);
+			else if (tunnelWrite(block, n) != (int)n)
+				break;		// Can't write into tunnel
+			padded += n;
+		}
+	}
+
+	return sent;
+}
+
+// requestTime() -- send $YT command and get current time as seconds since Jan 1 1970(JST) --@add R1.3
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::requestTime(uint32_t& seconds)
+{
+	char	responses[28];  // Format "$YT=OK 2012/03/18 13:28:25"
+	int	length = sizeof(responses);
+//--
+	sendCommand("$YT");		// Send "Get Time" command
+
+	if (getResult(responses, &length, Limits::TIMEOUT_NETWORK))
+		return 1;	// NG -- maybe timeout
+
+	gimDEBUG_PRINT(">requestTime()", responses);
+
+	if (strncmp(responses, "$YT=OK", 6) || length < 26)
+		return 1;	// NG -- Can't get time
+
+	seconds = toSeconds(atoi(responses + 7), atoi(responses + 12), atoi(responses + 15),
+		atoi(responses + 18), atoi(responses + 21), atoi(responses + 24));
+
+	return 0;	// OK
+}
+
+// countClock() -- count seconds since Jan 1 1970(JST) from the last sync by millis() corrected with drift --@add R1.3
+template <class SerialT, class Limits>
+uint32_t GIMCore<SerialT, Limits>::countClock(void)
+{
+	uint32_t elapsed = millis() - _clockMillis;
+	elapsed += (int32_t)((int64_t)elapsed * _clockDrift / 1000000L);
+
+	return _clockBase + elapsed / 1000UL;
+}
+
+// nextToken() -- copy the token at "cp" into "dst"(until space or "stop", at most size-1 bytes), and return position after it --@add R1.4
+template <class SerialT, class Limits>
+const char* GIMCore<SerialT, Limits>::nextToken(const char* cp, char* dst, int size, char stop)
+{
+	int	n = 0;
+//--
+	while (*cp == ' ')
+		cp++;		// skip spaces
+	while (*cp != '\0' && *cp != ' ' && *cp != stop) {
+		if (n < size - 1)
+			dst[n++] = *cp;
+		cp++;
+	}
+	dst[n] = '\0';
+	while (*cp != '\0' && *cp != ' ')
+		cp++;		// skip rest of the token(ex. ".mmm" of utc)
+
+	return cp;
+}
+
+// parseLocation() -- parse $LG result into "latitude".."number"(gimLOCATION_SIZE bytes each) --@add R1.4 @change R1.6
+//	Format: "$LG=OK lat lng"(full is false) or "$LG=OK lat lng utc.mmm quality number height"(full is true)
+template <class SerialT, class Limits>
+int GIMCore<SerialT, Limits>::parseLocation(const char* res, boolean full, char* latitude, char* longitude, char* height, char* utc, int* quality, int* number)
+{
+	char	field[8];
+	const char	*cp;
+//--
+	if (strncmp(res, "$LG=OK", 6))
+		return 1;	// NG --  Can't locate
+
+	cp = nextToken(res + 6, latitude, gimLOCATION_SIZE, ' ');
+	cp = nextToken(cp, longitude, gimLOCATION_SIZE, ' ');
+	if (full) {
+		cp = nextToken(cp, utc, gimLOCATION_SIZE, '.');
+		cp = nextToken(cp, field, sizeof(field), ' ');
+		*quality = atoi(field);
+		cp = nextToken(cp, field, sizeof(field), ' ');
+		*number = atoi(field);
+		nextToken(cp, height, gimLOCATION_SIZE, ' ');
+	}
+	gimDEBUG_PRINT(">parseLocation() lat", latitude);
+	gimDEBUG_PRINT(">parseLocation() lng", longitude);
+
+	return gimSUCCESS;	// OK
+}
+
+#endif // _GIMCORE_H_
@@ -0,0 +1,83 @@
+/*
+ *  Arduino.h -- minimal Arduino API to build gimcore.h on a host(for test and benchmark only)
+ */
+
+#ifndef _STUB_ARDUINO_H_
+#define _STUB_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <chrono>
+
+typedef bool boolean;
+
+#define HIGH	1
+#define LOW		0
+#define INPUT	0
+#define OUTPUT	1
+#define DEC		10
+#define HEX		16
+
+inline uint32_t millis(void) {
+	return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+inline void delay(uint32_t ms) { uint32_t ts = millis(); while (millis() - ts < ms) ; }
+inline void pinMode(int, int) { }
+inline void digitalWrite(int, int) { }
+
+class Print
+{
+  public:
+	virtual ~Print() { }
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t* buffer, size_t size) {
+		size_t n = 0;
+		while (size-- > 0)
+			n += write(*buffer++);
+		return n;
+	}
+	size_t write(const char* str) { return (str == NULL) ? 0 : write((const uint8_t*)str, strlen(str)); }
+	size_t print(const char* str) { return write(str); }
+	size_t print(char c) { return write((uint8_t)c); }
+	size_t print(long n) { char s[12]; snprintf(s, sizeof(s), "%ld", n); return write(s); }
+	size_t println(const char* str) { return print(str) + print("\r\n"); }
+	size_t println(long n) { return print(n) + print("\r\n"); }
+	virtual void flush(void) { }
+	int getWriteError(void) { return _writeError; }
+	void clearWriteError(void) { _writeError = 0; }
+  protected:
+	void setWriteError(int err = 1) { _writeError = err; }
+  private:
+	int _writeError = 0;
+};
+
+class Stream : public Print
+{
+  public:
+	virtual int available(void) = 0;
+	virtual int read(void) = 0;
+	virtual int peek(void) = 0;
+	void setTimeout(unsigned long timeout) { _timeout = timeout; }
+	unsigned long getTimeout(void) { return _timeout; }
+	size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+	size_t readBytes(char* buffer, size_t length) {
+		size_t n = 0;
+		for (int c; n < length && (c = read()) >= 0; )
+			buffer[n++] = (char)c;
+		return n;
+	}
+	size_t readBytesUntil(char terminator, char* buffer, size_t length) {
+		size_t n = 0;
+		for (int c; n < length && (c = read()) >= 0 && c != terminator; )
+			buffer[n++] = (char)c;
+		return n;
+	}
+  private:
+	unsigned long _timeout = 1000;
+};
+
+#endif // _STUB_ARDUINO_H_
@@ -0,0 +1,92 @@
+/*
+ * CoAP POST sample sketch
+ *
+ *  対向するサーバは、UDPポートPORT_NOでCoAPを待ち受けして、リソースRESOURCEへのPOSTを受け付けるものとする
+ *  ペイロードがh78COAP_BLOCK_SIZEより大きいため、Block1で分割して送信される
+ */
+
+#include <mgim.h>
+#include <hl7800.h>
+#include <hl7800_coap.h>
+
+#define HOST        "***.***"   // CoAPサーバ(FQDN or IPアドレス)
+#define PORT_NO     5683        // CoAPサーバのポート番号
+#define RESOURCE    "sensors/log"
+
+HL7800  hl7800;
+HL7800CoAP coap(hl7800);
+char data[1200];
+char response[256];
+
+void setup() {
+  // 最初に、mgimの初期化
+  mgim.begin();
+
+  while (! mgSERIAL_MONITOR)
+    ;
+  mgSERIAL_MONITOR.begin(9600);
+  mgSERIAL_MONITOR.println("CoAP TEST Start..");
+
+  hl7800.powerOn();
+  delay(1000);
+
+  int stat = hl7800.begin();
+  if (stat != 0) {
+    mgSERIAL_MONITOR.println("hl7800(): error");
+    while (1) ;
+  }
+  mgSERIAL_MONITOR.println("hl7800(): OK");
+
+  if ((stat = hl7800.setProfile("soracom.io", "sora", "sora")) == 0) {
+    mgSERIAL_MONITOR.println("setProfile() OK");
+  }
+  else {
+    mgSERIAL_MONITOR.print("setProfile() error: ");
+    mgSERIAL_MONITOR.println(stat);
+    while (1) ;
+  }
+
+  if ((stat = coap.begin(HOST, PORT_NO)) == 0) {
+    mgSERIAL_MONITOR.println("coap.begin() OK");
+  }
+  else {
+    mgSERIAL_MONITOR.print("coap.begin() error: ");
+    mgSERIAL_MONITOR.println(stat);
+    while (true)
+      ;
+  }
+
+  // 送信データ(JSON形式)を用意しておく
+  int len = sprintf(data, "{\"log\":\"");
+  while (len < (int)sizeof(data) - 3) {
+    data[len] = '0' + (len % 10);
+    len++;
+  }
+  strcpy(data + len, "\"}");
+}
+
+void loop() {
+  int stat;
+  int size = sizeof(response) - 1;
+  mgSERIAL_MONITOR.println(">>");
+  if ((stat = coap.post(RESOURCE, data, strlen(data), h78COAP_JSON, response, &size)) == 0) {
+    response[size] = '\0';
+    mgSERIAL_MONITOR.print("post() OK: ");
+    mgSERIAL_MONITOR.print(coap.getLastResponseCode());
+    mgSERIAL_MONITOR.print(" ");
+    mgSERIAL_MONITOR.println(response);
+  }
+  else if (stat < 0) {
+    mgSERIAL_MONITOR.print("post() error response: ");
+    mgSERIAL_MONITOR.println(-stat);
+  }
+  else {
+    mgSERIAL_MONITOR.print("post() error: ");
+    mgSERIAL_MONITOR.println(stat);
+  }
+  mgSERIAL_MONITOR.print("retransmissions: ");
+  mgSERIAL_MONITOR.println(coap.getRetransmissions());
+  mgSERIAL_MONITOR.println("<<");
+
+  delay(10000);
+}
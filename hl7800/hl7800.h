@@ -10,6 +10,7 @@
  *  R4  2021/06/23 (A.D) bug fix
  *  R5  2021/08/16 (A.D) add setRootCA() and getLastHttpStatusCode(), so we support "https:" from now on.
  *                       change begin() add parameter "reset"
+ *  R7  2026/10/19       add receiveUDP(), and track +KUDP_DATA indications per datagram
  *
  *  Copyright(c) 2020-2021 TABrain Inc. All rights reserved.
  */
@@ -48,6 +49,7 @@
 #define h78IMEI_SIZE                15          // IMEI length[bytes] - '\0' is not included.
 #define h78DATETIME_SIZE            19          // Date and time length[bytes] - '\0' is not included.
 #define h78MAX_UDP_PAYLOAD_SIZE     1472        // Maximum payload size
+#define h78UDP_DATAGRAM_QUEUE       4           // Number of +KUDP_DATA indications kept until read
 #define h78MAX_TCP_DATA_SIZE_ONCE   32000       // Maximum data size that can be sent at one time via TCP
 #define h78UNKNOWN_BODY_SIZE        (384*1024)  // Assume less than 384KB
 #define h78MAX_RESULT_LENGTH        1088        // Actual maximum command result length, include '\n' (in byets)
@@ -95,6 +97,7 @@
 #define h78ERR_UDP_CONNECT          803         // sendUDP() -
 #define h78ERR_UDP_RES              804         // sendUDP() -
 #define h78ERR_UDP_NAME             805         // getNameUDP() -
+#define h78ERR_UDP_RECEIVE          806         // receiveUDP() -
   // tcp function errors
 #define h78ERR_TCP_ALREADY_CONNECTED    601     //
 #define h78ERR_TCP_NOT_YET_CONNECTED    602     //
@@ -163,6 +166,7 @@ class HL7800 {
         _vgpioPin = _mgHL7800VGPIOPin;
         _initialized = false;
         _httpSessionId = _tcpSessionId = _udpSessionId = 0;
+        _udpDatagramCount = 0;
     }
 
     // Begin/end
@@ -186,6 +190,7 @@ class HL7800 {
     int beginUDP(void);
     int endUDP(void);
     int sendUDP(char *server, int port, void *msg, int size);
+    int receiveUDP(void *msg, int size, uint32_t timeout = h78TIMEOUT_UDP);    // @add R7
     int getNameUDP(char *ip);
     // int getStatusUDP(int *status, int *tcpNotif, int *remainedBytes, int *recievedBytes);
 
@@ -238,6 +243,8 @@ class HL7800 {
     void hangUp(void);
     void closeHttpSession(void);
     boolean isEOD(char *latests, int size, int last);
+    void checkIndication(const char *line);
+    void dropDatagram(void);
 
     // Variables
     boolean _initialized;
@@ -245,6 +252,9 @@ class HL7800 {
     int _udpSessionId;
     int _tcpSessionId;
     int _httpSessionId;
+      // Lengths of datagrams notified by +KUDP_DATA and not yet read(oldest first)
+    int _udpDatagrams[h78UDP_DATAGRAM_QUEUE];
+    int _udpDatagramCount;
       // Last http status code
     int _lastHttpStatusCode;
       // time out values
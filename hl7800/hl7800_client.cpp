@@ -0,0 +1,251 @@
+/*
+ *  hl7800_client.cpp
+ *
+ *  Arduino Client adapter over HL7800 TCP
+ *
+ *  R0  2026/10/19  read-ahead and write coalescing
+ *
+ *  Copyright(c) 2020-2021 TABrain Inc. All rights reserved.
+ */
+
+#include "hl7800_client.h"
+
+/**
+ *  @fn
+ *
+ *  通信相手(IPアドレスで指定)にTCPで接続する
+ *
+ *  @param(ip)          [in] 接続する相手のIPアドレス
+ *  @param(port)        [in] 接続先のポート番号
+ *  @return             1:成功時、0:エラー時
+ */
+int HL7800Client::connect(IPAddress ip, uint16_t port) {
+    char host[16];      // "nnn.nnn.nnn.nnn"
+    sprintf(host, "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+
+    return (connect(host, port));
+}
+
+/**
+ *  @fn
+ *
+ *  通信相手(ホスト名で指定)にTCPで接続する
+ *
+ *  @param(host)        [in] 接続する相手のホスト
+ *  @param(port)        [in] 接続先のポート番号
+ *  @return             1:成功時、0:エラー時
+ */
+int HL7800Client::connect(const char *host, uint16_t port) {
+    if (_connected)
+        stop();
+
+    _rxIndex = _rxLength = _txLength = 0;
+    if (_hl7800.connectTCP(host, port) != h78SUCCESS)
+        return (0);     // NG
+
+    _connected = true;
+
+    return (1);         // OK
+}
+
+/**
+ *  @fn
+ *
+ *  1バイトを書き込む
+ *
+ *  @param(c)           [in] 書き込むデータ
+ *  @return             1:成功時、0:エラー時
+ *  @detail             write(buf, size)を参照
+ */
+size_t HL7800Client::write(uint8_t c) {
+    return (write(&c, 1));
+}
+
+/**
+ *  @fn
+ *
+ *  データを書き込む
+ *
+ *  @param(buf)         [in] 書き込むデータ(バイナリデータ可)
+ *  @param(size)        [in] bufのサイズ[Bytes]
+ *  @return             1～:成功時(書き込んだバイト数)、0:エラー時
+ *  @detail             データはバッファに溜め、バッファが一杯になったとき、flush()を呼ばれたとき、
+ *                      または読み出しの前に、まとめてwriteTCP()で送信する
+ */
+size_t HL7800Client::write(const uint8_t *buf, size_t size) {
+    if (! _connected) {
+        setWriteError();
+        return (0);     // NG -- not connected
+    }
+
+    size_t written = 0;
+    while (written < size) {
+        size_t n = size - written;
+        if (n > sizeof(_txBuffer) - _txLength)
+            n = sizeof(_txBuffer) - _txLength;
+        memcpy(_txBuffer + _txLength, buf + written, n);
+        _txLength += n;
+        written += n;
+
+        if (_txLength == (int)sizeof(_txBuffer) && sendPending() != h78SUCCESS) {
+            setWriteError();
+            return (0);     // NG -- can't write
+        }
+    }
+
+    return (written);   // OK
+}
+
+/**
+ *  @fn
+ *
+ *  読み出し可能なバイト数を返す
+ *
+ *  @return             読み出し可能なバイト数
+ *  @detail             バッファが空のときは、未送信のデータを送信した後、readTCP()で最大バッファサイズ分を先読みする
+ */
+int HL7800Client::available(void) {
+    if (_rxIndex < _rxLength)
+        return (_rxLength - _rxIndex);
+
+    if (! _connected)
+        return (0);
+
+    readAhead();
+
+    return (_rxLength - _rxIndex);
+}
+
+/**
+ *  @fn
+ *
+ *  1バイトを読み出す
+ *
+ *  @return             0～255:成功時(読み出したデータ)、-1:データなし
+ */
+int HL7800Client::read(void) {
+    if (available() <= 0)
+        return (-1);    // No data
+
+    return (_rxBuffer[_rxIndex++]);
+}
+
+/**
+ *  @fn
+ *
+ *  データを読み出す
+ *
+ *  @param(buf)         [out] 読み出したデータの格納先
+ *  @param(size)        [in] bufのサイズ[Bytes]
+ *  @return             1～:成功時(読み出したバイト数)、-1:データなし
+ */
+int HL7800Client::read(uint8_t *buf, size_t size) {
+    int nbytes = available();
+    if (nbytes <= 0)
+        return (-1);    // No data
+
+    if ((size_t)nbytes > size)
+        nbytes = size;
+    memcpy(buf, _rxBuffer + _rxIndex, nbytes);
+    _rxIndex += nbytes;
+
+    return (nbytes);    // OK
+}
+
+/**
+ *  @fn
+ *
+ *  次の1バイトを読み出さずに返す
+ *
+ *  @return             0～255:成功時(次のデータ)、-1:データなし
+ */
+int HL7800Client::peek(void) {
+    if (available() <= 0)
+        return (-1);    // No data
+
+    return (_rxBuffer[_rxIndex]);
+}
+
+/**
+ *  @fn
+ *
+ *  未送信のデータを送信する
+ *
+ *  @return             なし
+ */
+void HL7800Client::flush(void) {
+    if (sendPending() != h78SUCCESS)
+        setWriteError();
+}
+
+/**
+ *  @fn
+ *
+ *  未送信のデータを送信した後、TCP接続を切断する
+ *
+ *  @return             なし
+ */
+void HL7800Client::stop(void) {
+    if (_connected) {
+        sendPending();
+        _hl7800.disconnectTCP();
+        _connected = false;
+    }
+    _rxIndex = _rxLength = _txLength = 0;
+}
+
+/**
+ *  @fn
+ *
+ *  TCP接続の状態を返す
+ *
+ *  @return             1:接続中、またはバッファに未読のデータがあるとき、0:切断されているとき
+ *  @detail             相手からの切断は、先読みの際に検出する
+ */
+uint8_t HL7800Client::connected(void) {
+    if (_rxIndex < _rxLength)
+        return (1);
+
+    return (_connected ? 1 : 0);
+}
+
+/**
+ *  @fn
+ *
+ *  未送信のデータを送信した後、readTCP()でデータをバッファに先読みする
+ *
+ *  @return             0:データなし、0～:成功時(読み出したバイト数)、～0:エラー時(エラー番号のマイナス値)
+ */
+int HL7800Client::readAhead(void) {
+    sendPending();      // Request must be sent before waiting for its response
+
+    _rxIndex = _rxLength = 0;
+    int nbytes = _hl7800.readTCP(_rxBuffer, sizeof(_rxBuffer));
+    if (nbytes == - h78ERR_TCP_STATUS || nbytes == - h78ERR_TCP_NOT_YET_CONNECTED)
+        _connected = false;     // Closed connection by other side
+    if (nbytes <= 0)
+        return (nbytes);
+
+    _rxLength = nbytes;
+
+    return (nbytes);
+}
+
+/**
+ *  @fn
+ *
+ *  バッファに溜めたデータをwriteTCP()でまとめて送信する
+ *
+ *  @return             0:成功時、0以外:エラー時(エラー番号)
+ */
+int HL7800Client::sendPending(void) {
+    if (_txLength == 0)
+        return (h78SUCCESS);    // Nothing to send
+
+    int nbytes = _hl7800.writeTCP(_txBuffer, _txLength);
+    _txLength = 0;
+
+    return ((nbytes < 0) ? h78ERR_TCP_WRITE : h78SUCCESS);
+}
+
+// End of hl7800_client.cpp
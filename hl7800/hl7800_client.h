@@ -0,0 +1,67 @@
+/*
+ *  hl7800_client.h
+ *
+ *  Arduino Client adapter over HL7800 TCP
+ *
+ *  R0  2026/10/19  read-ahead and write coalescing
+ *
+ *  Copyright(c) 2020-2021 TABrain Inc. All rights reserved.
+ */
+
+#ifndef _hl7800_client_h_
+#define  _hl7800_client_h_
+
+#include <Arduino.h>
+#include <Client.h>
+#include <IPAddress.h>
+#include "hl7800.h"
+
+// Symbols
+#ifndef h78CLIENT_RX_BUFFER_SIZE
+#define h78CLIENT_RX_BUFFER_SIZE    1024        // Size of read-ahead buffer(max h78MAX_TCP_READ_SIZE) [Bytes]
+#endif
+#ifndef h78CLIENT_TX_BUFFER_SIZE
+#define h78CLIENT_TX_BUFFER_SIZE    512         // Size of write coalescing buffer(max h78MAX_TCP_WRITE_SIZE) [Bytes]
+#endif
+
+// Class definition
+class HL7800Client : public Client {
+  public:
+    HL7800Client(HL7800 &hl7800) : _hl7800(hl7800) {
+        _connected = false;
+        _rxIndex = _rxLength = _txLength = 0;
+    }
+
+    // Client methods
+    virtual int connect(IPAddress ip, uint16_t port);
+    virtual int connect(const char *host, uint16_t port);
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t *buf, size_t size);
+    virtual int available(void);
+    virtual int read(void);
+    virtual int read(uint8_t *buf, size_t size);
+    virtual int peek(void);
+    virtual void flush(void);
+    virtual void stop(void);
+    virtual uint8_t connected(void);
+    virtual operator bool(void) {
+        return _connected;
+    }
+    using Print::write;
+
+  private:
+    // Functions
+    int readAhead(void);
+    int sendPending(void);
+
+    // Variables
+    HL7800 &_hl7800;
+    boolean _connected;
+    uint8_t _rxBuffer[h78CLIENT_RX_BUFFER_SIZE];
+    int _rxIndex;               // Next position to read in _rxBuffer
+    int _rxLength;              // Valid bytes in _rxBuffer
+    uint8_t _txBuffer[h78CLIENT_TX_BUFFER_SIZE];
+    int _txLength;              // Pending bytes in _txBuffer
+};
+
+#endif // _hl7800_client_h_
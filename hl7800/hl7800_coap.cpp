@@ -0,0 +1,560 @@
+/*
+ *  hl7800_coap.cpp
+ *
+ *  CoAP(RFC7252) client library over HL7800 UDP
+ *
+ *  R0  2026/10/19  CON/NON request, retransmission and block-wise transfer(RFC7959)
+ *
+ *  Copyright(c) 2020-2021 TABrain Inc. All rights reserved.
+ */
+
+#include "hl7800_coap.h"
+
+// Symbols
+  // option numbers
+#define OPTION_URI_PATH             11
+#define OPTION_CONTENT_FORMAT       12
+#define OPTION_URI_QUERY            15
+#define OPTION_BLOCK2               23
+#define OPTION_BLOCK1               27
+#define OPTION_SIZE1                60
+  // misc..
+#define PAYLOAD_MARKER              0xff
+#define CODE_EMPTY                  0x00
+#define CODE_CONTINUE               ((2 << 5) | 31)     // 2.31 Continue
+#define BLOCK_MORE                  0x08                // M bit of Block1/Block2
+#define BLOCK_SZX_MASK              0x07                // SZX of Block1/Block2
+#define BLOCK_NUM(value)            ((value) >> 4)
+#define BLOCK_SIZE(szx)             (16 << (szx))
+#define RESPONSE_CODE(code)         (((code) >> 5) * 100 + ((code) & 0x1f))
+
+// Local functions
+static int szxOf(int size) {
+    int szx = 0;
+    while (szx < 6 && BLOCK_SIZE(szx) < size)
+        szx++;
+    return szx;
+}
+
+static boolean putOption(uint8_t **pp, uint8_t *end, uint16_t *last, uint16_t number, const uint8_t *value, int length) {
+    uint8_t *p = *pp;
+    uint16_t delta = number - *last;
+    uint8_t *head = p++;
+    uint8_t nibbles[2];
+    uint16_t values[2] = { delta, (uint16_t)length };
+    for (int i = 0; i < 2; i++) {
+        if (values[i] < 13)
+            nibbles[i] = values[i];
+        else if (values[i] < 269) {
+            nibbles[i] = 13;
+            if (p >= end)
+                return false;
+            *p++ = values[i] - 13;
+        }
+        else {
+            nibbles[i] = 14;
+            if (p + 1 >= end)
+                return false;
+            *p++ = (values[i] - 269) >> 8;
+            *p++ = (values[i] - 269) & 0xff;
+        }
+    }
+    if (head >= end || p + length > end)
+        return false;
+    *head = (nibbles[0] << 4) | nibbles[1];
+    memcpy(p, value, length);
+    *pp = p + length;
+    *last = number;
+
+    return true;
+}
+
+static boolean putUintOption(uint8_t **pp, uint8_t *end, uint16_t *last, uint16_t number, uint32_t value) {
+    uint8_t bytes[4];
+    int length = 0;
+    for (uint32_t v = value; v != 0; v >>= 8)
+        length++;
+    for (int i = 0; i < length; i++)
+        bytes[i] = (value >> (8 * (length - 1 - i))) & 0xff;
+
+    return putOption(pp, end, last, number, bytes, length);
+}
+
+static boolean getExtended(const uint8_t **pp, const uint8_t *end, int *value) {
+    const uint8_t *p = *pp;
+    if (*value == 13) {
+        if (p >= end)
+            return false;
+        *value = *p++ + 13;
+    }
+    else if (*value == 14) {
+        if (p + 1 >= end)
+            return false;
+        *value = ((p[0] << 8) | p[1]) + 269;
+        p += 2;
+    }
+    else if (*value == 15)
+        return false;   // reserved for payload marker
+    *pp = p;
+
+    return true;
+}
+
+/**
+ *  @fn
+ *
+ *  CoAP通信の準備を行う
+ *
+ *  @param(host)        [in] CoAPサーバ（IPアドレス(v4)、またはホスト名を指定）
+ *  @param(port)        [in] CoAPサーバのUDPポート番号
+ *  @return             0:成功時、0以外:エラー時
+ *  @detail             UDP通信を開始していなければ、ここで開始する
+ */
+int HL7800CoAP::begin(const char *host, int port) {
+    if (host == NULL || strlen(host) > h78MAX_HOST_LENGTH || port <= 0 || port > h78MAX_PORT_NUMBER)
+        return (h78ERR_BAD_PARAM);
+
+    int stat = _hl7800.beginUDP();
+    if (stat != h78SUCCESS && stat != h78ERR_ALREADY_INITIALIZED)
+        return (stat);
+
+    strcpy(_host, host);
+    _port = port;
+    _messageId = (uint16_t)random(0x10000);     // Initial message id should be randomized
+    _retransmissions = 0;
+
+    return (h78SUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  CoAP通信を終了する
+ *
+ *  @return             0:成功時、0以外:エラー時
+ *  @detail             UDP通信も終了する
+ */
+int HL7800CoAP::end(void) {
+    _host[0] = '\0';
+
+    return (_hl7800.endUDP());
+}
+
+/**
+ *  @fn
+ *
+ *  GETリクエストを送信し、レスポンスを受信する
+ *
+ *  @param(path)        [in] リソースのパス(ex. "sensors/temp?unit=c")
+ *  @param(response)    [out] レスポンスのペイロードの格納先(NULLならペイロードは読み捨てる)
+ *  @param(size)        [in/out] responseのサイズ／受信したペイロードのサイズ[Bytes]
+ *  @param(confirmable) [in] true:CON、false:NONで送信する
+ *  @return             0:成功時、1～:エラー時(エラーコード)、～-1:サーバーのエラーレスポンス(-(クラス*100+詳細))
+ *  @detail             request()を参照
+ */
+int HL7800CoAP::get(const char *path, void *response, int *size, boolean confirmable) {
+    return (request(h78COAP_GET, path, NULL, 0, h78COAP_NO_FORMAT, response, size, confirmable));
+}
+
+/**
+ *  @fn
+ *
+ *  POSTリクエストを送信し、レスポンスを受信する
+ *
+ *  @param(path)        [in] リソースのパス
+ *  @param(payload)     [in] 送信するペイロード(バイナリデータ可)
+ *  @param(length)      [in] payloadのサイズ[Bytes]
+ *  @param(format)      [in] payloadのContent-Format(h78COAP_JSONなど)
+ *  @param(response)    [out] レスポンスのペイロードの格納先(NULLならペイロードは読み捨てる)
+ *  @param(size)        [in/out] responseのサイズ／受信したペイロードのサイズ[Bytes]
+ *  @param(confirmable) [in] true:CON、false:NONで送信する
+ *  @return             0:成功時、1～:エラー時(エラーコード)、～-1:サーバーのエラーレスポンス(-(クラス*100+詳細))
+ *  @detail             request()を参照
+ */
+int HL7800CoAP::post(const char *path, const void *payload, int length, int format,
+                     void *response, int *size, boolean confirmable) {
+    return (request(h78COAP_POST, path, payload, length, format, response, size, confirmable));
+}
+
+/**
+ *  @fn
+ *
+ *  PUTリクエストを送信し、レスポンスを受信する
+ *
+ *  @param              post()と同じ
+ *  @return             post()と同じ
+ *  @detail             request()を参照
+ */
+int HL7800CoAP::put(const char *path, const void *payload, int length, int format,
+                    void *response, int *size, boolean confirmable) {
+    return (request(h78COAP_PUT, path, payload, length, format, response, size, confirmable));
+}
+
+/**
+ *  @fn
+ *
+ *  リクエストを送信し、レスポンスを受信する
+ *
+ *  @param(method)      [in] メソッド(h78COAP_GET/POST/PUT/DELETE)
+ *  @param              その他はpost()と同じ
+ *  @return             post()と同じ
+ *  @detail             h78COAP_BLOCK_SIZEより大きいペイロードはBlock1で分割して送信する。
+ *                      レスポンスがBlock2で分割されている場合は、続きのブロックを順に要求して連結する。
+ *                      サーバーがより小さいブロックサイズを要求した場合は、それに従う。
+ *                      CONの場合はACKが返るまで指数バックオフで再送し(最大h78COAP_MAX_RETRANSMIT回)、
+ *                      別送レスポンス(空ACKの後のレスポンス)にも対応する。
+ */
+int HL7800CoAP::request(int method, const char *path, const void *payload, int length, int format,
+                        void *response, int *size, boolean confirmable) {
+    if (path == NULL || length < 0 || (payload == NULL && length > 0) || (response != NULL && size == NULL))
+        return (h78ERR_BAD_PARAM);
+    if (_host[0] == '\0')
+        return (h78ERR_NOT_YET_INITIALIZED);
+
+    uint8_t type = confirmable ? h78COAP_CON : h78COAP_NON;
+    const uint8_t *data = (const uint8_t *)payload;
+    int capacity = (response != NULL) ? *size : 0;
+    int received = 0;
+    if (size != NULL)
+        *size = 0;
+    _lastResponseCode = 0;
+
+    // Send the request (split into blocks by Block1 if it is large)
+    COAP_MESSAGE resp;
+    boolean useBlock1 = (length > h78COAP_BLOCK_SIZE);
+    int szx = szxOf(h78COAP_BLOCK_SIZE);
+    int offset = 0;
+    while (true) {
+        int blockSize = BLOCK_SIZE(szx);
+        int chunk = length - offset;
+        boolean more = false;
+        if (useBlock1 && chunk > blockSize) {
+            chunk = blockSize;
+            more = true;
+        }
+        uint32_t block1 = ((uint32_t)(offset / blockSize) << 4) | (more ? BLOCK_MORE : 0) | szx;
+        int txLength = buildRequest(type, method, path, format, block1, useBlock1, (offset == 0) ? length : -1,
+                                    0, false, data + offset, chunk);
+        if (txLength == 0)
+            return (h78ERR_BAD_PARAM);      // Too long path or query
+        int stat;
+        if ((stat = exchange(type, txLength, &resp)) != h78SUCCESS)
+            return (stat);
+        _lastResponseCode = RESPONSE_CODE(resp.code);
+        offset += chunk;
+        if (! more || resp.code != CODE_CONTINUE)
+            break;          // Last block or final response
+
+        // Follow the block size which the server prefers
+        if (resp.hasBlock1 && (int)(resp.block1 & BLOCK_SZX_MASK) < szx)
+            szx = resp.block1 & BLOCK_SZX_MASK;
+    }
+
+    // Receive the response (concatenate blocks by Block2)
+    uint32_t nextNum = 0;
+    while (true) {
+        if (resp.code >= (4 << 5))
+            return (- RESPONSE_CODE(resp.code));    // 4.xx/5.xx
+        if ((resp.code >> 5) != 2)
+            return (h78ERR_COAP_BAD_RESPONSE);
+        if (resp.hasBlock2 && BLOCK_NUM(resp.block2) != nextNum)
+            return (h78ERR_COAP_BLOCK);
+
+        // Store the payload
+        if (response != NULL && resp.payloadLength > 0) {
+            int n = resp.payloadLength;
+            if (received + n > capacity)
+                n = capacity - received;
+            memcpy((uint8_t *)response + received, resp.payload, n);
+            received += n;
+            *size = received;
+            if (n < resp.payloadLength)
+                return (h78ERR_COAP_TOO_BIG_DATA);
+        }
+        if (! resp.hasBlock2 || ! (resp.block2 & BLOCK_MORE))
+            break;          // Last block
+
+        // Request next block
+        nextNum = BLOCK_NUM(resp.block2) + 1;
+        uint32_t block2 = (nextNum << 4) | (resp.block2 & BLOCK_SZX_MASK);
+        int txLength = buildRequest(type, method, path, h78COAP_NO_FORMAT, 0, false, -1, block2, true, NULL, 0);
+        if (txLength == 0)
+            return (h78ERR_BAD_PARAM);
+        int stat;
+        if ((stat = exchange(type, txLength, &resp)) != h78SUCCESS)
+            return (stat);
+        _lastResponseCode = RESPONSE_CODE(resp.code);
+    }
+
+    return (h78SUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  リクエストメッセージを_txBufferに組み立てる
+ *
+ *  @param(type)        [in] メッセージタイプ(h78COAP_CON/NON)
+ *  @param(method)      [in] メソッド
+ *  @param(path)        [in] リソースのパス("?"以降はUri-Queryとする)
+ *  @param(format)      [in] Content-Format(h78COAP_NO_FORMATなら付けない)
+ *  @param(block1)      [in] Block1オプションの値
+ *  @param(useBlock1)   [in] Block1オプションを付けるか否か
+ *  @param(size1)       [in] Size1オプションの値(-1なら付けない)
+ *  @param(block2)      [in] Block2オプションの値
+ *  @param(useBlock2)   [in] Block2オプションを付けるか否か
+ *  @param(payload)     [in] ペイロード
+ *  @param(length)      [in] ペイロードのサイズ[Bytes]
+ *  @return             1～:成功時(メッセージのサイズ)、0:バッファ不足
+ *  @detail             メッセージIDとトークンは毎回新しくする
+ */
+int HL7800CoAP::buildRequest(uint8_t type, int method, const char *path, int format,
+                             uint32_t block1, boolean useBlock1, int size1,
+                             uint32_t block2, boolean useBlock2,
+                             const uint8_t *payload, int length) {
+    uint8_t *p = _txBuffer;
+    uint8_t *end = _txBuffer + sizeof(_txBuffer);
+
+    // Header and token
+    _messageId++;
+    newToken();
+    *p++ = (h78COAP_VERSION << 6) | (type << 4) | h78COAP_TOKEN_LENGTH;
+    *p++ = (uint8_t)method;
+    *p++ = _messageId >> 8;
+    *p++ = _messageId & 0xff;
+    memcpy(p, _token, h78COAP_TOKEN_LENGTH);
+    p += h78COAP_TOKEN_LENGTH;
+
+    // Options (must be in ascending order of option number)
+    uint16_t last = 0;
+    const char *query = strchr(path, '?');
+    const char *pathEnd = (query != NULL) ? query : path + strlen(path);
+    for (const char *s = path; s < pathEnd; ) {
+        const char *e = s;
+        while (e < pathEnd && *e != '/')
+            e++;
+        if (e > s && ! putOption(&p, end, &last, OPTION_URI_PATH, (const uint8_t *)s, e - s))
+            return (0);
+        s = e + 1;
+    }
+    if (format >= 0 && ! putUintOption(&p, end, &last, OPTION_CONTENT_FORMAT, format))
+        return (0);
+    if (query != NULL) {
+        for (const char *s = query + 1; *s != '\0'; ) {
+            const char *e = s;
+            while (*e != '\0' && *e != '&')
+                e++;
+            if (e > s && ! putOption(&p, end, &last, OPTION_URI_QUERY, (const uint8_t *)s, e - s))
+                return (0);
+            s = (*e == '\0') ? e : e + 1;
+        }
+    }
+    if (useBlock2 && ! putUintOption(&p, end, &last, OPTION_BLOCK2, block2))
+        return (0);
+    if (useBlock1 && ! putUintOption(&p, end, &last, OPTION_BLOCK1, block1))
+        return (0);
+    if (useBlock1 && size1 >= 0 && ! putUintOption(&p, end, &last, OPTION_SIZE1, size1))
+        return (0);
+
+    // Payload
+    if (length > 0) {
+        if (p + 1 + length > end)
+            return (0);
+        *p++ = PAYLOAD_MARKER;
+        memcpy(p, payload, length);
+        p += length;
+    }
+
+    return ((int)(p - _txBuffer));
+}
+
+/**
+ *  @fn
+ *
+ *  _txBufferのメッセージを送信し、対応するレスポンスを受信する
+ *
+ *  @param(type)        [in] メッセージタイプ(h78COAP_CON/NON)
+ *  @param(length)      [in] メッセージのサイズ[Bytes]
+ *  @param(resp)        [out] 受信したレスポンス(ペイロードは_rxBufferを指す)
+ *  @return             0:成功時、0以外:エラー時(エラーコード)
+ *  @detail             CONの場合、ACK_TIMEOUT～ACK_TIMEOUT*ACK_RANDOM_FACTORの乱数から始めて、
+ *                      待ち時間を倍にしながらMAX_RETRANSMIT回まで再送する(RFC7252 4.2)。
+ *                      空ACKを受信したら、別送レスポンスをh78COAP_TIMEOUT_RESPONSEまで待つ。
+ *                      CONのレスポンスにはACKを返し、心当たりのないCONにはRSTを返す。
+ */
+int HL7800CoAP::exchange(uint8_t type, int length, COAP_MESSAGE *resp) {
+    uint16_t messageId = (_txBuffer[2] << 8) | _txBuffer[3];
+    uint32_t timeout = h78COAP_ACK_TIMEOUT
+                     + random(h78COAP_ACK_TIMEOUT * (h78COAP_ACK_RANDOM_FACTOR - 1000) / 1000 + 1);
+    boolean acknowledged = false;
+
+    for (int retry = 0; ; retry++) {
+        int stat;
+        if ((stat = _hl7800.sendUDP(_host, _port, _txBuffer, length)) != h78SUCCESS)
+            return (stat);
+
+        uint32_t limit = millis() + ((type == h78COAP_CON) ? timeout : h78COAP_TIMEOUT_RESPONSE);
+        while ((stat = receive(limit, resp)) == h78SUCCESS) {
+            boolean tokenMatched = (resp->tokenLength == h78COAP_TOKEN_LENGTH
+                                    && ! memcmp(resp->token, _token, h78COAP_TOKEN_LENGTH));
+            if (resp->type == h78COAP_ACK || resp->type == h78COAP_RST) {
+                if (resp->messageId != messageId)
+                    continue;       // ACK/RST to old message
+                if (resp->type == h78COAP_RST)
+                    return (h78ERR_COAP_RESET);
+                if (resp->code != CODE_EMPTY && tokenMatched)
+                    return (h78SUCCESS);        // Piggybacked response
+                if (resp->code == CODE_EMPTY && ! acknowledged) {
+                    // Separate response will follow
+                    acknowledged = true;
+                    limit = millis() + h78COAP_TIMEOUT_RESPONSE;
+                }
+                continue;
+            }
+            if (tokenMatched) {
+                // Separate response or response to NON
+                if (resp->type == h78COAP_CON)
+                    sendEmpty(h78COAP_ACK, resp->messageId);
+                return (h78SUCCESS);
+            }
+            if (resp->type == h78COAP_CON)
+                sendEmpty(h78COAP_RST, resp->messageId);    // Unknown message
+        }
+        if (stat != h78ERR_COAP_TIMED_OUT)
+            return (stat);
+        if (type != h78COAP_CON || acknowledged || retry >= h78COAP_MAX_RETRANSMIT)
+            return (h78ERR_COAP_TIMED_OUT);
+
+        timeout *= 2;
+        _retransmissions++;
+    }
+}
+
+/**
+ *  @fn
+ *
+ *  メッセージを1つ受信する
+ *
+ *  @param(limit)       [in] 受信する期限[mS]
+ *  @param(resp)        [out] 受信したメッセージ
+ *  @return             0:成功時、0以外:エラー時(エラーコード)
+ *  @detail             解析できないメッセージは読み捨てる
+ */
+int HL7800CoAP::receive(uint32_t limit, COAP_MESSAGE *resp) {
+    while (true) {
+        int32_t remain = (int32_t)(limit - millis());
+        if (remain <= 0)
+            return (h78ERR_COAP_TIMED_OUT);
+        int len = _hl7800.receiveUDP(_rxBuffer, sizeof(_rxBuffer), remain);
+        if (len < 0)
+            return (- len);
+        if (len == 0)
+            return (h78ERR_COAP_TIMED_OUT);
+        if (parse(len, resp))
+            return (h78SUCCESS);
+        h78USBDPLN("CoAP: malformed message(%d)", len);
+    }
+}
+
+/**
+ *  @fn
+ *
+ *  _rxBufferのメッセージを解析する
+ *
+ *  @param(length)      [in] メッセージのサイズ[Bytes]
+ *  @param(msg)         [out] 解析結果
+ *  @return             true:成功時、false:不正なメッセージ
+ *  @detail             オプションはBlock1/Block2のみを取り出す
+ */
+boolean HL7800CoAP::parse(int length, COAP_MESSAGE *msg) {
+    const uint8_t *p = _rxBuffer;
+    const uint8_t *end = _rxBuffer + length;
+
+    // Header and token
+    if (length < 4 || (p[0] >> 6) != h78COAP_VERSION)
+        return false;
+    msg->type = (p[0] >> 4) & 0x03;
+    msg->tokenLength = p[0] & 0x0f;
+    msg->code = p[1];
+    msg->messageId = (p[2] << 8) | p[3];
+    p += 4;
+    if (msg->tokenLength > 8 || p + msg->tokenLength > end)
+        return false;
+    msg->token = p;
+    p += msg->tokenLength;
+
+    // Options and payload
+    msg->hasBlock1 = msg->hasBlock2 = false;
+    msg->block1 = msg->block2 = 0;
+    msg->payload = NULL;
+    msg->payloadLength = 0;
+    int number = 0;
+    while (p < end) {
+        if (*p == PAYLOAD_MARKER) {
+            if (++p == end)
+                return false;   // Payload marker followed by empty payload
+            msg->payload = p;
+            msg->payloadLength = (int)(end - p);
+            break;
+        }
+        int delta = *p >> 4;
+        int optionLength = *p & 0x0f;
+        p++;
+        if (! getExtended(&p, end, &delta) || ! getExtended(&p, end, &optionLength))
+            return false;
+        if (p + optionLength > end)
+            return false;
+        number += delta;
+        if ((number == OPTION_BLOCK1 || number == OPTION_BLOCK2) && optionLength <= 3) {
+            uint32_t value = 0;
+            for (int i = 0; i < optionLength; i++)
+                value = (value << 8) | p[i];
+            if (number == OPTION_BLOCK1) {
+                msg->hasBlock1 = true;
+                msg->block1 = value;
+            }
+            else {
+                msg->hasBlock2 = true;
+                msg->block2 = value;
+            }
+        }
+        p += optionLength;
+    }
+
+    return true;
+}
+
+/**
+ *  @fn
+ *
+ *  空メッセージ(ACK/RST)を送信する
+ *
+ *  @param(type)        [in] メッセージタイプ(h78COAP_ACK/RST)
+ *  @param(messageId)   [in] 受信したメッセージのID
+ *  @return             0:成功時、0以外:エラー時(エラーコード)
+ *  @detail             _txBufferは再送用に残しておくため、使用しない
+ */
+int HL7800CoAP::sendEmpty(uint8_t type, uint16_t messageId) {
+    uint8_t msg[4];
+    msg[0] = (h78COAP_VERSION << 6) | (type << 4);
+    msg[1] = CODE_EMPTY;
+    msg[2] = messageId >> 8;
+    msg[3] = messageId & 0xff;
+
+    return (_hl7800.sendUDP(_host, _port, msg, sizeof(msg)));
+}
+
+/**
+ *  @fn
+ *
+ *  新しいトークンを生成する
+ *
+ *  @return             なし
+ *  @detail
+ */
+void HL7800CoAP::newToken(void) {
+    for (int i = 0; i < h78COAP_TOKEN_LENGTH; i++)
+        _token[i] = (uint8_t)random(0x100);
+}
+
+// End of hl7800_coap.cpp
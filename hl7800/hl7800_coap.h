@@ -0,0 +1,124 @@
+/*
+ *  hl7800_coap.h
+ *
+ *  CoAP(RFC7252) client library over HL7800 UDP
+ *
+ *  R0  2026/10/19  CON/NON request, retransmission and block-wise transfer(RFC7959)
+ *
+ *  Copyright(c) 2020-2021 TABrain Inc. All rights reserved.
+ */
+
+#ifndef _hl7800_coap_h_
+#define  _hl7800_coap_h_
+
+#include <Arduino.h>
+#include "hl7800.h"
+
+// Symbols
+#define h78COAP_DEFAULT_PORT        5683        // Default CoAP port
+#define h78COAP_VERSION             1           // CoAP version
+#define h78COAP_TOKEN_LENGTH        4           // Length of token we use [Bytes]
+#define h78COAP_BLOCK_SIZE          512         // Block size of block-wise transfer(16,32,64,..,1024) [Bytes]
+#define h78COAP_MAX_OPTIONS_SIZE    (h78MAX_PATH_SIZE + 32)     // Uri-Path/Uri-Query + Content-Format + Block1/2 + Size1 [Bytes]
+#define h78COAP_BUFFER_SIZE         (4 + 8 + h78COAP_MAX_OPTIONS_SIZE + 1 + h78COAP_BLOCK_SIZE)
+  // transmission parameters (RFC7252 4.8)
+#define h78COAP_ACK_TIMEOUT         2000        // ACK_TIMEOUT [mS]
+#define h78COAP_ACK_RANDOM_FACTOR   1500        // ACK_RANDOM_FACTOR(x1000)
+#define h78COAP_MAX_RETRANSMIT      4           // MAX_RETRANSMIT
+#define h78COAP_TIMEOUT_RESPONSE    30000       // Timeout of separate response or response to NON request [mS]
+  // message types
+#define h78COAP_CON                 0           // Confirmable
+#define h78COAP_NON                 1           // Non-confirmable
+#define h78COAP_ACK                 2           // Acknowledgement
+#define h78COAP_RST                 3           // Reset
+  // method codes
+#define h78COAP_GET                 1
+#define h78COAP_POST                2
+#define h78COAP_PUT                 3
+#define h78COAP_DELETE              4
+  // content formats
+#define h78COAP_TEXT_PLAIN          0           // text/plain;charset=utf-8
+#define h78COAP_LINK_FORMAT         40          // application/link-format
+#define h78COAP_XML                 41          // application/xml
+#define h78COAP_OCTET_STREAM        42          // application/octet-stream
+#define h78COAP_JSON                50          // application/json
+#define h78COAP_CBOR                60          // application/cbor
+#define h78COAP_NO_FORMAT           (-1)        // Content-Format option is not sent
+//-- Error codes
+  // coap function errors (udp function errors are also returned)
+#define h78ERR_COAP_TOO_BIG_DATA    820         // Response is larger than the buffer
+#define h78ERR_COAP_TIMED_OUT       821         // No ACK after MAX_RETRANSMIT or no response
+#define h78ERR_COAP_RESET           822         // Server rejects the message(RST)
+#define h78ERR_COAP_BAD_RESPONSE    823         // Malformed response
+#define h78ERR_COAP_BLOCK           824         // Block-wise transfer error
+
+// Class definition
+class HL7800CoAP {
+  public:
+    HL7800CoAP(HL7800 &hl7800) : _hl7800(hl7800) {
+        _host[0] = '\0';
+        _port = h78COAP_DEFAULT_PORT;
+        _messageId = 0;
+        _lastResponseCode = 0;
+        _retransmissions = 0;
+    }
+
+    // Begin/end
+    int begin(const char *host, int port = h78COAP_DEFAULT_PORT);
+    int end(void);
+
+    // Requests
+    int get(const char *path, void *response, int *size, boolean confirmable = true);
+    int post(const char *path, const void *payload, int length, int format,
+             void *response, int *size, boolean confirmable = true);
+    int put(const char *path, const void *payload, int length, int format,
+            void *response, int *size, boolean confirmable = true);
+    int request(int method, const char *path, const void *payload, int length, int format,
+                void *response, int *size, boolean confirmable);
+
+    // Status
+    int getLastResponseCode(void) {     // ex. 205 means "2.05 Content"
+        return _lastResponseCode;
+    }
+    uint32_t getRetransmissions(void) {
+        return _retransmissions;
+    }
+
+  private:
+    // Received message
+    typedef struct {
+        uint8_t type;
+        uint8_t code;
+        uint16_t messageId;
+        const uint8_t *token;
+        int tokenLength;
+        const uint8_t *payload;
+        int payloadLength;
+        boolean hasBlock1, hasBlock2;
+        uint32_t block1, block2;    // NUM(20bits) | M(1bit) | SZX(3bits)
+    } COAP_MESSAGE;
+
+    // Functions
+    int buildRequest(uint8_t type, int method, const char *path, int format,
+                     uint32_t block1, boolean useBlock1, int size1,
+                     uint32_t block2, boolean useBlock2,
+                     const uint8_t *payload, int length);
+    int exchange(uint8_t type, int length, COAP_MESSAGE *resp);
+    int receive(uint32_t limit, COAP_MESSAGE *resp);
+    boolean parse(int length, COAP_MESSAGE *msg);
+    int sendEmpty(uint8_t type, uint16_t messageId);
+    void newToken(void);
+
+    // Variables
+    HL7800 &_hl7800;
+    char _host[h78MAX_HOST_LENGTH + 1];
+    int _port;
+    uint16_t _messageId;
+    uint8_t _token[h78COAP_TOKEN_LENGTH];
+    uint8_t _txBuffer[h78COAP_BUFFER_SIZE];
+    uint8_t _rxBuffer[h78COAP_BUFFER_SIZE];
+    int _lastResponseCode;
+    uint32_t _retransmissions;
+};
+
+#endif // _hl7800_coap_h_
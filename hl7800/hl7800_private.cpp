@@ -5,6 +5,7 @@
  *
  *  R0  2020/02/16 (A.D)
  *  R1  2020/06/21 (A.D)  fix parseCGATT(), waitUntilCONNECT()
+ *  R2  2026/10/19        add checkIndication() to track +KUDP_DATA
  *
  *  Copyright(c) 2020 TABrain Inc. All rights reserved.
  */
@@ -72,6 +73,7 @@ int HL7800::getSessionId(uint32_t timeout, const char *ind, int *sessionId) {
 
         line[len] = '\0';
         h78USBDPLN("line>>%s<<", line);
+        checkIndication(line);
         if (len > indLength && ! strncmp(line, ind, indLength)) {
             h78USBDPLN("%s>%s<", ind, line);
             for (int i = indLength; i < len; i++) {
@@ -121,6 +123,7 @@ int HL7800::waitUntilCONNECT(uint32_t timeout) {
         }
         line[len] = '\0';
         h78USBDPLN("line=\"%s\"", line);
+        checkIndication(line);
         if (len >= 8 && ! strncmp(line, "CONNECT\r", 8)) {
             h78USBDPLN("<waitUntilCONNECT() OK: %d", timeout - (limit - millis()));
             return (h78SUCCESS);
@@ -266,13 +269,19 @@ int  HL7800::waitUntilReady(uint32_t timeout, const char *prefix, int sessionId)
  */
 int HL7800::getLine(uint32_t limit, char *line, int size) {
     char *top = line;
+    char head[24];      // 行頭(インディケータ検出用、lineのサイズに依らず保持する)
+    int headLength = 0;
     while (millis() < limit) {
         int c = 0;
         if ((c = h78SERIAL.read()) < 0)
             continue;
         if (--size > 0)
             *line++ = (char)c;
+        if (headLength < (int)sizeof(head) - 1)
+            head[headLength++] = (char)c;
         if (c == '\n') {
+            head[headLength] = '\0';
+            checkIndication(head);
 #ifdef DEBUG_USB
             h78USBDP("<getLine() return: %d,\"", (int)(line - top));
             for (int i = 0; i < (int)(line - top); i++)
@@ -287,4 +296,48 @@ int HL7800::getLine(uint32_t limit, char *line, int size) {
     return (0);     // timeout
 }
 
+/**
+ *  @fn
+ *
+ *  非同期に通知されるインディケータを検出し、状態に反映する
+ *
+ *  @param(line)        [in] 取得した1行分のレスポンス('\0'終端)
+ *  @return             なし
+ *  @detail             現在は+KUDP_DATA(UDPデータ受信通知)のみを扱う
+ */
+void HL7800::checkIndication(const char *line) {
+  // Indication patterns are as follows:
+  //   +KUDP_DATA: <session_id>,<ndata>\r\n
+    if (strncmp(line, "+KUDP_DATA: ", 12))
+        return;
+
+    int sessionId = 0, nBytes = 0;
+    if (sscanf(line + 12, "%d,%d", &sessionId, &nBytes) != 2)
+        return;
+    h78USBDPLN("+KUDP_DATA>%d,%d<", sessionId, nBytes);
+    if (sessionId != _udpSessionId || nBytes <= 0)
+        return;
+    if (_udpDatagramCount < h78UDP_DATAGRAM_QUEUE)
+        _udpDatagrams[_udpDatagramCount++] = nBytes;
+    else
+        _udpDatagrams[h78UDP_DATAGRAM_QUEUE - 1] += nBytes;    // Queue is full, keep the bytes in the last one
+}
+
+/**
+ *  @fn
+ *
+ *  最も古い受信データグラムの通知を捨てる
+ *
+ *  @return             なし
+ *  @detail             読み出し終わった(または読み出せなかった)データグラムに対して呼び出す
+ */
+void HL7800::dropDatagram(void) {
+    if (_udpDatagramCount == 0)
+        return;
+
+    _udpDatagramCount--;
+    for (int i = 0; i < _udpDatagramCount; i++)
+        _udpDatagrams[i] = _udpDatagrams[i + 1];
+}
+
 // End of hl7800_private.cpp
@@ -5,6 +5,7 @@
  *
  *  R0  2020/02/16 (A.D)
  *  R1  2020/06/21 (A.D)
+ *  R2  2026/10/19        add receiveUDP()
  *
  *  Copyright(c) 2020 TABrain Inc. All rights reserved.
  */
@@ -30,6 +31,7 @@ int  HL7800::beginUDP(void) {
     // Check that session is not exist
     if (_udpSessionId != 0)
         return (h78ERR_ALREADY_INITIALIZED);
+    _udpDatagramCount = 0;
 
     // Configure UDP connection and set udp session id
     h78SENDFLN("AT+KUDPCFG=1,0");
@@ -73,6 +75,7 @@ int  HL7800::endUDP(void) {
     discardResponse(200);
 
     _udpSessionId = 0;      // Clear udp session id
+    _udpDatagramCount = 0;
 
     return (h78SUCCESS);
 }
@@ -135,6 +138,64 @@ int  HL7800::sendUDP(char *host, int port, void *msg, int size) {
     return (h78SUCCESS);
 }
 
+/**
+ *  @fn
+ *
+ *  UDP通信でデータを受信する
+ *
+ *  @param(msg)         [out] 受信したデータの格納先
+ *  @param(size)        [in] msgのサイズ[Bytes]
+ *  @param(timeout)     [in] 受信を待つ時間[mS]
+ *  @return             1～:成功時(受信したバイト数)、0:受信データなし、～0:エラー時(エラー番号のマイナス値)
+ *  @detail             +KUDP_DATAで通知された受信データを、1回の呼び出しで1データグラムずつ読み出す。
+ *                      受信データがsizeより大きい場合は、残りを次回の呼び出しで読み出す。
+ *                      (通知がh78UDP_DATAGRAM_QUEUEを超えて貯まった場合、超えた分は最後の通知とまとめて読み出す)
+ */
+int  HL7800::receiveUDP(void *msg, int size, uint32_t timeout) {
+    int stat = 0;
+
+    if (msg == NULL || size <= 0)
+        return (- h78ERR_BAD_PARAM);
+
+    // Check that session is exist
+    if (_udpSessionId == 0)
+        return (- h78ERR_NOT_YET_INITIALIZED);
+
+    // Wait for +KUDP_DATA (getLine() queues the length of each datagram)
+    uint32_t limit = millis() + timeout;
+    while (_udpDatagramCount == 0) {
+        char line[30];
+        if (getLine(limit, line, sizeof(line)) == 0)
+            return (0);     // No data
+    }
+
+    // Receive the oldest datagram from the session
+    int requestBytes = (size < _udpDatagrams[0]) ? size : _udpDatagrams[0];
+    h78SENDFLN("AT+KUDPRCV=%d,%d", _udpSessionId, requestBytes);
+    h78USBDPLN("AT+KUDPRCV=%d,%d", _udpSessionId, requestBytes);
+    if ((stat = waitUntilCONNECT(h78TIMEOUT_UDP)) != h78SUCCESS) {
+        h78USBDPLN("+>KUDPRCV NG(Connect): %d", stat);
+        dropDatagram();             // Discard the notification, because we can't read it
+        return (- h78ERR_UDP_RECEIVE);
+    }
+    int len = requestBytes;
+    getData(h78TIMEOUT_UDP, (char *)msg, &len);
+    _udpDatagrams[0] -= len;
+    if (len <= 0 || _udpDatagrams[0] <= 0)
+        dropDatagram();             // The datagram was read fully(or can't be read)
+
+    // Skip EOD and OK
+    char response[20];
+    int respSize = sizeof(response) - 1;
+    if ((stat = getResponse(h78TIMEOUT_UDP, response, &respSize)) != h78SUCCESS) {
+        h78USBDPLN("+>KUDPRCV NG(Response): %d", stat);
+        return (- h78ERR_UDP_RECEIVE);
+    }
+    h78USBDPLN("+>KUDPRCV OK: %d", len);
+
+    return (len);
+}
+
 /**
  *  @fn
  *
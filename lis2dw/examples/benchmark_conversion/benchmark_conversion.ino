@@ -0,0 +1,68 @@
+/*
+ * LIS2DW Sample sketch for CAIM -- Benchmark of unit conversion
+ *
+ *  Compares float division(the former tomg(raw, range)) with tomg(raw[], mg[], n, range)
+ *  (array, integer multiply and shift) for all 14-bit values in each range, and prints
+ *  the time per value and the number of different results. No sensor is needed.
+ */
+
+#include <Wire.h>
+#include "lis2dw.h"
+
+// Serial monitor port
+#define SERIAL_MONITOR     SerialUSB
+
+#define N_VALUES      (3 * s2MAX_FIFO_SAMPLES)  // Values in a block(full FIFO)
+#define N_BLOCKS      (16384 / N_VALUES + 1)    // Blocks to cover all 14-bit values
+
+LIS2DW  acc(HIGH);
+
+// floatmg() -- convert raw to mg by float division(as tomg() of R1.4 and before)
+int floatmg(int raw, int range) {
+  switch (range) {
+    case s2FS_2G:
+      return (raw / 4.096);
+    case s2FS_4G:
+      return (raw / 2.048);
+    case s2FS_8G:
+      return (raw / 1.024);
+    default:
+      return (raw / 0.512);
+  }
+}
+
+void setup() {
+  SERIAL_MONITOR.begin(115200);
+  while (! SERIAL_MONITOR)
+    ;
+
+  const int ranges[] = { s2FS_2G, s2FS_4G, s2FS_8G, s2FS_16G };
+  const char *names[] = { "2g", "4g", "8g", "16g" };
+  for (int r = 0; r < 4; r++) {
+    int16_t raw[N_VALUES], mg[N_VALUES], mg2[N_VALUES];
+    uint32_t perSample = 0, perArray = 0;
+    long different = 0;
+    for (int b = 0; b < N_BLOCKS; b++) {
+      for (int i = 0; i < N_VALUES; i++)
+        raw[i] = ((b * N_VALUES + i) & 0x3fff) - 8192;
+      uint32_t start = micros();
+      for (int i = 0; i < N_VALUES; i++)
+        mg[i] = floatmg(raw[i], ranges[r]);
+      uint32_t middle = micros();
+      acc.tomg(raw, mg2, N_VALUES, ranges[r]);
+      uint32_t end = micros();
+      perSample += middle - start;
+      perArray += end - middle;
+      for (int i = 0; i < N_VALUES; i++)
+        if (mg[i] != mg2[i])
+          different++;
+    }
+    char line[100];
+    sprintf(line, "%s: float=%lu nS, array=%lu nS, different=%ld", names[r],
+            perSample * 1000UL / (N_BLOCKS * N_VALUES), perArray * 1000UL / (N_BLOCKS * N_VALUES), different);
+    SERIAL_MONITOR.println(line);
+  }
+}
+
+void loop() {
+}
@@ -5,6 +5,12 @@
  *
  *	Version:
  *		R1.0  2021.04.25
+ *		R1.1  2026.10.19  Add readFIFOBurst(), readFIFO() reads by burst transfer
+ *		R1.2  2026.10.19  Keep shadow of control registers, add updateRegister(), stageRegister() and applyConfig()
+ *		R1.3  2026.10.19  Add streaming mode(beginStream(), pollStream(), readStream()..)
+ *		R1.4  2026.10.19  Add array version of toRaw()/tomg() and tog()(integer only)
+ *		R1.5  2026.10.19  Move common functions into acccore library(AccCore), LIS2DW is derived from it
+ *		R1.6  2026.10.19  Add motion event engine(setWakeUp(), setTap(), setFreeFall(), set6D(), setSleep() and event queue)
  *
  *	Note:
  *		LIS2DW is a 14bit ADC 3-Axis MEMS Accelerometer made by STmaicro.
@@ -16,89 +22,229 @@
 
 /*
  *	Public methods
+ *		Other methods are defined in AccCore(acccore.h)
  */
 
-LIS2DW::LIS2DW(int sa0) {
-	if (sa0)
-		_i2cAddress = 0x19;
-	else
-		_i2cAddress = 0x18;
+int LIS2DW::beginStream(int16_t buffer[], int samples, int threshold) {
+	if (threshold < 1 || threshold > FIFOThreshold::MAX)
+		return (-1);	// bad parameter
+
+	endStream();		// FIFO is cleared in bypass mode
+	if (startStream(buffer, samples) != 0)
+		return (-1);	// bad parameter
+
+	// Continuous mode with threshold, and route threshold interrupt to INT1
+	stageRegister(s2REG_FIFO_CTRL, 0xff, s2FMODE_CONTINUOUS | FIFOThreshold::encode(threshold));
+	stageRegister(s2REG_CTRL4_INT1_PAD_CTRL, s2CTRL4_INT1_FTH, s2CTRL4_INT1_FTH);
+	return (applyConfig());		// 0: OK
+}
+
+void LIS2DW::endStream(void) {
+	stageRegister(s2REG_CTRL4_INT1_PAD_CTRL, s2CTRL4_INT1_FTH, 0);
+	stageRegister(s2REG_FIFO_CTRL, 0xff, FIFOMode::bits<s2FMODE_BYPASS>());
+	applyConfig();
+	stopStream();
 }
 
-uint8_t LIS2DW::readRegister(uint8_t reg) {
-	Wire.beginTransmission(_i2cAddress);
-	Wire.write(reg);
-	Wire.endTransmission(false); 	// uses repeated start
-    Wire.requestFrom(_i2cAddress, (uint8_t)1);
-    if (! Wire.available())
-		return (0xff);		// error
-    return (Wire.read());
+int LIS2DW::setWakeUp(int threshold, int duration) {
+	if (threshold < 0 || duration < 0)
+		return (-1);	// bad parameter
+
+	// 1 LSB of threshold is FS/64, and 1 LSB of duration is 1/ODR
+	int ths = (threshold == 0) ? 0 : ((long)threshold * 64 + fullScale() / 2) / fullScale();
+	stageField<WakeUpThreshold>((threshold > 0 && ths == 0) ? 1 : ths);
+	stageField<WakeUpDuration>(toODRs(duration, 1));
+	routeINT1(s2CTRL4_INT1_WU, threshold > 0);
+	return (applyConfig());		// 0: OK
+}
+
+int LIS2DW::setTap(int threshold, uint8_t axes, bool doubleTap) {
+	if (threshold < 0 || (threshold > 0 && (axes & (s2AXIS_X | s2AXIS_Y | s2AXIS_Z)) == 0))
+		return (-1);	// bad parameter
+
+	// 1 LSB of threshold is FS/32
+	int ths = ((long)threshold * 32 + fullScale() / 2) / fullScale();
+	if (threshold > 0 && ths == 0)
+		ths = 1;
+	stageField<TapThresholdX>(ths);
+	stageField<TapThresholdY>(ths);
+	stageField<TapThresholdZ>(ths);
+	uint8_t enable = 0;
+	if (threshold > 0) {
+		enable |= (axes & s2AXIS_X) ? s2TAP_THS_Z_TAP_X_EN : 0;
+		enable |= (axes & s2AXIS_Y) ? s2TAP_THS_Z_TAP_Y_EN : 0;
+		enable |= (axes & s2AXIS_Z) ? s2TAP_THS_Z_TAP_Z_EN : 0;
+	}
+	stageRegister(s2REG_TAP_THS_Z, s2TAP_THS_Z_TAP_X_EN | s2TAP_THS_Z_TAP_Y_EN | s2TAP_THS_Z_TAP_Z_EN, enable);
+	stageRegister(s2REG_WAKE_UP_THS, s2WAKE_UP_THS_SINGLE_DOUBLE_TAP, (threshold > 0 && doubleTap) ? s2WAKE_UP_THS_SINGLE_DOUBLE_TAP : 0);
+	routeINT1(s2CTRL4_INT1_SINGLE_TAP, threshold > 0);
+	routeINT1(s2CTRL4_INT1_TAP, threshold > 0 && doubleTap);
+	return (applyConfig());		// 0: OK
 }
 
-void LIS2DW::readMultiRegisters(uint8_t reg, int bytes, uint8_t data[]) {
-	uint8_t reg2 = readRegister(s2REG_CTRL2);
+int LIS2DW::setTapTiming(int shock, int quiet, int latency) {
+	if (shock < 0 || quiet < 0 || latency < 0)
+		return (-1);	// bad parameter
+
+	// 1 LSB is 8/ODR(shock), 4/ODR(quiet) and 32/ODR(latency), 0 means 4/ODR, 2/ODR and 16/ODR
+	stageField<TapShock>(toODRs(shock, 8));
+	stageField<TapQuiet>(toODRs(quiet, 4));
+	stageField<TapLatency>(toODRs(latency, 32));
+	return (applyConfig());		// 0: OK
+}
 
-	Wire.beginTransmission(_i2cAddress);
-    Wire.write(s2REG_CTRL2);
-	Wire.write(reg2 | s2CTRL2_IF_ADD_INC);
-    Wire.endTransmission();
+int LIS2DW::setFreeFall(int threshold, int duration) {
+	static const uint8_t thresholds[8] = { 5, 7, 8, 10, 11, 13, 15, 16 };	// [FS/64]
+	if (threshold < 0 || duration < 0)
+		return (-1);	// bad parameter
 
-	Wire.beginTransmission(_i2cAddress);
-    Wire.write(reg); 	// 0x80 for autoincrement
-    Wire.endTransmission();
+	// Select the nearest threshold, and 1 LSB of duration(6-bit, FF_DUR5 is the MSB) is 1/ODR
+	int code = 0;
+	for (int i = 1; i < 8; i++) {
+		if (abs((long)thresholds[i] * fullScale() / 64 - threshold) < abs((long)thresholds[code] * fullScale() / 64 - threshold))
+			code = i;
+	}
+	uint32_t dur = toODRs(duration, 1);
+	if (dur > 0x3f)
+		dur = 0x3f;
+	stageField<FreeFallThreshold>(code);
+	stageField<FreeFallDuration>(dur & 0x1f);
+	stageRegister(s2REG_WAKE_UP_DUR, s2WAKE_UP_DUR_FF_DUR5, (dur & 0x20) ? s2WAKE_UP_DUR_FF_DUR5 : 0);
+	routeINT1(s2CTRL4_INT1_FF, threshold > 0);
+	return (applyConfig());		// 0: OK
+}
 
-    Wire.requestFrom(_i2cAddress, (uint8_t)bytes);
-	while (bytes-- > 0) {
-		if (! Wire.available())
-			*data++ = 0xff;			// read error
-		else
-			*data++ = Wire.read();
+int LIS2DW::set6D(int angle) {
+	uint8_t ths;
+	switch (angle) {
+	case 0:
+	case 80:
+		ths = s2_6D_THS_80;
+		break;
+	case 70:
+		ths = s2_6D_THS_70;
+		break;
+	case 60:
+		ths = s2_6D_THS_60;
+		break;
+	case 50:
+		ths = s2_6D_THS_50;
+		break;
+	default:
+		return (-1);	// bad parameter
 	}
 
-	Wire.beginTransmission(_i2cAddress);
-    Wire.write(s2REG_CTRL2);
-	Wire.write(reg2 & ~s2CTRL2_IF_ADD_INC);
-    Wire.endTransmission();
+	stageRegister(s2REG_TAP_THS_X, s2TAP_THS_X_6D_THS_MASK | s2TAP_THS_X_4D_EN, ths);	// 6D(not 4D)
+	routeINT1(s2CTRL4_INT1_6D, angle > 0);
+	return (applyConfig());		// 0: OK
 }
 
-void LIS2DW::writeRegister(uint8_t reg, uint8_t data) {
-	Wire.beginTransmission(_i2cAddress);
-	Wire.write(reg);
-	Wire.write(data);
-	Wire.endTransmission();
+int LIS2DW::setSleep(int duration) {
+	if (duration < 0)
+		return (-1);	// bad parameter
+
+	// 1 LSB of duration is 512/ODR, 0 means 16/ODR. Sleep change is routed to INT1 through INT2
+	stageField<SleepDuration>(toODRs(duration, 512));
+	stageRegister(s2REG_WAKE_UP_THS, s2WAKE_UP_THS_SLEEP_ON, (duration > 0) ? s2WAKE_UP_THS_SLEEP_ON : 0);
+	stageRegister(s2REG_CTRL5_INT2_PAD_CTRL, s2CTRL5_INT2_SLEEP_CHG, (duration > 0) ? s2CTRL5_INT2_SLEEP_CHG : 0);
+	stageRegister(s2REG_CTRL7, s2CTRL7_INT2_ON_INT1, (duration > 0) ? s2CTRL7_INT2_ON_INT1 : 0);
+	routeINT1(0, duration > 0);
+	return (applyConfig());		// 0: OK
 }
 
-int LIS2DW::getAccelerations(int *ax, int *ay, int *az) {
-	uint8_t data[6];
-	for (int i = 0; i < 6; i++)
-		data[i] = 0;
-	readMultiRegisters(s2REG_OUT_X_L, 6, data);
-	*ax = toRaw(data[1], data[0]);
-	*ay = toRaw(data[3], data[2]);
-	*az = toRaw(data[5], data[4]);
+int LIS2DW::pollEvents(void) {
+	if (! _event)
+		return (0);		// nothing to do(no I2C transaction)
+	_event = false;		// set again if interrupt occurs while reading
 
-	return 0;	// OK
+	// STATUS_DUP, WAKE_UP_SRC, TAP_SRC, SIXD_SRC and ALL_INT_SRC by one burst, ALL_INT_SRC is read at last(clears INT1)
+	uint8_t src[5];
+	readMultiRegisters(s2REG_STATUS_DUP, sizeof(src), src);
+	uint32_t time = now();
+	uint8_t wakeUp = src[1], tap = src[2], sixD = src[3], all = src[4];
+	if (all == 0xff)
+		return (0);		// read error
+	int count = availableEvents();
+
+	if (all & s2INT_SRC_WU_IA) {
+		uint8_t axis = ((wakeUp & s2WAKE_UP_SRC_X_WU) ? s2AXIS_X : 0) | ((wakeUp & s2WAKE_UP_SRC_Y_WU) ? s2AXIS_Y : 0)
+			| ((wakeUp & s2WAKE_UP_SRC_Z_WU) ? s2AXIS_Z : 0);
+		pushEvent(time, s2EVENT_WAKE_UP, axis, 0);
+	}
+	if (all & (s2INT_SRC_SINGLE_TAP | s2INT_SRC_DOUBLE_TAP)) {
+		uint8_t axis = ((tap & s2TAP_SRC_X_TAP) ? s2AXIS_X : 0) | ((tap & s2TAP_SRC_Y_TAP) ? s2AXIS_Y : 0)
+			| ((tap & s2TAP_SRC_Z_TAP) ? s2AXIS_Z : 0);
+		int8_t sign = (tap & s2TAP_SRC_TAP_SIGN) ? -1 : 1;
+		if (all & s2INT_SRC_SINGLE_TAP)
+			pushEvent(time, s2EVENT_SINGLE_TAP, axis, sign);
+		if (all & s2INT_SRC_DOUBLE_TAP)
+			pushEvent(time, s2EVENT_DOUBLE_TAP, axis, sign);
+	}
+	if (all & s2INT_SRC_FF_IA)
+		pushEvent(time, s2EVENT_FREE_FALL, 0, 0);
+	if (all & s2INT_SRC_6D_IA) {
+		// One of XL..ZH is set for the axis pointing up(H) or down(L)
+		static const uint8_t axes[3] = { s2AXIS_X, s2AXIS_Y, s2AXIS_Z };
+		for (int i = 0; i < 3; i++) {
+			if (sixD & (s2SIXD_SRC_XH << (i * 2)))
+				pushEvent(time, s2EVENT_6D, axes[i], 1);
+			else if (sixD & (s2SIXD_SRC_XL << (i * 2)))
+				pushEvent(time, s2EVENT_6D, axes[i], -1);
+		}
+	}
+	if (all & s2INT_SRC_SLEEP_CHANGE_IA)
+		pushEvent(time, (wakeUp & s2WAKE_UP_SRC_SLEEP_STATE_IA) ? s2EVENT_SLEEP : s2EVENT_ACTIVE, 0, 0);
+
+	return (availableEvents() - count);		// return number of queued events
+}
+
+bool LIS2DW::readEvent(LIS2DWEvent *event) {
+	uint8_t tail = _eventTail;
+	if (tail == _eventHead)
+		return (false);		// no event
+	accBARRIER();
+
+	*event = _events[tail & (s2EVENT_QUEUE_SIZE - 1)];
+	accBARRIER();
+	_eventTail = tail + 1;	// release after copied
+
+	return (true);
+}
+
+/*
+ *	Private methods
+ */
+
+uint32_t LIS2DW::toODRs(uint32_t ms, uint32_t unit) {
+	uint32_t period = LIS2DWMap::samplePeriod(getShadowRegister(s2REG_CTRL1)) * unit;	// [uS]
+	if (period == 0)
+		return (0);		// ODR is unknown
+	return ((uint32_t)(((uint64_t)ms * 1000 + period / 2) / period));
+}
+
+void LIS2DW::routeINT1(uint8_t bit, bool enable) {
+	if (bit != 0)
+		stageRegister(s2REG_CTRL4_INT1_PAD_CTRL, bit, enable ? bit : 0);
+	if (enable) {
+		stageRegister(s2REG_CTRL3, s2CTRL3_LIR, s2CTRL3_LIR);		// sources are kept until pollEvents() reads them
+		stageRegister(s2REG_CTRL7, s2CTRL7_INTERRUPTS_ENABLE, s2CTRL7_INTERRUPTS_ENABLE);
+	}
 }
 
-int LIS2DW::readFIFO(int samples[], int numSamples) {
-	int m, n;
-	for (m = n = 0; m < numSamples; n += 3, m++) {
-		Wire.beginTransmission(_i2cAddress);
-		Wire.write(s2REG_OUT_X_L);
-		Wire.endTransmission(false); 	// uses repeated start
-		Wire.requestFrom(_i2cAddress, (uint8_t)6);
-		int16_t low = Wire.read() & 0xff;
-		int16_t high =  (int16_t)Wire.read();
-		samples[n] = ((high << 8) + low) >> 2;		// X-axis
-		low = Wire.read() & 0xff;
-		high = (int16_t)Wire.read();
-		samples[n+1] = ((high << 8) + low) >> 2;	// Y-axis
-		low = Wire.read() & 0xff;
-		high = (int16_t)Wire.read();
-		samples[n+2] = ((high << 8) + low) >> 2;	// Z-axis
+void LIS2DW::pushEvent(uint32_t time, uint8_t type, uint8_t axis, int8_t sign) {
+	uint8_t head = _eventHead;
+	if ((uint8_t)(head - _eventTail) >= s2EVENT_QUEUE_SIZE) {
+		_eventOverruns++;	// queue is full, discard the new one
+		return;
 	}
 
-	return (m);		// return number of read samples
+	LIS2DWEvent *event = &_events[head & (s2EVENT_QUEUE_SIZE - 1)];
+	event->time = time;
+	event->type = type;
+	event->axis = axis;
+	event->sign = sign;
+	accBARRIER();
+	_eventHead = head + 1;	// publish after written
 }
 
 // End of "lis2dw.cpp"
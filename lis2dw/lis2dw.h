@@ -5,6 +5,14 @@
  *
  *	Version:
  *		R1.0  2021.04.30
+ *		R1.1  2026.10.19  Add readFIFOBurst()(drain FIFO by burst transfer)
+ *		R1.2  2026.10.19  Keep shadow of control registers, add updateRegister(), stageRegister() and applyConfig()
+ *		R1.3  2026.10.19  Add streaming mode(FIFO threshold interrupt and sample ring)
+ *		R1.4  2026.10.19  Add array version of toRaw()/tomg() and tog()(integer only)
+ *		R1.5  2026.10.19  LIS2DW is derived from AccCore(acccore library), add register fields
+ *		R1.6  2026.10.19  Add ODR of CTRL1 to register map(time of each sample drained from FIFO)
+ *		R1.7  2026.10.19  Add motion event engine(wake-up, tap, free-fall, 6D and sleep change, event queue),
+ *		                  fix masks of FREE_FALL, WAKE_UP_SRC and CTRL5 registers
  *
  *	Note:
  *		LIS2DW is a 14bit ADC 3-Axis MEMS Accelerometer made by STmicro.
@@ -17,6 +25,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include <acccore.h>
 /*
  *	Constants
  */
@@ -24,6 +33,38 @@
 		/* The "sample" is defined as one acceleration of three axis.
 		   That is, the XYZ set of accelerations is assumed to be one samples.
 		 */
+#ifndef s2I2C_BUFFER_SIZE
+#if defined(ARDUINO_ARCH_SAMD)
+#define	s2I2C_BUFFER_SIZE		256			// Size of Wire receive buffer(SAMD)
+#else
+#define	s2I2C_BUFFER_SIZE		32			// Size of Wire receive buffer(AVR and others)
+#endif
+#endif
+#define	s2BURST_SAMPLES			(AccCore<LIS2DWMap>::BURST_SAMPLES)
+		/* Samples read by one I2C transaction(6 bytes per sample) */
+#define	s2SHADOW_BASE			0x20		// First register kept in shadow(CTRL1)
+#define	s2SHADOW_REGS			32			// Number of registers kept in shadow(CTRL1..CTRL7)
+#define	s2SHADOW_WRITABLE		0xf07f403fUL	// Writable registers in shadow(bit n is register s2SHADOW_BASE+n)
+		/* Shadow is a copy of the writable control registers, so that changing bits of them
+		   needs only one write(no read). Read only registers(OUT_*, STATUS, *_SRC..) are not kept.
+		 */
+#ifndef s2STREAM_BLOCKS
+#define	s2STREAM_BLOCKS			16			// Number of blocks kept in stream ring(power of 2)
+#endif
+		/* In streaming mode, the FIFO threshold interrupt only sets a flag(onWatermark()), and pollStream()
+		   drains FIFO into the sample ring given by beginStream(). Samples drained at once are a "block",
+		   and readStream() returns them with the time of the samples(AccBatch).
+		   pollStream() is the only producer and readStream() is the only consumer of the ring, so that
+		   they can be called from different contexts(ex. yield() while the modem is busy and loop())
+		   without disabling interrupts.
+		 */
+#ifndef s2EVENT_QUEUE_SIZE
+#define	s2EVENT_QUEUE_SIZE		8			// Number of events kept in queue(power of 2)
+#endif
+		/* Motion events are detected by LIS2DW itself, and INT1 goes active only for them.
+		   The interrupt handler only sets a flag(onEvent()), and pollEvents() reads the sources and
+		   queues decoded events, readEvent() returns them in order, as the streaming mode.
+		 */
 
 /*
  *	Register Address
@@ -130,14 +171,14 @@
 #define s2CTRL4_INT1_DRDY           0x01        // Data-Ready is routed to INT1 pad(0:disable/1:enable) - 0
 
 // REG_CTRL5_INT2_PAD_CTRL
-#define s2CTRL5_INT2_SLEEP_STATE    0x08        // Enable routing of SLEEP_STATE on INT2 pad(0:disable/1:enable) - 0
-#define s2CTRL5_INT2_SLEEP_CHG      0x04        // Sleep change status routed to INT2 pad(0:disable/1:enable) - 0
-#define s2CTRL5_INT2_BOOT           0x02        // Boot state routed to INT2 pad(0:disable/1:enable) - 0
+#define s2CTRL5_INT2_SLEEP_STATE    0x80        // Enable routing of SLEEP_STATE on INT2 pad(0:disable/1:enable) - 0
+#define s2CTRL5_INT2_SLEEP_CHG      0x40        // Sleep change status routed to INT2 pad(0:disable/1:enable) - 0
+#define s2CTRL5_INT2_BOOT           0x20        // Boot state routed to INT2 pad(0:disable/1:enable) - 0
 #define s2CTRL5_INT2_DRDY_T         0x10        // Temperature data-ready is routed to INT2(0:disable/1:enable) - 0
-#define s2CTRL5_INT2_OVR            0x80        // FIFO overrun interrupt is routed to INT2 pad(0:disable/1:enable) - 0
-#define s2CTRL5_INT2_DIFF5          0x40        // FIFO full recognition is routed to INT2 pad(0:disable/1:enable) - 0
+#define s2CTRL5_INT2_OVR            0x08        // FIFO overrun interrupt is routed to INT2 pad(0:disable/1:enable) - 0
+#define s2CTRL5_INT2_DIFF5          0x04        // FIFO full recognition is routed to INT2 pad(0:disable/1:enable) - 0
 #define s2CTRL5_INT2_FTH            0x02        // FIFO threshold interrupt is routed to INT2 pad(0:disable/1:enable) - 0
-#define s2CTRL5_INT2_DRDY           0x00        // Data-ready is routed to INT2 pad(0:disable/1:enable) - 0
+#define s2CTRL5_INT2_DRDY           0x01        // Data-ready is routed to INT2 pad(0:disable/1:enable) - 0
 
 // REG_CTRL6(Table 42)
 #define s2CTRL6_BW_FILT_MASK        0xc0        // Bandwidth selection(see s2BW_FILT_*) - 00
@@ -180,9 +221,25 @@
 #define s2FIFO_SAMPLES_FIFO_OVR     0x40        // FIFO overrun status(0:FIFO is not completely filled/1:FIFO is completely filled and at least one sample has been overwritten)
 #define s2FIFO_SAMPLES_DIFF_MASK    0x3f        // Represents the number of unread samples stored in FIFO(000000:FIFO empty/100000:FIFO full, 32 unread samples)
 
-// REG_TAP_THS_X
-// REG_TAP_THS_Y
-// REG_TAP_THS_Z
+// REG_TAP_THS_X(Table 63)
+#define s2TAP_THS_X_4D_EN           0x80        // 4D detection portrait/landscape position enable(0:6D/1:4D, Z-axis is not detected) - 0
+#define s2TAP_THS_X_6D_THS_MASK     0x60        // Threshold angle for 4D/6D function(s2_6D_THS_*) - 00
+#define s2TAP_THS_X_TAP_THSX_MASK   0x1f        // Threshold for tap recognition on X-axis(1 LSB = FS/32) - 00000
+  // Threshold angle for 4D/6D
+#define s2_6D_THS_80                0x00        // 80 degrees
+#define s2_6D_THS_70                0x20        // 70 degrees
+#define s2_6D_THS_60                0x40        // 60 degrees
+#define s2_6D_THS_50                0x60        // 50 degrees
+
+// REG_TAP_THS_Y(Table 65)
+#define s2TAP_THS_Y_TAP_PRIOR_MASK  0xe0        // Selection of priority axis for tap detection - 000(X > Y > Z)
+#define s2TAP_THS_Y_TAP_THSY_MASK   0x1f        // Threshold for tap recognition on Y-axis(1 LSB = FS/32) - 00000
+
+// REG_TAP_THS_Z(Table 67)
+#define s2TAP_THS_Z_TAP_X_EN        0x80        // Enables X-axis in tap recognition(0:disable/1:enable) - 0
+#define s2TAP_THS_Z_TAP_Y_EN        0x40        // Enables Y-axis in tap recognition(0:disable/1:enable) - 0
+#define s2TAP_THS_Z_TAP_Z_EN        0x20        // Enables Z-axis in tap recognition(0:disable/1:enable) - 0
+#define s2TAP_THS_Z_TAP_THSZ_MASK   0x1f        // Threshold for tap recognition on Z-axis(1 LSB = FS/32) - 00000
 
 // REG_INT_DUR(Table 69)
 #define s2INT_DUR_LATENCY_MASK      0xf0        // Duration of maximum time gap for double-tap recognition(1 LSB = 32 * 1/ODR) - 0000(which is 16 * 1/ODR)
@@ -201,8 +258,8 @@
 #define s2WAKE_UP_DUR_SLEEP_DUR_MASK 0x0f       // Duration to go in sleep mode(1 LSB = 512 * 1/ODR) - 0000(which is 16 * 1/ODR)
 
 // REG_FREE_FALL(Table 75)
-#define s2FREE_FALL_FF_DUR_MASK     0xf0        // Free-fall duration. In conjunction with FF_DUR5 bit(1 LSB = 1 * 1/ODR)
-#define s2FREE_FALL_FF_THS_MASK     0x0f        // Free-fall threshold @ FS = ±2 g (Table 77)
+#define s2FREE_FALL_FF_DUR_MASK     0xf8        // Free-fall duration. In conjunction with FF_DUR5 bit(1 LSB = 1 * 1/ODR)
+#define s2FREE_FALL_FF_THS_MASK     0x07        // Free-fall threshold(Table 77, 5,7,8,10,11,13,15,16 LSB of FS/64)
 
 // REG_STATUS_DUP(Table 78)
 #define s2STATUS_DUP_OVR            0x80        // FIFO overrun status flag(0:FIFO is not completely filled/1:FIFO is completely filled and at least one sample has been overwritten)
@@ -217,10 +274,10 @@
 // REG_WAKE_UP_SRC(Table 80)
 #define s2WAKE_UP_SRC_FF_IA         0x20        // Free-fall event detection status(0:FF event not detected/1:FF event detected)
 #define s2WAKE_UP_SRC_SLEEP_STATE_IA 0x10       // Sleep event status(0:Sleep event not detected/1:Sleep event detected)
-#define s2WAKE_UP_SRC_WU_IA         0x80        // Wakeup event detection status(0:Wakeup event not detected/1:Wakeup event is detected)
-#define s2WAKE_UP_SRC_X_WU          0x40        // Wakeup event detection status on X-axis(0:Wakeup event on X not detected/1:Wakeup event on X-axis is detected)
-#define s2WAKE_UP_SRC_Y_WU          0x20        // Wakeup event detection status on Y-axis(0:Wakeup event on Y not detected/1:Wakeup event on Y-axis is detected)
-#define s2WAKE_UP_SRC_Z_WU          0x10        // Wakeup event detection status on Z-axis(0:Wakeup event on Z not detected/1:Wakeup event on Z-axis is detected)
+#define s2WAKE_UP_SRC_WU_IA         0x08        // Wakeup event detection status(0:Wakeup event not detected/1:Wakeup event is detected)
+#define s2WAKE_UP_SRC_X_WU          0x04        // Wakeup event detection status on X-axis(0:Wakeup event on X not detected/1:Wakeup event on X-axis is detected)
+#define s2WAKE_UP_SRC_Y_WU          0x02        // Wakeup event detection status on Y-axis(0:Wakeup event on Y not detected/1:Wakeup event on Y-axis is detected)
+#define s2WAKE_UP_SRC_Z_WU          0x01        // Wakeup event detection status on Z-axis(0:Wakeup event on Z not detected/1:Wakeup event on Z-axis is detected)
 
 // REG_TAP_SRC(Table 82)
 #define s2TAP_SRC_TAP_IA            0x40        // Tap event status(0:tap event not detected/1:tap event detected)
@@ -258,39 +315,124 @@
 #define s2CTRL7_HP_REF_MODE         0x02        // High-pass filter reference mode enable(0:high-pass filter reference mode disabled/1:high-pass filter reference mode enabled) - 0
 #define s2CTRL7_LPASS_ON6D          0x01        // (0:ODR/2 low pass filtered data sent to 6D interrupt function/1:LPF2 output data sent to 6D interrupt function) - 0
 
+/*
+ *	Motion events
+ */
+  // Type of event(LIS2DWEvent.type)
+#define s2EVENT_WAKE_UP             1           // Acceleration exceeded the wake-up threshold(axis)
+#define s2EVENT_SINGLE_TAP          2           // Single tap(axis and sign)
+#define s2EVENT_DOUBLE_TAP          3           // Double tap(axis and sign)
+#define s2EVENT_FREE_FALL           4           // Free-fall
+#define s2EVENT_6D                  5           // Orientation changed(axis and sign pointing up)
+#define s2EVENT_SLEEP               6           // Changed to sleep(inactive) state
+#define s2EVENT_ACTIVE              7           // Changed from sleep to active state
+  // Axis of event(LIS2DWEvent.axis)
+#define s2AXIS_X                    0x01
+#define s2AXIS_Y                    0x02
+#define s2AXIS_Z                    0x04
+
+typedef struct {
+	uint32_t	time;				// Time when the event was read [uS](same clock as AccBatch)
+	uint8_t	type;					// s2EVENT_*
+	uint8_t	axis;					// s2AXIS_* bits(0 if not applicable)
+	int8_t	sign;					// +1/-1(0 if not applicable)
+} LIS2DWEvent;
+
+
+/*
+ *	Register map(used by AccCore)
+ */
+struct LIS2DWMap {
+	static constexpr uint8_t OUT_REG = s2REG_OUT_X_L;		// X(L,H), Y(L,H), Z(L,H)
+	static constexpr bool MSB_FIRST = false;
+	static constexpr uint8_t AXIS_X = 0, AXIS_Y = 1, AXIS_Z = 2;
+	static constexpr int RESOLUTION = 14;					// 12-bit in low power mode 1 is also left-justified
+	static constexpr uint32_t LSB_PER_G = 4096;				// @+/-2g
+	static constexpr int rangeIndex(int range) {
+		return ((range == s2FS_2G) ? 0 : (range == s2FS_4G) ? 1 : (range == s2FS_8G) ? 2 : 3);
+	}														// 0:2g, 1:4g, 2:8g, 3:16g(others)
+	static constexpr int FIFO_SAMPLES = s2MAX_FIFO_SAMPLES;
+	static constexpr uint8_t FIFO_STATUS_REG = s2REG_FIFO_SMPLES;
+	static constexpr uint8_t FIFO_COUNT_MASK = s2FIFO_SAMPLES_DIFF_MASK;
+	static constexpr uint8_t FIFO_OVERRUN = s2FIFO_SAMPLES_FIFO_OVR;
+	static constexpr uint8_t INC_REG = s2REG_CTRL2, INC_BIT = s2CTRL2_IF_ADD_INC;
+	static constexpr uint8_t RESET_REG = s2REG_CTRL2, RESET_BITS = s2CTRL2_SOFT_RESET | s2CTRL2_BOOT;
+	static constexpr uint8_t STANDBY_REG = 0, ACTIVE_BIT = 0;	// registers can be changed in any mode
+	static constexpr uint8_t SHADOW_BASE = s2SHADOW_BASE;
+	static constexpr int SHADOW_REGS = s2SHADOW_REGS;
+	static constexpr uint64_t SHADOW_WRITABLE = s2SHADOW_WRITABLE;
+	static constexpr int I2C_BUFFER_SIZE = s2I2C_BUFFER_SIZE;
+	static constexpr int STREAM_BLOCKS = s2STREAM_BLOCKS;
+	static constexpr uint8_t ODR_REG = s2REG_CTRL1;
+	static uint32_t samplePeriod(uint8_t ctrl1) {
+		static const uint32_t period[10] = { 0, 80000, 80000, 40000, 20000, 10000, 5000, 2500, 1250, 625 };	// HP
+		int odr = (ctrl1 & s2CTRL1_ODR_MASK) >> 4;
+		int mode = ctrl1 & s2CTRL1_MODE_MASK;
+		if (odr > 9 || mode == s2MODE_SINGLE_ON_DEMAND || mode == s2MODE_LOW_RESERVED)
+			return (0);
+		if (mode == s2MODE_LOW_POWER && odr == 1)
+			return (625000);		// 1.6Hz
+		if (mode == s2MODE_LOW_POWER && odr > 6)
+			return (5000);			// 200Hz at most
+		return (period[odr]);
+	}														// Sample period of CTRL1 [uS](0 if not sampling)
+};
 
 /*
  *	LIS2DW class
  */
-class LIS2DW {
-  public:	LIS2DW(int sa0 = HIGH);						// Constructor with SA0
-	uint8_t readRegister(uint8_t reg);				// Read byte data from a register
-	void readMultiRegisters(uint8_t reg, int bytes, uint8_t data[]);	// Read multi bytes data from registers
-	void writeRegister(uint8_t reg, uint8_t data);	// Write byte data to a register
-	int getAccelerations(int *ax, int *ay, int *az); // Get 3-axis accelerations(12/14-bit)
-	int getFIFOEntries(void) __attribute__((always_inline)) {
-		return ((readRegister(s2REG_FIFO_SMPLES) & s2FIFO_SAMPLES_DIFF_MASK));
-	}                                               // Get number of Samples exist in FIFO
-	int readFIFO(int samples[], int numSamples);	// Read data from FIFO
-	int toRaw(uint8_t high, uint8_t low) __attribute__((always_inline)) {
-		int8_t signedHigh = high;
-		return ((((int)signedHigh << 8) + low) >> 2);
-	}                                               // Convert to 14-bit acceleration
-    int tomg(int raw, int range) __attribute__((always_inline)) {
-		switch (range) {
-          case s2FS_2G:
-			return (raw / 4.096);	// 4096 LSB/g @+/-2g
-		  case s2FS_4G:
-			return (raw / 2.048);	// 2048 LSB/g @+/-4g
-		  case s2FS_8G:
-			return (raw / 1.024);	// 1024 LSB/g @+/-8g
-          default: // s2FS_16G
-            return (raw / 0.512);	// 512 LSB/g @+/-8g
-        }
-	}                                               // Convert raw(14-bit) to mg(~gal)
+class LIS2DW : public AccCore<LIS2DWMap> {
+  public:
+	LIS2DW(int sa0 = HIGH) : AccCore<LIS2DWMap>(sa0 ? 0x19 : 0x18) { _event = false; _eventHead = _eventTail = 0; _eventOverruns = 0; }	// Constructor with SA0
+	int beginStream(int16_t buffer[], int samples, int threshold);	// Start streaming into ring(buffer[] has 3 * samples, samples is power of 2)
+	void endStream(void);							// Stop streaming
+		/* Motion events(thresholds in mg and durations in mS are converted at current FS and ODR, set them first)
+		   Each detector is routed to INT1 when enabled(threshold > 0), and interrupts are latched until read.
+		 */
+	int setWakeUp(int threshold, int duration = 0);	// Wake-up threshold [mg](0: disable) and duration [mS]
+	int setTap(int threshold, uint8_t axes = s2AXIS_X | s2AXIS_Y | s2AXIS_Z, bool doubleTap = false);
+													// Tap threshold [mg](0: disable), axes(s2AXIS_* bits) and double tap
+	int setTapTiming(int shock, int quiet, int latency);	// Maximum shock, quiet time after tap and maximum gap of double tap [mS]
+	int setFreeFall(int threshold, int duration);	// Free-fall threshold [mg](0: disable, 156..500 at 2g) and duration [mS]
+	int set6D(int angle);							// Orientation threshold [degree](50, 60, 70, 80, 0: disable)
+	int setSleep(int duration);						// Inactivity to go to sleep [mS](0: disable), ODR is lowered in sleep
+	void onEvent(void) { _event = true; }			// Call from INT1 interrupt handler(no I2C transaction)
+	int pollEvents(void);							// Read sources and queue events if interrupted(call from loop())
+	int availableEvents(void) { return ((uint8_t)(_eventHead - _eventTail)); }	// Number of events in queue
+	bool readEvent(LIS2DWEvent *event);				// Read the oldest event from queue
+	uint32_t getEventOverruns(void) { return _eventOverruns; }	// Number of events discarded because queue was full
+	//-- Other methods are defined in AccCore(acccore.h)
+
+	// Register fields(ex. acc.updateField<LIS2DW::FullScale>(1), LIS2DW::FIFOThreshold::field<16>())
+	typedef AccField<s2REG_CTRL1, s2CTRL1_ODR_MASK>				ODR;
+	typedef AccField<s2REG_CTRL1, s2CTRL1_MODE_MASK>			Mode;
+	typedef AccField<s2REG_CTRL1, s2CTRL1_LP_MODE_MASK>			LowPowerMode;
+	typedef AccField<s2REG_CTRL6, s2CTRL6_BW_FILT_MASK>			Bandwidth;
+	typedef AccField<s2REG_CTRL6, s2CTRL6_FS_MASK>				FullScale;
+	typedef AccField<s2REG_FIFO_CTRL, s2FIFO_CTRL_FMODE_MASK>	FIFOMode;
+	typedef AccField<s2REG_FIFO_CTRL, s2FIFO_CTRL_FTH_MASK>		FIFOThreshold;
+	typedef AccField<s2REG_WAKE_UP_THS, s2WAKE_UP_THS_WK_THS_MASK>	WakeUpThreshold;
+	typedef AccField<s2REG_WAKE_UP_DUR, s2WAKE_UP_DUR_WAKE_DUR_MASK>	WakeUpDuration;
+	typedef AccField<s2REG_WAKE_UP_DUR, s2WAKE_UP_DUR_SLEEP_DUR_MASK>	SleepDuration;
+	typedef AccField<s2REG_TAP_THS_X, s2TAP_THS_X_TAP_THSX_MASK>	TapThresholdX;
+	typedef AccField<s2REG_TAP_THS_Y, s2TAP_THS_Y_TAP_THSY_MASK>	TapThresholdY;
+	typedef AccField<s2REG_TAP_THS_Z, s2TAP_THS_Z_TAP_THSZ_MASK>	TapThresholdZ;
+	typedef AccField<s2REG_TAP_THS_X, s2TAP_THS_X_6D_THS_MASK>		SixDThreshold;
+	typedef AccField<s2REG_INT_DUR, s2INT_DUR_SHOCK_MASK>			TapShock;
+	typedef AccField<s2REG_INT_DUR, s2INT_DUR_QUIET_MASK>			TapQuiet;
+	typedef AccField<s2REG_INT_DUR, s2INT_DUR_LATENCY_MASK>			TapLatency;
+	typedef AccField<s2REG_FREE_ALL, s2FREE_FALL_FF_THS_MASK>		FreeFallThreshold;
+	typedef AccField<s2REG_FREE_ALL, s2FREE_FALL_FF_DUR_MASK>		FreeFallDuration;
 
   private:
-	uint8_t	_i2cAddress;
+	volatile bool	_event;				// INT1 interrupt occurred
+	LIS2DWEvent	_events[s2EVENT_QUEUE_SIZE];	// Event queue
+	volatile uint8_t	_eventHead, _eventTail;	// Events written(by pollEvents())/read(by readEvent())
+	uint32_t	_eventOverruns;
+	int fullScale(void) { return (2000 << FullScale::decode(getShadowRegister(s2REG_CTRL6))); }	// FS [mg]
+	uint32_t toODRs(uint32_t ms, uint32_t unit);	// Convert mS to count of "unit"/ODR(rounded, 0 if ODR is unknown)
+	void routeINT1(uint8_t bit, bool enable);		// Route a detector to INT1, and enable latched interrupts
+	void pushEvent(uint32_t time, uint8_t type, uint8_t axis, int8_t sign);
 };
 
 #endif // _LIS2DW_
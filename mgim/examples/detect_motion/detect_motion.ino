@@ -7,6 +7,7 @@
  *  For continuous monitoring, the ODR is measured at 100 Hz, the measurement range is +/- 2g,
  *  low noise, and 14-bit.
  *  The MCU always sleeps using the sleep feature of the RTC and wakes up once every ALARM_INTERVAL minutes.
+ *  Motion is detected by the wake-up detector of LIS2DW, so the MCU wakes up only for real motion.
  *
  * [Note]
  *  The current consumption during sleep(MCU is standby mode and LIS2DW is active) is approximately 80-90uA.
@@ -32,6 +33,7 @@
 
 // Constants
 #define LED_ON_TIME       2000    // LED lighting time [mS]
+#define WAKE_UP_THRESHOLD 64      // Wake-up threshold [mg]
 #define ALARM_INTERVAL    3       // Alarm interval [min.]
 
 // Initial settings
@@ -45,8 +47,9 @@
 LIS2DW    acc(HIGH);   // Accelerometer
 RTCZero   rtc;         // Real Time Clock in atsamd21
 
-volatile int        ledOn = false;      // Current status of Led
-volatile uint32_t   detectedTime = 0;   // last detected time
+int                 ledOn = false;      // Current status of Led
+uint32_t            detectedTime = 0;   // last detected time
+volatile bool       interrupted = false;  // INT1 interrupt occurred
 
 // setup() --
 void setup(void) {
@@ -67,28 +70,15 @@ void setup(void) {
   while (acc.readRegister(s2REG_CTRL2) & s2CTRL2_SOFT_RESET)
     ;   // wait for ready
 
-  // Set up LIS2DW
-  acc.writeRegister(s2REG_CTRL6, REG_CTRL6);
-  delay(1);
-  acc.writeRegister(s2REG_CTRL1, REG_CTRL1);
-  delay(1);
-  acc.writeRegister(s2REG_CTRL2, REG_CTRL2);
-  delay(1);
-  acc.writeRegister(s2REG_CTRL3, REG_CTRL3);
-  delay(1);
-  uint8_t reg = acc.readRegister(s2REG_CTRL7);
-  acc.writeRegister(s2REG_CTRL7, reg | s2CTRL7_USR_OFF_ON_OUT);
-  delay(1);
-  reg = acc.readRegister(s2REG_WAKE_UP_DUR);
-  acc.writeRegister(s2REG_WAKE_UP_DUR, reg | (s2WAKE_UP_DUR_WAKE_DUR_MASK & 0));
-  // Set Wake-Up threshold: 1 LSb corresponds to FS_XL/2^6
-  reg = acc.readRegister(s2REG_WAKE_UP_THS);
-  acc.writeRegister(s2REG_WAKE_UP_THS, reg | (s2WAKE_UP_THS_WK_THS_MASK & 2));
-  // Set route WU to INT1
-  reg = acc.readRegister(s2REG_CTRL4_INT1_PAD_CTRL);
-  acc.writeRegister(s2REG_CTRL4_INT1_PAD_CTRL, reg | s2CTRL4_INT1_WU);
-  reg = acc.readRegister(s2REG_CTRL7);
-  acc.writeRegister(s2REG_CTRL7, reg | s2CTRL7_INTERRUPTS_ENABLE);
+  // Set up LIS2DW (changes are staged in shadow, and written by applyConfig() in a few bursts)
+  acc.stageRegister(s2REG_CTRL6, 0xff, REG_CTRL6);
+  acc.stageRegister(s2REG_CTRL1, 0xff, REG_CTRL1);
+  acc.stageRegister(s2REG_CTRL2, 0xff, REG_CTRL2);
+  acc.stageRegister(s2REG_CTRL3, 0xff, REG_CTRL3);
+  acc.stageRegister(s2REG_CTRL7, REG_CTRL7, REG_CTRL7);
+  acc.applyConfig();
+  // Set Wake-Up threshold and route it to INT1(after ODR and FS are set, they are used to convert mg and mS)
+  acc.setWakeUp(WAKE_UP_THRESHOLD, 0);
 
   // Set up RTC (Set Mar/03/2020 00:00:00, for now)
   rtc.begin();
@@ -108,31 +98,37 @@ void setup(void) {
 
 // loop() --
 void loop(void) {
+    if (interrupted) {
+        interrupted = false;
+        acc.pollEvents();       // Read interrupt sources into event queue and clear INT1
+        mgim.setAccelerationHandler(onMotion);
+    }
+
+    LIS2DWEvent event;
+    while (acc.readEvent(&event)) {
+        if (event.type == s2EVENT_WAKE_UP && ! ledOn) {
+            detectedTime = millis();
+            mgim.setLed(1);     // Turn on led
+            ledOn = true;
+        }
+    }
+
     if (ledOn && (millis() - detectedTime > LED_ON_TIME)) {
         ledOn = false;
         mgim.setLed(0);     // Turn off led
-        acc.readRegister(s2REG_ALL_INT_SRC);  // clear INT1
     }
 
-    if (! ledOn) {
+    if (! ledOn && ! interrupted) {
         setupGPIOs();           // Set up GPIO pins for sleep
         rtc.standbyMode();      // Sleep(Stand by) now..
     }
 }
 
+// onMotion() -- INT1 interrupt handler, only set a flag(no I2C)
 void onMotion(void) {
-    if (ledOn)
-        return;
-
-    uint8_t intSource = acc.readRegister(s2REG_ALL_INT_SRC);  // Read interrupt sources and cleat INT1
-    if (intSource & s2INT_SRC_WU_IA) {
-        uint8_t wuSource = acc.readRegister(s2REG_WAKE_UP_SRC);
-        if (wuSource & (s2WAKE_UP_SRC_X_WU | s2WAKE_UP_SRC_Y_WU | s2WAKE_UP_SRC_Z_WU)) {
-            detectedTime = millis();
-            mgim.setLed(1);     // Turn on led
-            ledOn = true;
-        }
-    }
+    interrupted = true;
+    acc.onEvent();
+    mgim.setAccelerationHandler(NULL);  // INT1 stays LOW until the sources are read, so mask it until then
 }
 
 // blinkLed() -- blink led on mgim
@@ -0,0 +1,91 @@
+/*
+ *  MGQueue sample sketch - Store and forward temperature to Ambient
+ *
+ *    温度を一定間隔で計測してフラッシュ上のキューに追加し、Ambientへのアップロードに成功したものだけをキューから削除する
+ *    通信できない間に計測したデータは、リブートしてもキューに残り、通信が回復したときにまとめて送信される
+ */
+
+#include <Wire.h>
+#include <mgim.h>
+#include <mgqueue.h>
+#include <hl7800.h>
+#include <stts751.h>
+#include <ambient_mgim.h>
+
+// Set your REAL channel-id and write-key
+#define CHANNEL_ID          ***
+#define WRITE_KEY           "@@@"
+
+#define SAMPLING_INTERVAL   10000       // 計測間隔[mS]
+#define UPLOAD_INTERVAL     60000       // アップロード間隔[mS]
+#define MAX_UPLOADS         8           // 1回にアップロードする最大レコード数
+
+typedef struct {
+  uint32_t  sampleNo;                   // 通し番号
+  int16_t   temperature;                // 温度(x10)[℃]
+} RECORD;
+
+HL7800  hl7800;
+STTS751 stts751;
+MGQueue queue;
+Ambient_mgim am(hl7800);
+uint32_t sampleNo = 0;
+uint32_t lastSampling = 0, lastUpload = 0;
+
+void setup() {
+  mgim.begin();
+
+  while (! mgSERIAL_MONITOR)
+    ;
+  mgSERIAL_MONITOR.begin(115200);
+  mgSERIAL_MONITOR.println("Start.");
+
+  Wire.begin();
+  stts751.begin();
+
+  queue.begin();
+  mgSERIAL_MONITOR.print("records in queue: ");
+  mgSERIAL_MONITOR.println(queue.available());
+
+  am.begin(CHANNEL_ID, WRITE_KEY);
+
+  hl7800.powerOn();
+  delay(1000);
+  if (hl7800.begin() != 0)
+    mgSERIAL_MONITOR.println("hl7800.begin(): error");     // キューに貯めておく
+}
+
+void loop() {
+  // 計測してキューに追加する(フラッシュへの書き込みは、queue.poll()で行われる)
+  if (millis() - lastSampling >= SAMPLING_INTERVAL) {
+    lastSampling = millis();
+    RECORD record = { sampleNo++, (int16_t)stts751.getTemperature() };
+    if (queue.append(&record, sizeof(record)) != 0)
+      mgSERIAL_MONITOR.println("append(): error");
+  }
+  queue.poll();
+
+  // 古いものから順にアップロードし、成功したものをコミットする
+  if (millis() - lastUpload >= UPLOAD_INTERVAL) {
+    lastUpload = millis();
+    for (int i = 0; i < MAX_UPLOADS && queue.available() > 0; i++) {
+      RECORD record;
+      if (queue.peek(0, &record, sizeof(record)) != sizeof(record)) {
+        queue.commit(1);    // 知らない形式のレコードは捨てる
+        continue;
+      }
+      am.set(1, record.temperature / 10.0);
+      am.set(2, (int)record.sampleNo);
+      if (am.send() != 0) {
+        mgSERIAL_MONITOR.println("send(): error, retry later");
+        break;
+      }
+      queue.commit(1);
+      queue.poll();
+    }
+    mgSERIAL_MONITOR.print("queue: ");
+    mgSERIAL_MONITOR.print(queue.available());
+    mgSERIAL_MONITOR.print(", dropped: ");
+    mgSERIAL_MONITOR.println(queue.getDropped());
+  }
+}
@@ -0,0 +1,101 @@
+/*
+ * Stream vibration sample sketch for MGIM
+ *
+ * [Description]
+ *  This is a sample sketch that streams 3-axis accelerations at 400Hz without losing samples.
+ *  The FIFO threshold interrupt of LIS2DW only sets a flag, and the samples are drained into
+ *  the ring in yield(), which is called by delay() and while the library waits for the modem.
+ *  loop() reads the samples from the ring block by block, and prints the time of the first sample,
+ *  the average of each block and the ODR measured against micros().
+ *
+ * [Note]
+ *  Drain the FIFO within (32 - STREAM_THRESHOLD) / ODR(= 40mS @400Hz), otherwise samples are lost
+ *  and the next block is marked as "gap" with the number of lost samples.
+ *  Do not use LTE-M communication function, so no SIM and antenna required.
+ */
+
+#include <Wire.h>
+#include <mgim.h>
+#include <lis2dw.h>
+
+// Constants
+#define STREAM_SAMPLES    256     // Samples in ring(power of 2)
+#define STREAM_THRESHOLD  16      // FIFO threshold to interrupt
+
+// Initial settings
+#define REG_CTRL1     (s2ODR_400 | s2MODE_HIGH_PERFORMANCE)
+#define REG_CTRL2     (s2CTRL2_BDU)
+#define REG_CTRL6     (s2FS_2G | s2CTRL6_LOW_NOISE | s2BW_FILT_DIV2)
+
+// Define accelaration sensor instance
+LIS2DW    acc(HIGH);   // Accelerometer
+int16_t   ring[3 * STREAM_SAMPLES];   // Sample ring(X,Y,Z,X,..)
+
+// setup() --
+void setup(void) {
+  mgim.begin();
+  Wire.begin();
+  mgSERIAL_MONITOR.begin(115200);
+  while (! mgSERIAL_MONITOR)
+    ;
+
+  // Check id
+  delay(20);    // Wait for lis2dw to complete booting
+  uint8_t id = acc.readRegister(s2REG_WHO_AM_I);
+  if (id != s2WHO_AM_I_ID) {
+    mgSERIAL_MONITOR.print("Bad id=0x");
+    mgSERIAL_MONITOR.println(id, HEX);
+    while (1) ;       // Stop here
+  }
+
+  // Reset LIS2DW
+  acc.writeRegister(s2REG_CTRL2, s2CTRL2_SOFT_RESET);
+  while (acc.readRegister(s2REG_CTRL2) & s2CTRL2_SOFT_RESET)
+    ;   // wait for ready
+
+  // Set up LIS2DW
+  acc.stageRegister(s2REG_CTRL1, 0xff, REG_CTRL1);
+  acc.stageRegister(s2REG_CTRL2, 0xff, REG_CTRL2);
+  acc.stageRegister(s2REG_CTRL6, 0xff, REG_CTRL6);
+  acc.applyConfig();
+
+  // Start streaming(INT1 goes high when FIFO reaches the threshold)
+  mgim.setAccelerationHandler(onWatermark, RISING);
+  acc.beginStream(ring, STREAM_SAMPLES, STREAM_THRESHOLD);
+}
+
+// loop() --
+void loop(void) {
+  int16_t   data[3 * s2MAX_FIFO_SAMPLES];
+  AccBatch  batch;
+
+  acc.pollStream();     // in case yield() was not called
+  int n = acc.readStream(data, s2MAX_FIFO_SAMPLES, &batch);
+  if (n > 0) {
+    long  sum[3] = { 0, 0, 0 };
+    for (int i = 0; i < n; i++)
+      for (int axis = 0; axis < 3; axis++)
+        sum[axis] += data[i * 3 + axis];
+    char  line[80];
+    sprintf(line, "%lu,%d,%d,%d,%d,%lu", (unsigned long)batch.time, n,
+            acc.tomg(sum[0] / n, s2FS_2G), acc.tomg(sum[1] / n, s2FS_2G), acc.tomg(sum[2] / n, s2FS_2G),
+            (unsigned long)acc.getEstimatedODR());    // time of sample i is LIS2DW::sampleTime(&batch, i)
+    mgSERIAL_MONITOR.print(line);
+    if (batch.gap) {
+      mgSERIAL_MONITOR.print(",gap,");
+      mgSERIAL_MONITOR.print(batch.lost);
+    }
+    mgSERIAL_MONITOR.println();
+  }
+  delay(10);    // FIFO is drained in yield() while waiting
+}
+
+// yield() -- called by delay() and while waiting, drain FIFO here
+void yield(void) {
+  acc.pollStream();
+}
+
+// onWatermark() -- FIFO threshold interrupt handler, only set a flag(no I2C)
+void onWatermark(void) {
+  acc.onWatermark();
+}
@@ -0,0 +1,466 @@
+/*
+ *  mgqueue.cpp
+ *
+ *  Store-and-forward record queue persisted in the on-chip flash of MGIM(ATSAMD21G18)
+ *
+ *  R0  2026/10/19  log-structured queue with append/peek/commit
+ *
+ *  Copyright(c) 2020-2021 TABrain Inc. All rights reserved.
+ */
+
+#include "mgqueue.h"
+
+// Layout
+//  The queue area is a ring of slots(= flash pages), and each slot holds one record:
+//      [0]     type (TYPE_DATA or TYPE_COMMIT, 0xff:blank)
+//      [1]     length of payload
+//      [2..3]  crc16 of type, length, sequence number and payload
+//      [4..7]  sequence number (incremented for every record written)
+//      [8..]   payload (TYPE_COMMIT: sequence number of the last committed data record)
+//  Records are written in the order of sequence number, and the row ahead of the write position
+//  is erased just before it is used, so that every row is erased equally(wear levelling).
+//  If the ring is full, the oldest row is erased even if it has uncommitted records(they are counted as dropped).
+//  At begin(), the newest record gives the write position, and the newest commit record gives the read position.
+
+// Symbols
+#define TYPE_DATA           0xa5
+#define TYPE_COMMIT         0x5a
+#define CRC_INIT            0xffff
+
+// Flash area
+#ifdef mgQUEUE_EMULATE_FLASH
+static uint8_t queueArea[mgQUEUE_ROWS * mgQUEUE_ROW_SIZE];
+#else
+__attribute__((__aligned__(mgQUEUE_ROW_SIZE)))
+static const uint8_t queueArea[mgQUEUE_ROWS * mgQUEUE_ROW_SIZE] = { };     // Cleared when a sketch is uploaded
+#endif
+
+/**
+ *  @fn
+ *
+ *  キューを初期化し、フラッシュ上のレコードを復元する
+ *
+ *	@param			    なし
+ *  @return             0:成功時、0以外:エラー時(エラー番号)
+ *  @detail             電源断からの再起動時にも、未コミットのレコードから読み出せる
+ */
+int MGQueue::begin(void) {
+    _pendingHead = _pendingTail = _pendingCount = 0;
+    _commitPending = false;
+    _dropped = _overflows = _erases = 0;
+
+    // Find the newest record and the newest commit record
+    int newest = -1;
+    uint32_t maxSeq = 0;
+    _committedSeq = 0;
+    for (int slot = 0; slot < mgQUEUE_SLOTS; slot++) {
+        uint8_t type;
+        int length;
+        uint32_t seq;
+        if (! readHeader(slot, &type, &length, &seq))
+            continue;
+        if (newest < 0 || seq > maxSeq) {
+            newest = slot;
+            maxSeq = seq;
+        }
+        if (type == TYPE_COMMIT) {
+            uint32_t committed;
+            flashRead(slotAddress(slot) + mgQUEUE_HEADER_SIZE, &committed, sizeof(committed));
+            if (committed > _committedSeq)
+                _committedSeq = committed;
+        }
+    }
+    _writeSlot = (newest < 0) ? 0 : nextSlot(newest);
+    _nextSeq = maxSeq + 1;
+
+    // Count uncommitted records from the oldest one
+    _count = 0;
+    _readSlot = _writeSlot;
+    int slot = _writeSlot;
+    for (int i = 0; i < mgQUEUE_SLOTS; i++, slot = nextSlot(slot)) {
+        uint8_t type;
+        int length;
+        uint32_t seq;
+        if (! readHeader(slot, &type, &length, &seq) || type != TYPE_DATA || seq <= _committedSeq)
+            continue;
+        if (_count++ == 0)
+            _readSlot = slot;
+    }
+
+    return (mgSUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  レコードを追加する
+ *
+ *  @param(data)        [in] レコードのデータ(バイナリデータ可)
+ *  @param(length)      [in] dataのサイズ(1～mgQUEUE_MAX_RECORD_SIZE)[Bytes]
+ *  @return             0:成功時、0以外:エラー時(エラー番号)
+ *  @detail             RAM上のバッファにコピーするだけで、フラッシュへの書き込みはpoll()で行う(ブロックしない)
+ */
+int MGQueue::append(const void *data, int length) {
+    if (data == NULL || length <= 0 || length > mgQUEUE_MAX_RECORD_SIZE)
+        return (mgERR_BAD_PARAM);
+    if (_pendingCount >= mgQUEUE_PENDING_RECORDS) {
+        _overflows++;
+        return (mgERR_QUEUE_FULL);
+    }
+
+    _pending[_pendingHead].length = (uint8_t)length;
+    memcpy(_pending[_pendingHead].data, data, length);
+    _pendingHead = (_pendingHead + 1) % mgQUEUE_PENDING_RECORDS;
+    _pendingCount++;
+
+    return (mgSUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  未書き込みのレコードをフラッシュに書き込む
+ *
+ *	@param			    なし
+ *  @return             0:すべて書き込み済み、1～:未書き込みのレコード数
+ *  @detail             1回の呼び出しでは、行の消去またはページの書き込みを1つ開始するだけで、完了は待たない。
+ *                      前の操作が完了していなければ何もしない。loop()から繰り返し呼び出すこと。
+ */
+int MGQueue::poll(void) {
+    if (pending() == 0 || ! flashReady())
+        return (pending());
+
+    // Prepare the slot: erase the row when entering it
+    if (_writeSlot % mgQUEUE_PAGES_PER_ROW == 0) {
+        if (! isBlank(_writeSlot, mgQUEUE_PAGES_PER_ROW)) {
+            dropRow(_writeSlot / mgQUEUE_PAGES_PER_ROW);
+            flashEraseRow(slotAddress(_writeSlot));
+            _erases++;
+            return (pending());
+        }
+    }
+    else if (! isBlank(_writeSlot, 1)) {
+        // Torn or unknown data (ex. power failure while writing), skip to the next row
+        _writeSlot = (_writeSlot / mgQUEUE_PAGES_PER_ROW + 1) * mgQUEUE_PAGES_PER_ROW % mgQUEUE_SLOTS;
+        return (pending());
+    }
+
+    // Write a record (commit record first)
+    if (_commitPending) {
+        buildPage(TYPE_COMMIT, (const uint8_t *)&_committedSeq, sizeof(_committedSeq));
+        _commitPending = false;
+    }
+    else {
+        buildPage(TYPE_DATA, _pending[_pendingTail].data, _pending[_pendingTail].length);
+        _pendingTail = (_pendingTail + 1) % mgQUEUE_PENDING_RECORDS;
+        _pendingCount--;
+        if (_count++ == 0)
+            _readSlot = _writeSlot;
+    }
+    flashWritePage(slotAddress(_writeSlot), _page);
+    _writeSlot = nextSlot(_writeSlot);
+
+    return (pending());
+}
+
+/**
+ *  @fn
+ *
+ *  未コミットのレコードを読み出す
+ *
+ *  @param(index)       [in] 最も古い未コミットのレコードからの位置(0～available()-1)
+ *  @param(data)        [out] レコードのデータの格納先
+ *  @param(size)        [in] dataのサイズ[Bytes]
+ *  @return             0～:成功時(レコードのサイズ)、～-1:エラー時(エラー番号のマイナス値)
+ *  @detail             レコードは削除しない。送信できたら、commit()で削除する。
+ */
+int MGQueue::peek(int index, void *data, int size) {
+    if (index < 0 || data == NULL)
+        return (- mgERR_BAD_PARAM);
+    if (index >= _count)
+        return (- mgERR_QUEUE_EMPTY);
+
+    int slot = _readSlot;
+    for (int i = 0; i < mgQUEUE_SLOTS; i++, slot = nextSlot(slot)) {
+        uint8_t type;
+        int length;
+        uint32_t seq;
+        if (! readHeader(slot, &type, &length, &seq) || type != TYPE_DATA || seq <= _committedSeq)
+            continue;
+        if (index-- > 0)
+            continue;
+        if (length > size)
+            return (- mgERR_BAD_PARAM);
+        flashRead(slotAddress(slot) + mgQUEUE_HEADER_SIZE, data, length);
+        return (length);
+    }
+
+    return (- mgERR_QUEUE_EMPTY);
+}
+
+/**
+ *  @fn
+ *
+ *  古いレコードから指定された数だけ削除する
+ *
+ *  @param(n)           [in] 削除するレコード数(1～available())
+ *  @return             0:成功時、0以外:エラー時(エラー番号)
+ *  @detail             コミットレコードは、次のpoll()でフラッシュに書き込まれる
+ */
+int MGQueue::commit(int n) {
+    if (n <= 0)
+        return (mgERR_BAD_PARAM);
+    if (n > _count)
+        return (mgERR_QUEUE_EMPTY);
+
+    int slot = _readSlot;
+    for (int i = 0; i < mgQUEUE_SLOTS && n > 0; i++, slot = nextSlot(slot)) {
+        uint8_t type;
+        int length;
+        uint32_t seq;
+        if (! readHeader(slot, &type, &length, &seq) || type != TYPE_DATA || seq <= _committedSeq)
+            continue;
+        _committedSeq = seq;
+        _count--;
+        n--;
+    }
+    _readSlot = (_count == 0) ? _writeSlot : slot;
+    _commitPending = true;      // Successive commits are written as one record
+
+    return (mgSUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  キューを空にする
+ *
+ *	@param			    なし
+ *  @return             0:成功時、0以外:エラー時(エラー番号)
+ *  @detail             すべての行を消去する(ブロックする)
+ */
+int MGQueue::clear(void) {
+    for (int row = 0; row < mgQUEUE_ROWS; row++) {
+        while (! flashReady())
+            ;
+        if (! isBlank(row * mgQUEUE_PAGES_PER_ROW, mgQUEUE_PAGES_PER_ROW)) {
+            flashEraseRow(slotAddress(row * mgQUEUE_PAGES_PER_ROW));
+            _erases++;
+        }
+    }
+    while (! flashReady())
+        ;
+    uint32_t erases = _erases;
+    begin();
+    _erases = erases;
+
+    return (mgSUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  スロットのアドレスを得る
+ *
+ *  @param(slot)        [in] スロット番号(0～mgQUEUE_SLOTS-1)
+ *  @return             スロットの先頭アドレス
+ *  @detail
+ */
+const uint8_t *MGQueue::slotAddress(int slot) {
+    return (queueArea + slot * mgQUEUE_PAGE_SIZE);
+}
+
+/**
+ *  @fn
+ *
+ *  スロットのレコードのヘッダを読み出し、検証する
+ *
+ *  @param(slot)        [in] スロット番号
+ *  @param(type)        [out] レコードの種類
+ *  @param(length)      [out] ペイロードのサイズ[Bytes]
+ *  @param(seq)         [out] シーケンス番号
+ *  @return             true:有効なレコード、false:空きまたは壊れたレコード
+ *  @detail
+ */
+bool MGQueue::readHeader(int slot, uint8_t *type, int *length, uint32_t *seq) {
+    uint8_t record[mgQUEUE_PAGE_SIZE];
+    flashRead(slotAddress(slot), record, mgQUEUE_HEADER_SIZE);
+    if ((record[0] != TYPE_DATA && record[0] != TYPE_COMMIT) || record[1] > mgQUEUE_MAX_RECORD_SIZE)
+        return false;
+
+    flashRead(slotAddress(slot) + mgQUEUE_HEADER_SIZE, record + mgQUEUE_HEADER_SIZE, record[1]);
+    uint16_t crc = crc16(record, 2, CRC_INIT);
+    crc = crc16(record + 4, 4 + record[1], crc);
+    if (crc != (uint16_t)(record[2] | (record[3] << 8)))
+        return false;
+
+    *type = record[0];
+    *length = record[1];
+    *seq = (uint32_t)record[4] | ((uint32_t)record[5] << 8) | ((uint32_t)record[6] << 16) | ((uint32_t)record[7] << 24);
+
+    return true;
+}
+
+/**
+ *  @fn
+ *
+ *  スロットが消去済みかを調べる
+ *
+ *  @param(slot)        [in] 先頭のスロット番号
+ *  @param(pages)       [in] 調べるスロット数
+ *  @return             true:消去済み、false:書き込まれている
+ *  @detail
+ */
+bool MGQueue::isBlank(int slot, int pages) {
+    uint32_t words[mgQUEUE_PAGE_SIZE / sizeof(uint32_t)];
+    for (int i = 0; i < pages; i++) {
+        flashRead(slotAddress(slot + i), words, sizeof(words));
+        for (int j = 0; j < (int)(sizeof(words) / sizeof(words[0])); j++) {
+            if (words[j] != 0xffffffffUL)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ *  @fn
+ *
+ *  消去する行にある未コミットのレコードを破棄する
+ *
+ *  @param(row)         [in] 行番号
+ *  @return             なし
+ *  @detail             読み出し位置が行の中にあれば、次の行に移す
+ */
+void MGQueue::dropRow(int row) {
+    int top = row * mgQUEUE_PAGES_PER_ROW;
+    for (int slot = top; slot < top + mgQUEUE_PAGES_PER_ROW; slot++) {
+        uint8_t type;
+        int length;
+        uint32_t seq;
+        if (readHeader(slot, &type, &length, &seq) && type == TYPE_DATA && seq > _committedSeq && _count > 0) {
+            _count--;
+            _dropped++;
+        }
+    }
+    if (_count == 0)
+        _readSlot = _writeSlot;
+    else if (_readSlot >= top && _readSlot < top + mgQUEUE_PAGES_PER_ROW)
+        _readSlot = (top + mgQUEUE_PAGES_PER_ROW) % mgQUEUE_SLOTS;
+}
+
+/**
+ *  @fn
+ *
+ *  書き込むページのイメージを作る
+ *
+ *  @param(type)        [in] レコードの種類
+ *  @param(data)        [in] ペイロード
+ *  @param(length)      [in] ペイロードのサイズ[Bytes]
+ *  @return             なし
+ *  @detail             シーケンス番号は書き込み順に振る
+ */
+void MGQueue::buildPage(uint8_t type, const uint8_t *data, int length) {
+    uint8_t *p = (uint8_t *)_page;
+    uint32_t seq = _nextSeq++;
+
+    memset(p, 0xff, mgQUEUE_PAGE_SIZE);
+    p[0] = type;
+    p[1] = (uint8_t)length;
+    p[4] = seq & 0xff;
+    p[5] = (seq >> 8) & 0xff;
+    p[6] = (seq >> 16) & 0xff;
+    p[7] = (seq >> 24) & 0xff;
+    memcpy(p + mgQUEUE_HEADER_SIZE, data, length);
+    uint16_t crc = crc16(p, 2, CRC_INIT);
+    crc = crc16(p + 4, 4 + length, crc);
+    p[2] = crc & 0xff;
+    p[3] = crc >> 8;
+}
+
+/**
+ *  @fn
+ *
+ *  CRC16(CCITT)を計算する
+ *
+ *  @param(data)        [in] データ
+ *  @param(length)      [in] dataのサイズ[Bytes]
+ *  @param(crc)         [in] CRCの初期値(または途中までの値)
+ *  @return             CRC値
+ *  @detail
+ */
+uint16_t MGQueue::crc16(const uint8_t *data, int length, uint16_t crc) {
+    while (length-- > 0) {
+        crc ^= (uint16_t)*data++ << 8;
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+
+    return (crc);
+}
+
+//-- Flash access
+#ifdef mgQUEUE_EMULATE_FLASH
+
+bool MGQueue::flashReady(void) {
+    return true;
+}
+
+void MGQueue::flashEraseRow(const uint8_t *address) {
+    memset((uint8_t *)address, 0xff, mgQUEUE_ROW_SIZE);
+}
+
+void MGQueue::flashWritePage(const uint8_t *address, const uint32_t *data) {
+    uint8_t *dst = (uint8_t *)address;
+    const uint8_t *src = (const uint8_t *)data;
+    for (int i = 0; i < mgQUEUE_PAGE_SIZE; i++)
+        dst[i] &= src[i];       // Writing can only clear bits
+}
+
+void MGQueue::flashRead(const uint8_t *address, void *data, int length) {
+    memcpy(data, address, length);
+}
+
+#else // mgQUEUE_EMULATE_FLASH
+
+bool MGQueue::flashReady(void) {
+    return (NVMCTRL->INTFLAG.bit.READY != 0);
+}
+
+void MGQueue::flashEraseRow(const uint8_t *address) {
+    // Start erasing, and don't wait for the completion
+    NVMCTRL->STATUS.reg |= NVMCTRL_STATUS_MASK;
+    NVMCTRL->ADDR.reg = ((uint32_t)address) / 2;
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_ER;
+}
+
+void MGQueue::flashWritePage(const uint8_t *address, const uint32_t *data) {
+    // Clear the page buffer
+    NVMCTRL->CTRLB.bit.MANW = 1;
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_PBC;
+    while (NVMCTRL->INTFLAG.bit.READY == 0)
+        ;
+
+    // Fill the page buffer by 32bit words, and start writing without waiting for the completion
+    volatile uint32_t *dst = (volatile uint32_t *)address;
+    for (int i = 0; i < (int)(mgQUEUE_PAGE_SIZE / sizeof(uint32_t)); i++)
+        dst[i] = data[i];
+    NVMCTRL->STATUS.reg |= NVMCTRL_STATUS_MASK;
+    NVMCTRL->ADDR.reg = ((uint32_t)address) / 2;
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_WP;
+}
+
+void MGQueue::flashRead(const uint8_t *address, void *data, int length) {
+    // Read through volatile pointer, because the compiler assumes that the const area is never changed
+    volatile const uint8_t *src = address;
+    uint8_t *dst = (uint8_t *)data;
+    while (NVMCTRL->INTFLAG.bit.READY == 0)
+        ;
+    while (length-- > 0)
+        *dst++ = *src++;
+}
+
+#endif // mgQUEUE_EMULATE_FLASH
+
+// End of mgqueue.cpp
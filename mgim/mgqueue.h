@@ -0,0 +1,101 @@
+/*
+ *  mgqueue.h
+ *
+ *  Store-and-forward record queue persisted in the on-chip flash of MGIM(ATSAMD21G18)
+ *
+ *  R0  2026/10/19  log-structured queue with append/peek/commit
+ *
+ *  Copyright(c) 2020-2021 TABrain Inc. All rights reserved.
+ */
+
+#ifndef _mgqueue_h_
+#define _mgqueue_h_
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "mgim.h"
+#else
+#include <stdint.h>
+#include <string.h>
+#define mgSUCCESS                   0           // When the call is successful
+#define mgERR_BAD_PARAM             100         // Bad parameters
+#endif
+
+//-- Flash backend
+//  On ATSAMD21 the queue is stored in the flash through NVMCTRL.
+//  On other targets (or if mgQUEUE_EMULATE_FLASH is defined) the flash is emulated in RAM,
+//  with the same erase(to 0xff)/write(clear bits only) semantics, so that the queue can be built and tested on a host.
+#if ! defined(ARDUINO_ARCH_SAMD) && ! defined(mgQUEUE_EMULATE_FLASH)
+#define mgQUEUE_EMULATE_FLASH
+#endif
+
+//-- Symbols
+#define mgQUEUE_PAGE_SIZE           64          // Flash page size(= size of one record slot) [Bytes]
+#define mgQUEUE_PAGES_PER_ROW       4           // Pages per row(= erase unit)
+#define mgQUEUE_ROW_SIZE            (mgQUEUE_PAGE_SIZE * mgQUEUE_PAGES_PER_ROW)
+#define mgQUEUE_ROWS                32          // Rows reserved for the queue (32 rows = 8KB)
+#define mgQUEUE_SLOTS               (mgQUEUE_ROWS * mgQUEUE_PAGES_PER_ROW)
+#define mgQUEUE_HEADER_SIZE         8           // type(1) + length(1) + crc16(2) + sequence number(4) [Bytes]
+#define mgQUEUE_MAX_RECORD_SIZE     (mgQUEUE_PAGE_SIZE - mgQUEUE_HEADER_SIZE)   // Maximum payload of a record [Bytes]
+#define mgQUEUE_PENDING_RECORDS     8           // Records which can be appended before poll() writes them to the flash
+
+//-- Error codes
+#define mgERR_QUEUE_FULL            110         // append() - pending buffer is full (call poll() more often)
+#define mgERR_QUEUE_EMPTY           111         // peek()/commit() - no such record
+
+//-- Class definition
+class MGQueue {
+  public:
+      MGQueue() { }
+
+      int begin(void);
+      int append(const void *data, int length);
+      int poll(void);
+      int available(void) { return _count; }
+      int pending(void) { return _pendingCount + (_commitPending ? 1 : 0); }
+      int peek(int index, void *data, int size);
+      int commit(int n);
+      int clear(void);
+
+      // Statistics
+      uint32_t getDropped(void) { return _dropped; }      // Records erased before committed(flash was full)
+      uint32_t getOverflows(void) { return _overflows; }  // Records rejected by append()(pending buffer was full)
+      uint32_t getErases(void) { return _erases; }        // Rows erased since begin()
+
+  private:
+      // Functions
+      const uint8_t *slotAddress(int slot);
+      bool readHeader(int slot, uint8_t *type, int *length, uint32_t *seq);
+      bool isBlank(int slot, int pages);
+      void dropRow(int row);
+      void buildPage(uint8_t type, const uint8_t *data, int length);
+      int nextSlot(int slot) { return (slot + 1 < mgQUEUE_SLOTS) ? slot + 1 : 0; }
+      static uint16_t crc16(const uint8_t *data, int length, uint16_t crc);
+      // Flash access
+      static bool flashReady(void);
+      static void flashEraseRow(const uint8_t *address);
+      static void flashWritePage(const uint8_t *address, const uint32_t *data);
+      static void flashRead(const uint8_t *address, void *data, int length);
+
+      // Variables
+        // persisted records
+      int _writeSlot;           // Slot to be written next
+      int _readSlot;            // Slot to start searching for the oldest uncommitted record
+      int _count;               // Uncommitted records in the flash
+      uint32_t _nextSeq;        // Next sequence number
+      uint32_t _committedSeq;   // Sequence number of the last committed record
+      bool _commitPending;      // Commit record is not written yet
+        // records not yet written
+      struct {
+          uint8_t length;
+          uint8_t data[mgQUEUE_MAX_RECORD_SIZE];
+      } _pending[mgQUEUE_PENDING_RECORDS];
+      volatile int _pendingHead, _pendingTail, _pendingCount;
+      uint32_t _page[mgQUEUE_PAGE_SIZE / sizeof(uint32_t)];     // Page image to write
+        // statistics
+      uint32_t _dropped;
+      uint32_t _overflows;
+      uint32_t _erases;
+};
+
+#endif // _mgqueue_h_
@@ -0,0 +1,166 @@
+/*
+ *  mgqueue_test.cpp
+ *
+ *  Host test of MGQueue (the flash is emulated in RAM, see mgqueue.h)
+ *
+ *  Build and run:  make -C mgim/test
+ *
+ *  R0  2026/10/19  empty, full(pending buffer and flash) and wraparound cases
+ *
+ *  Copyright(c) 2020-2021 TABrain Inc. All rights reserved.
+ */
+
+#include <stdio.h>
+#include "mgqueue.h"
+
+static int failures = 0;
+
+#define CHECK(cond)     do { if (! (cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+// Write all pending records into the (emulated) flash
+static void drain(MGQueue &q) {
+    for (int i = 0; i < 4 * mgQUEUE_SLOTS && q.poll() > 0; i++)
+        ;
+}
+
+// Record of "n": length 1..mgQUEUE_MAX_RECORD_SIZE, filled with the bytes of "n"
+static int makeRecord(uint32_t n, uint8_t *data) {
+    int length = 1 + (int)(n % mgQUEUE_MAX_RECORD_SIZE);
+    for (int i = 0; i < length; i++)
+        data[i] = (uint8_t)(n >> ((i % 4) * 8));
+    return (length);
+}
+
+// Check that the record at "index" is the record of "n"
+static bool isRecord(MGQueue &q, int index, uint32_t n) {
+    uint8_t expected[mgQUEUE_MAX_RECORD_SIZE], data[mgQUEUE_MAX_RECORD_SIZE];
+    int length = makeRecord(n, expected);
+    return (q.peek(index, data, sizeof(data)) == length && memcmp(data, expected, length) == 0);
+}
+
+static void testEmpty(void) {
+    MGQueue q;
+    uint8_t data[mgQUEUE_MAX_RECORD_SIZE];
+
+    CHECK(q.clear() == mgSUCCESS);
+    CHECK(q.available() == 0);
+    CHECK(q.pending() == 0);
+    CHECK(q.poll() == 0);
+    CHECK(q.peek(0, data, sizeof(data)) == - mgERR_QUEUE_EMPTY);
+    CHECK(q.commit(1) == mgERR_QUEUE_EMPTY);
+
+    // Empty again after all records are committed, also after restart
+    CHECK(q.append("abc", 3) == mgSUCCESS);
+    drain(q);
+    CHECK(q.available() == 1);
+    CHECK(q.commit(1) == mgSUCCESS);
+    CHECK(q.available() == 0);
+    CHECK(q.peek(0, data, sizeof(data)) == - mgERR_QUEUE_EMPTY);
+    drain(q);
+
+    MGQueue restarted;
+    CHECK(restarted.begin() == mgSUCCESS);
+    CHECK(restarted.available() == 0);
+    CHECK(restarted.commit(1) == mgERR_QUEUE_EMPTY);
+}
+
+static void testPendingFull(void) {
+    MGQueue q;
+    uint8_t data[mgQUEUE_MAX_RECORD_SIZE];
+
+    CHECK(q.clear() == mgSUCCESS);
+    for (uint32_t n = 0; n < mgQUEUE_PENDING_RECORDS; n++)
+        CHECK(q.append(data, makeRecord(n, data)) == mgSUCCESS);
+    CHECK(q.append(data, makeRecord(99, data)) == mgERR_QUEUE_FULL);
+    CHECK(q.getOverflows() == 1);
+    CHECK(q.pending() == mgQUEUE_PENDING_RECORDS);
+
+    // Rejected record is not stored, and append() works again after poll()
+    drain(q);
+    CHECK(q.pending() == 0);
+    CHECK(q.available() == mgQUEUE_PENDING_RECORDS);
+    CHECK(q.append(data, makeRecord(mgQUEUE_PENDING_RECORDS, data)) == mgSUCCESS);
+    drain(q);
+    CHECK(q.available() == mgQUEUE_PENDING_RECORDS + 1);
+    for (int i = 0; i <= mgQUEUE_PENDING_RECORDS; i++)
+        CHECK(isRecord(q, i, i));
+
+    // Bad parameters
+    CHECK(q.append(data, 0) == mgERR_BAD_PARAM);
+    CHECK(q.append(data, mgQUEUE_MAX_RECORD_SIZE + 1) == mgERR_BAD_PARAM);
+    CHECK(q.peek(0, data, 0) == - mgERR_BAD_PARAM);
+}
+
+static void testWraparound(void) {
+    MGQueue q;
+    uint8_t data[mgQUEUE_MAX_RECORD_SIZE];
+    uint32_t next = 0, oldest = 0;
+
+    // Keep 2 records uncommitted while the write position goes around the ring 3 times
+    // (each round writes 3 data records and 1 commit record)
+    CHECK(q.clear() == mgSUCCESS);
+    for (int i = 0; i < 2; i++)
+        CHECK(q.append(data, makeRecord(next++, data)) == mgSUCCESS);
+    while (next < 3 * mgQUEUE_SLOTS) {
+        for (int i = 0; i < 3; i++)
+            CHECK(q.append(data, makeRecord(next++, data)) == mgSUCCESS);
+        drain(q);
+        CHECK(q.available() == 5);
+        CHECK(isRecord(q, 0, oldest));
+        CHECK(q.commit(3) == mgSUCCESS);
+        oldest += 3;
+    }
+    drain(q);
+    CHECK(q.getDropped() == 0);
+    CHECK(q.getErases() >= 3 * mgQUEUE_ROWS);
+    CHECK(q.available() == (int)(next - oldest));
+    for (int i = 0; i < q.available(); i++)
+        CHECK(isRecord(q, i, oldest + i));
+
+    // Same records are found after restart
+    MGQueue restarted;
+    CHECK(restarted.begin() == mgSUCCESS);
+    CHECK(restarted.available() == (int)(next - oldest));
+    for (int i = 0; i < restarted.available(); i++)
+        CHECK(isRecord(restarted, i, oldest + i));
+}
+
+static void testFlashFull(void) {
+    MGQueue q;
+    uint8_t data[mgQUEUE_MAX_RECORD_SIZE];
+    const uint32_t total = mgQUEUE_SLOTS + 2 * mgQUEUE_PAGES_PER_ROW + 1;
+
+    // Nothing is committed, so the oldest rows are dropped to make room
+    CHECK(q.clear() == mgSUCCESS);
+    for (uint32_t n = 0; n < total; n++) {
+        CHECK(q.append(data, makeRecord(n, data)) == mgSUCCESS);
+        drain(q);
+    }
+    CHECK(q.getDropped() > 0);
+    CHECK(q.available() + (int)q.getDropped() == (int)total);
+    CHECK(q.available() < mgQUEUE_SLOTS);
+    for (int i = 0; i < q.available(); i++)
+        CHECK(isRecord(q, i, q.getDropped() + i));
+
+    // Remaining records can be committed to empty
+    CHECK(q.commit(q.available()) == mgSUCCESS);
+    drain(q);
+    CHECK(q.available() == 0);
+    MGQueue restarted;
+    CHECK(restarted.begin() == mgSUCCESS);
+    CHECK(restarted.available() == 0);
+}
+
+int main(void) {
+    testEmpty();
+    testPendingFull();
+    testWraparound();
+    testFlashFull();
+
+    if (failures > 0) {
+        printf("mgqueue_test: %d failure(s)\n", failures);
+        return (1);
+    }
+    printf("mgqueue_test: OK\n");
+    return (0);
+}
@@ -0,0 +1,94 @@
+/*
+ * MMA8451Q Sample sketch for CAIM -- Capture accelerations before and after a shock(FIFO trigger mode)
+ */
+
+#include <Wire.h>
+#include "mma8451q.h"
+
+// monSerial monitor port
+#define monSerial     SerialUSB
+
+// Pin connected to INT1 of MMA8451Q(push-pull, active low)
+#define INT1_PIN      2
+
+// Initial settings
+#define XYZ_DATA_CFG  (m8XYZ_DATA_FS_4G)
+#define CTRL_REG1     (m8CTRL_REG1_DR_400HZ | m8CTRL_REG1_ACTIVE)
+#define CTRL_REG2     (m8CTRL_REG2_MODE_HIGH_RES)
+
+// Transient(high-pass filtered) detection on all axes, latched until TRANSIENT_SRC is read
+#define TRANSIENT_CFG (m8TRANSIENT_CFG_ELE | m8TRANSIENT_CFG_XTEFE | m8TRANSIENT_CFG_YTEFE | m8TRANSIENT_CFG_ZTEFE)
+#define TRANSIENT_THS 8             // 8 * 0.063g = 0.5g
+#define TRANSIENT_COUNT 2           // 2 samples(5mS at 400Hz) over threshold
+
+#define PRE_SAMPLES   8             // XYZ sets kept before the shock(24 sets after it)
+
+MMA8451Q  acc(LOW);
+int16_t   captureBuffer[3 * m8CAPTURE_SAMPLES];
+
+void trigger(void) {
+  acc.onTrigger();                  // only sets a flag, I2C is used in loop()
+}
+
+void setup() {
+  Wire.begin();
+
+  monSerial.begin(115200);
+  while (! monSerial)
+    ;
+
+  // Check id
+  uint8_t id = acc.readRegister(m8REG_WHO_AM_I);
+  if (id != m8WHO_AM_I_MMA8451Q_ID) {
+    monSerial.print("Bad id=0x");
+    monSerial.println(id, HEX);
+    while (1) ;     // Stop here
+  }
+
+  // Reset MMA8451Q
+  acc.writeRegister(m8REG_CTRL_REG2, m8CTRL_REG2_RST);
+  while (acc.readRegister(m8REG_CTRL_REG2) & m8CTRL_REG2_RST)
+    ;   // wait for ready
+  acc.invalidateShadow();
+
+  // Set up MMA8451Q and the event detector(written by one applyConfig())
+  acc.stageRegister(m8REG_XYZ_DATA_CFG, 0xff, XYZ_DATA_CFG);
+  acc.stageRegister(m8REG_CTRL_REG2, 0xff, CTRL_REG2);
+  acc.stageRegister(m8REG_TRANSIENT_CFG, 0xff, TRANSIENT_CFG);
+  acc.stageRegister(m8REG_TRANSIENT_THS, 0xff, TRANSIENT_THS);
+  acc.stageRegister(m8REG_TRANSIENT_COUNT, 0xff, TRANSIENT_COUNT);
+  acc.stageRegister(m8REG_CTRL_REG1, 0xff, CTRL_REG1);
+  acc.applyConfig();
+
+  // Arm capture triggered by transient
+  pinMode(INT1_PIN, INPUT);
+  attachInterrupt(digitalPinToInterrupt(INT1_PIN), trigger, FALLING);
+  if (acc.beginCapture(captureBuffer, PRE_SAMPLES, m8TRIG_CFG_TRIG_TRANS) != 0) {
+    monSerial.println("beginCapture failed");
+    while (1) ;     // Stop here
+  }
+  monSerial.println("Waiting for a shock..");
+}
+
+void loop() {
+  MMA8451QCapture capture;
+  int n = acc.pollCapture(&capture);
+  if (n <= 0)
+    return;
+
+  // Print the capture with time relative to the trigger
+  int16_t mg[3 * m8CAPTURE_SAMPLES];
+  acc.tomg(captureBuffer, mg, n * 3, XYZ_DATA_CFG);
+  monSerial.print("Shock TRANSIENT_SRC=0x");
+  monSerial.print(capture.detail, HEX);
+  if (capture.late)
+    monSerial.print(" (late)");
+  monSerial.println();
+  uint32_t triggerTime = MMA8451Q::sampleTime(&capture.batch, capture.trigger);
+  for (int i = 0; i < n; i++) {
+    char  line[60];
+    long t = (long)(MMA8451Q::sampleTime(&capture.batch, i) - triggerTime);
+    sprintf(line, "%ld,%d,%d,%d", t, mg[i * 3], mg[i * 3 + 1], mg[i * 3 + 2]);
+    monSerial.println(line);
+  }
+}
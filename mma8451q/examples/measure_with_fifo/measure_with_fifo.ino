@@ -51,8 +51,7 @@ void setup() {
   delay(10);
   acc.writeRegister(m8REG_CTRL_REG2, CTRL_REG2);
   delay(10);
-  uint8_t reg1 = acc.readRegister(m8REG_CTRL_REG1);
-  acc.writeRegister(m8REG_CTRL_REG1, (reg1 | m8CTRL_REG1_ACTIVE));
+  acc.updateRegister(m8REG_CTRL_REG1, m8CTRL_REG1_ACTIVE, m8CTRL_REG1_ACTIVE);  // CTRL_REG1 is in shadow, no read
 }
 
 void loop() {
@@ -7,6 +7,11 @@
  *		R1.0  2017.01.09
  *		R1.1  2017.02.01  add getAccelerations()
  *		R1.2  2020.01.01  fix getFIFOEntries() and readFIFO() return wrong number
+ *		R1.3  2026.10.19  Keep shadow of control registers, add updateRegister(), stageRegister() and applyConfig()
+ *		R1.4  2026.10.19  Add streaming mode(beginStream(), pollStream(), readStream()..)
+ *		R1.5  2026.10.19  Add array version of toRaw()/tomg() and tog()(integer only)
+ *		R1.6  2026.10.19  Move common functions into acccore library(AccCore), MMA8451Q is derived from it
+ *		R1.7  2026.10.19  Add pre-trigger capture(beginCapture(), pollCapture()..)
  *
  *	Note:
  *		MMA8451Q is a 14bit ADC 3-Axis MEMS Accelerometer.
@@ -16,81 +21,157 @@
 
 #include "mma8451q.h"
 
+// Trigger sources, bits of TRIG_CFG are the same as INT_SOURCE, CTRL_REG4(INT_EN_*) and CTRL_REG5(INT_CFG_*)
+#define	TRIG_CFG_MASK	(m8TRIG_CFG_TRIG_TRANS | m8TRIG_CFG_TRIG_LNDPRT | m8TRIG_CFG_TRIG_PULSE | m8TRIG_CFG_TRIG_FF_MT)
+
 /*
  *	Public methods
+ *		Other methods are defined in AccCore(acccore.h)
  */
 
-MMA8451Q::MMA8451Q(int sa0) {
-	if (sa0)
-		_i2cAddress = 0x1d;
-	else
-		_i2cAddress = 0x1c;
+int MMA8451Q::beginStream(int16_t buffer[], int samples, int watermark) {
+	if (watermark < 1 || watermark > m8MAX_FIFO_SAMPLES)
+		return (-1);	// bad parameter
+
+	endStream();		// F_MODE must be 0 before changing to other mode
+	if (startStream(buffer, samples) != 0)
+		return (-1);	// bad parameter
+
+	// Circular buffer mode with watermark, and route FIFO interrupt to INT1
+	stageRegister(m8REG_F_SETUP, 0xff, FIFOMode::bits<m8F_SETUP_F_MODE_CIRC_BUF>() | FIFOWatermark::encode(watermark));
+	stageRegister(m8REG_CTRL_REG4, m8CTRL_REG4_INT_EN_FIFO, m8CTRL_REG4_INT_EN_FIFO);
+	stageRegister(m8REG_CTRL_REG5, m8CTRL_REG5_INT_CFG_FIFO, m8CTRL_REG5_INT_CFG_FIFO);
+	return (applyConfig());		// 0: OK
 }
 
-uint8_t MMA8451Q::readRegister(uint8_t reg) {
-	Wire.beginTransmission(_i2cAddress);
-	Wire.write(reg);
-	Wire.endTransmission(false); 	// uses repeated start
-    Wire.requestFrom(_i2cAddress, (uint8_t)1);
-    if (! Wire.available())
-		return 0xff;		// error
-    return (Wire.read());
+void MMA8451Q::endStream(void) {
+	stageRegister(m8REG_CTRL_REG4, m8CTRL_REG4_INT_EN_FIFO, 0);
+	stageRegister(m8REG_F_SETUP, 0xff, FIFOMode::bits<m8F_SETUP_F_MODE_DISABLE>());
+	applyConfig();
+	stopStream();
 }
 
-void MMA8451Q::readMultiRegisters(uint8_t reg, int bytes, uint8_t data[]) {
-	Wire.beginTransmission(_i2cAddress);
-	Wire.write(reg);
-	Wire.endTransmission(false); 	// uses repeated start
-    Wire.requestFrom(_i2cAddress, (uint8_t)bytes);
-	while (bytes-- > 0) {
-		if (! Wire.available())
-			*data++ = 0xff;			// read error
-		else
-			*data++ = Wire.read();
-	}
+int MMA8451Q::beginCapture(int16_t buffer[], int preSamples, uint8_t triggers) {
+	if (buffer == NULL || preSamples < 0 || preSamples >= m8CAPTURE_SAMPLES || triggers == 0 || (triggers & ~TRIG_CFG_MASK))
+		return (-1);	// bad parameter
+	if (MMA8451QMap::samplePeriod(getShadowRegister(m8REG_CTRL_REG1)) == 0)
+		return (-1);	// not active
+
+	endStream();		// FIFO is used by capture
+	endCapture();
+	_capture = buffer;
+	_capturePre = preSamples;
+	_captureTriggers = triggers;
+
+	// Event sources trigger FIFO, and their interrupts are routed to INT1
+	stageRegister(m8REG_TRIG_CFG, TRIG_CFG_MASK, triggers);
+	stageRegister(m8REG_CTRL_REG4, TRIG_CFG_MASK, triggers);
+	stageRegister(m8REG_CTRL_REG5, TRIG_CFG_MASK, triggers);
+	return (armCapture());		// 0: OK
 }
 
-void MMA8451Q::writeRegister(uint8_t reg, uint8_t data) {
-	Wire.beginTransmission(_i2cAddress);
-	Wire.write(reg);
-	Wire.write(data);
-	Wire.endTransmission();
+void MMA8451Q::endCapture(void) {
+	if (_capture == NULL)
+		return;
+
+	stageRegister(m8REG_CTRL_REG4, _captureTriggers, 0);
+	stageRegister(m8REG_TRIG_CFG, TRIG_CFG_MASK, 0);
+	stageRegister(m8REG_F_SETUP, 0xff, FIFOMode::bits<m8F_SETUP_F_MODE_DISABLE>());
+	applyConfig();
+	_capture = NULL;
 }
 
-int MMA8451Q::getAccelerations(int *ax, int *ay, int *az) {
-	uint8_t data[6];
-	for (int i = 0; i < 6; i++)
-		data[i] = 0;
-	readMultiRegisters(m8REG_OUT_X_MSB, 6, data);
-	*ax = toRaw(data[0], data[1]);
-	*ay = toRaw(data[2], data[3]);
-	*az = toRaw(data[4], data[5]);
+int MMA8451Q::pollCapture(MMA8451QCapture *capture) {
+	if (_capture == NULL)
+		return (0);
+
+	uint32_t period = getSamplePeriod();
+	if (period == 0)
+		period = MMA8451QMap::samplePeriod(getShadowRegister(m8REG_CTRL_REG1)) << 8;	// [1/256 uS]
+
+	if (_captureSource == 0) {
+		// Waiting for the event
+		if (! _triggered)
+			return (0);
+		_triggered = false;
+		uint8_t source = takeTrigger(&_captureDetail);
+		if (source == 0)
+			return (0);		// not a trigger event
+		_captureSource = source;
+		_captureEntries = readRegister(m8REG_F_STATUS) & m8F_STATUS_F_CNT_MASK;
+		_captureTime = now();		// the newest set in FIFO was taken within 1/ODR before
+	}
+
+	// FIFO accepts 32 - pre sets after the event, wait until they are filled(the event may be 1/ODR before)
+	uint32_t wait = (uint32_t)(((uint64_t)period * (m8CAPTURE_SAMPLES - _capturePre + 1)) >> 8);
+	if ((uint32_t)(now() - _captureTime) < wait)
+		return (0);
 
-	return 0;	// OK
+	int entries = readRegister(m8REG_F_STATUS) & m8F_STATUS_F_CNT_MASK;
+	int m = 0;
+	while (m < entries) {
+		int n = entries - m;
+		if (n > m8BURST_SAMPLES)
+			n = m8BURST_SAMPLES;
+		int got = burstRead(_capture + m * 3, n);
+		m += got;
+		if (got < n)
+			break;		// short read
+	}
+	resetTiming();		// FIFO was read without stream timing
+
+	if (capture != NULL) {
+		// Time of the first set, from the entries counted when the event was taken
+		bool late = (_captureEntries == 0 || _captureEntries >= entries);
+		int newest = (late ? entries : _captureEntries) - 1;
+		capture->batch.time = _captureTime - (uint32_t)(((uint64_t)period * newest + period / 2) >> 8);
+		capture->batch.period = period;
+		capture->batch.samples = m;
+		capture->batch.lost = 0;
+		capture->batch.gap = false;
+		int post = m8CAPTURE_SAMPLES - _capturePre;
+		capture->trigger = (m > post) ? m - post : 0;
+		capture->source = _captureSource;
+		capture->detail = _captureDetail;
+		capture->late = late;
+	}
+
+	_captureSource = 0;
+	armCapture();		// ready for the next event
+	return (m);		// return number of captured sets
+}
+
+/*
+ *	Private methods
+ */
+
+int MMA8451Q::armCapture(void) {
+	// F_MODE must be 0 before changing to trigger mode again(FIFO is cleared)
+	stageRegister(m8REG_F_SETUP, 0xff, FIFOMode::bits<m8F_SETUP_F_MODE_DISABLE>());
+	applyConfig();
+	uint8_t detail;
+	takeTrigger(&detail);		// release INT1 from the event latched while FIFO was stopped
+	stageRegister(m8REG_F_SETUP, 0xff, FIFOMode::bits<m8F_SETUP_F_MODE_TRIG_MODE>() | FIFOWatermark::encode(_capturePre));
+	_captureSource = 0;
+	_triggered = false;
+	return (applyConfig());		// 0: OK
 }
 
-int MMA8451Q::readFIFO(int samples[], int numSamples) {
-	int m, n;
-	for (m = n = 0; m < numSamples; n += 3, m++) {
-		Wire.beginTransmission(_i2cAddress);
-		Wire.write(m8REG_OUT_X_MSB);
-		Wire.endTransmission(false); 	// uses repeated start
-		Wire.requestFrom(_i2cAddress, (uint8_t)6);
-		int high = (int)Wire.read() << 6;
-		samples[n] = high + ((Wire.read() & 0xfc) >> 2);	// X
-		if (high & 0x2000)
-			samples[n] |= 0xffffc000;
-		high = (int)Wire.read() << 6;
-		samples[n+1] = high + ((Wire.read() & 0xfc) >> 2);	// Y
-		if (high & 0x2000)
-			samples[n+1] |= 0xffffc000;
-		high = (int)Wire.read() << 6;
-		samples[n+2] = high + ((Wire.read() & 0xff) >> 2);	// Z
-		if (high & 0x2000)
-			samples[n+2] |= 0xffffc000;
+uint8_t MMA8451Q::takeTrigger(uint8_t *detail) {
+	uint8_t source = readRegister(m8REG_INT_SOURCE) & _captureTriggers;
+
+	// Read the source registers to clear the events(and INT1), the first one is kept
+	static const uint8_t sources[][2] = {
+		{ m8INT_SOURCE_SRC_TRANS, m8REG_TRANSIENT_SRC }, { m8INT_SOURCE_SRC_LNDPRT, m8REG_PL_STATUS },
+		{ m8INT_SOURCE_SRC_PULSE, m8REG_PULSE_SRC }, { m8INT_SOURCE_SRC_FF_MT, m8REG_FF_MT_SRC }
+	};
+	*detail = 0;
+	for (int i = 3; i >= 0; i--) {
+		if (source & sources[i][0])
+			*detail = readRegister(sources[i][1]);
 	}
 
-	return (m);		// return number of read samples
+	return (source);	// m8INT_SOURCE_SRC_* of trigger sources(0: none)
 }
 
 // End of "mma8451q.cpp"
@@ -7,6 +7,13 @@
  *		R1.0  2017.01.09
  *		R1.1  2017.02.01  add getAccelerations()
  *		R1.2  2020.01.01  fix getFIFOEntries() and readFIFO() return wrong number
+ *		R1.3  2026.10.19  Keep shadow of control registers, add updateRegister(), stageRegister() and applyConfig()
+ *		R1.4  2026.10.19  Add streaming mode(FIFO watermark interrupt and sample ring)
+ *		R1.5  2026.10.19  Add array version of toRaw()/tomg() and tog()(integer only)
+ *		R1.6  2026.10.19  MMA8451Q is derived from AccCore(acccore library), readFIFO() reads by burst transfer,
+ *		                  add readFIFOBurst() and register fields
+ *		R1.7  2026.10.19  Add data rate of CTRL_REG1 to register map(time of each set drained from FIFO)
+ *		R1.8  2026.10.19  Add pre-trigger capture(FIFO trigger mode)
  *
  *	Note:
  *		MMA8451Q is a 14bit ADC 3-Axis MEMS Accelerometer.
@@ -19,6 +26,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include <acccore.h>
 
 /*
  *	Constants
@@ -27,6 +35,36 @@
 		/* The "sample" is defined as one acceleration of one axis.
 		   That is, the XYZ set of accelerations is assumed to be three samples.
 		 */
+#ifndef m8I2C_BUFFER_SIZE
+#if defined(ARDUINO_ARCH_SAMD)
+#define	m8I2C_BUFFER_SIZE		256			// Size of Wire buffer(SAMD)
+#else
+#define	m8I2C_BUFFER_SIZE		32			// Size of Wire buffer(AVR and others)
+#endif
+#endif
+#define	m8BURST_SAMPLES			(AccCore<MMA8451QMap>::BURST_SAMPLES)
+		/* XYZ sets read by one I2C transaction(6 bytes per set) */
+#define	m8SHADOW_BASE			0x09		// First register kept in shadow(F_SETUP)
+#define	m8SHADOW_REGS			41			// Number of registers kept in shadow(F_SETUP..OFF_Z)
+#define	m8SHADOW_WRITABLE		0x1fffdd0df63ULL	// Writable registers in shadow(bit n is register m8SHADOW_BASE+n)
+		/* Shadow is a copy of the writable control registers, so that changing bits of them
+		   needs only one write(no read). Read only registers(OUT_*, STATUS, *_SRC..) are not kept.
+		 */
+#ifndef m8STREAM_BLOCKS
+#define	m8STREAM_BLOCKS			16			// Number of blocks kept in stream ring(power of 2)
+#endif
+		/* In streaming mode, the FIFO watermark interrupt only sets a flag(onWatermark()), and pollStream()
+		   drains FIFO into the sample ring given by beginStream(). XYZ sets drained at once are a "block",
+		   and readStream() returns them with the time of the sets(AccBatch).
+		   pollStream() is the only producer and readStream() is the only consumer of the ring.
+		 */
+#define	m8CAPTURE_SAMPLES		m8MAX_FIFO_SAMPLES	// XYZ sets of one capture(pre-trigger + post-trigger)
+		/* In capture mode, FIFO keeps the latest "pre" sets until a trigger event(TRIG_CFG) occurs,
+		   and then accepts 32 - pre sets more and stops. The event interrupt only sets a flag(onTrigger()),
+		   and pollCapture() drains both windows into the buffer given by beginCapture() after the
+		   post-trigger window has been filled, and arms FIFO again for the next event.
+		   The event detector itself(TRANSIENT_*, PULSE_*, FF_MT_* or PL_*) is set up by the application.
+		 */
 
 /*
  *	Register Address
@@ -154,6 +192,26 @@
 #define	m8PL_CFG_DBCNTM				0x80		// [RW] 0x80
 #define	m8PL_CFG_PL_EN				0x40		// [RW] 0x00
 
+// m8REG_TRANSIENT_CFG
+#define	m8TRANSIENT_CFG_ELE			0x10		// [RW] 0x00 (event latch)
+#define	m8TRANSIENT_CFG_ZTEFE		0x08		// [RW] 0x00
+#define	m8TRANSIENT_CFG_YTEFE		0x04		// [RW] 0x00
+#define	m8TRANSIENT_CFG_XTEFE		0x02		// [RW] 0x00
+#define	m8TRANSIENT_CFG_HPF_BYP		0x01		// [RW] 0x00
+
+// m8REG_TRANSIENT_SRC
+#define	m8TRANSIENT_SRC_EA			0x40		// [R] 0x00
+#define	m8TRANSIENT_SRC_ZTRANSE		0x20		// [R] 0x00
+#define	m8TRANSIENT_SRC_Z_POL		0x10		// [R] 0x00
+#define	m8TRANSIENT_SRC_YTRANSE		0x08		// [R] 0x00
+#define	m8TRANSIENT_SRC_Y_POL		0x04		// [R] 0x00
+#define	m8TRANSIENT_SRC_XTRANSE		0x02		// [R] 0x00
+#define	m8TRANSIENT_SRC_X_POL		0x01		// [R] 0x00
+
+// m8REG_TRANSIENT_THS
+#define	m8TRANSIENT_THS_DBCNTM		0x80		// [RW] 0x00
+#define	m8TRANSIENT_THS_THS_MASK	0x7f		// [RW] 0x00 (0.063g/LSB)
+
 // m8REG_CTRL_REG1
 #define	m8CTRL_REG1_ASLP_RATE_MASK	0xc0		// [RW] 0x00 (value 0-3)
 #define	m8CTRL_REG1_DR_MASK			0x38		// [RW] 0x00 (value 0-7)
@@ -214,35 +272,87 @@
 #define	m8CTRL_REG5_INT_CFG_FF_MT	0x04		// [RW] 0x00
 #define	m8CTRL_REG5_INT_CFG_DRY		0x01		// [RW] 0x00
 
+/*
+ *	Register map(used by AccCore)
+ */
+struct MMA8451QMap {
+	static constexpr uint8_t OUT_REG = m8REG_OUT_X_MSB;		// X(MSB,LSB), Y(MSB,LSB), Z(MSB,LSB)
+	static constexpr bool MSB_FIRST = true;
+	static constexpr uint8_t AXIS_X = 0, AXIS_Y = 1, AXIS_Z = 2;
+	static constexpr int RESOLUTION = 14;					// F_READ(8-bit) is not supported
+	static constexpr uint32_t LSB_PER_G = 4096;				// @+/-2g
+	static constexpr int rangeIndex(int range) {
+		return ((range == m8XYZ_DATA_FS_2G) ? 0 : (range == m8XYZ_DATA_FS_4G) ? 1 : 2);
+	}														// 0:2g, 1:4g, 2:8g(others)
+	static constexpr int FIFO_SAMPLES = m8MAX_FIFO_SAMPLES;
+	static constexpr uint8_t FIFO_STATUS_REG = m8REG_F_STATUS;
+	static constexpr uint8_t FIFO_COUNT_MASK = m8F_STATUS_F_CNT_MASK;
+	static constexpr uint8_t FIFO_OVERRUN = m8F_STATUS_F_OVF;
+	static constexpr uint8_t INC_REG = 0, INC_BIT = 0;		// address is always incremented
+	static constexpr uint8_t RESET_REG = m8REG_CTRL_REG2, RESET_BITS = m8CTRL_REG2_RST;
+	static constexpr uint8_t STANDBY_REG = m8REG_CTRL_REG1, ACTIVE_BIT = m8CTRL_REG1_ACTIVE;	// others are changed in standby
+	static constexpr uint8_t SHADOW_BASE = m8SHADOW_BASE;
+	static constexpr int SHADOW_REGS = m8SHADOW_REGS;
+	static constexpr uint64_t SHADOW_WRITABLE = m8SHADOW_WRITABLE;
+	static constexpr int I2C_BUFFER_SIZE = m8I2C_BUFFER_SIZE;
+	static constexpr int STREAM_BLOCKS = m8STREAM_BLOCKS;
+	static constexpr uint8_t ODR_REG = m8REG_CTRL_REG1;
+	static uint32_t samplePeriod(uint8_t ctrl1) {
+		static const uint32_t period[8] = { 1250, 2500, 5000, 10000, 20000, 80000, 160000, 640000 };
+		if (! (ctrl1 & m8CTRL_REG1_ACTIVE))
+			return (0);				// standby
+		return (period[(ctrl1 & m8CTRL_REG1_DR_MASK) >> 3]);
+	}														// Sample period of CTRL_REG1 [uS](0 in standby, auto-sleep rate is not followed)
+};
+
+/*
+ *	Capture taken by pollCapture()
+ *		Sets before the trigger are buffer[0 .. trigger - 1], and the others are after it.
+ */
+typedef struct {
+	AccBatch	batch;			// Time of the first set, sample period and number of sets
+	uint8_t	trigger;			// Number of sets before the trigger event(index of the first set after it)
+	uint8_t	source;				// Source of the trigger event(m8INT_SOURCE_SRC_*)
+	uint8_t	detail;				// Source register of the event(TRANSIENT_SRC, PL_STATUS, PULSE_SRC or FF_MT_SRC)
+	bool	late;				// pollCapture() was called after FIFO stopped, time of sets is the latest bound
+} MMA8451QCapture;
+
 /*
  *	MMA8451Q class
  */
-class MMA8451Q {
+class MMA8451Q : public AccCore<MMA8451QMap> {
   public:
-	MMA8451Q(int sa0 = HIGH);						// Constructor with SA0
-	uint8_t readRegister(uint8_t reg);				// Read byte data from a register
-	void readMultiRegisters(uint8_t reg, int bytes, uint8_t data[]);	// Read multi bytes data from registers
-	void writeRegister(uint8_t reg, uint8_t data);	// Write byte data to a register
-	int getAccelerations(int *ax, int *ay, int *az); // Get 3-axis accelerations
-	int getFIFOEntries(void) __attribute__((always_inline)) {
-		return ((readRegister(m8REG_F_STATUS) & m8F_STATUS_F_CNT_MASK));
-	}                                               // Get number of Samples exist in FIFO
-	int readFIFO(int samples[], int numSamples);	// Read data from FIFO
-	int toRaw(uint8_t high, uint8_t low) __attribute__((always_inline)) {
-		int8_t signedHigh = high;
-		return ((((int)signedHigh << 8) + low) >> 2);
-	}                                               // Convert to 14-bit accelaration
-    int tomg(int raw, int range) __attribute__((always_inline)) {
-		if (range == m8XYZ_DATA_FS_2G)
-			return (raw / 4.096);	// 4096 LSB/g @+/-2g
-		else if (range == m8XYZ_DATA_FS_4G)
-			return (raw / 2.048);	// 2048 LSB/g @+/-4g
-		else
-			return (raw / 1.024);	// 1024 LSB/g @+/-8g
-	}                                               // Convert raw to mg
+	MMA8451Q(int sa0 = HIGH) : AccCore<MMA8451QMap>(sa0 ? 0x1d : 0x1c) { _capture = NULL; _triggered = false; }	// Constructor with SA0
+	int beginStream(int16_t buffer[], int samples, int watermark);	// Start streaming into ring(buffer[] has 3 * samples, samples is power of 2)
+	void endStream(void);							// Stop streaming
+	int beginCapture(int16_t buffer[], int preSamples, uint8_t triggers);	// Arm FIFO trigger mode(buffer[] has 3 * m8CAPTURE_SAMPLES,
+													//   triggers are m8TRIG_CFG_TRIG_*), route the event interrupt to INT1
+	void endCapture(void);							// Stop capturing
+	void onTrigger(void) { _triggered = true; }		// Call from ISR of INT1(only sets a flag)
+	int pollCapture(MMA8451QCapture *capture);		// Drain a capture after the event, return number of sets(0: none yet)
+	//-- Other methods are defined in AccCore(acccore.h)
+
+	// Register fields(ex. acc.stageField<MMA8451Q::DataRate>(3), MMA8451Q::FIFOWatermark::field<20>())
+	typedef AccField<m8REG_CTRL_REG1, m8CTRL_REG1_DR_MASK>			DataRate;
+	typedef AccField<m8REG_CTRL_REG1, m8CTRL_REG1_ASLP_RATE_MASK>	SleepRate;
+	typedef AccField<m8REG_CTRL_REG2, m8CTRL_REG2_MODS_MASK>		Mode;
+	typedef AccField<m8REG_CTRL_REG2, m8CTRL_REG2_SMODE_MASK>		SleepMode;
+	typedef AccField<m8REG_XYZ_DATA_CFG, m8XYZ_DATA_FS_MASK>		FullScale;
+	typedef AccField<m8REG_HP_FILTER_CUTOFF, m8HP_FILTER_CUTOFF_SEL_MASK>	HighPassCutoff;
+	typedef AccField<m8REG_F_SETUP, m8F_SETUP_F_MODE_MASK>			FIFOMode;
+	typedef AccField<m8REG_F_SETUP, m8F_SETUP_F_WMRK_MASK>			FIFOWatermark;
 
   private:
-	uint8_t	_i2cAddress;
+	int16_t	*_capture;				// Capture buffer(X,Y,Z,X..), NULL if not capturing
+	uint8_t	_capturePre;			// Sets kept before the trigger(F_WMRK)
+	uint8_t	_captureTriggers;		// Trigger sources(m8TRIG_CFG_TRIG_*)
+	uint8_t	_captureSource;			// INT_SOURCE of the event being captured(0: waiting for the event)
+	uint8_t	_captureDetail;			// Source register of the event
+	uint8_t	_captureEntries;		// FIFO entries when the event was taken
+	uint32_t	_captureTime;		// Time when the event was taken [uS]
+	volatile bool	_triggered;		// Event interrupt occurred
+	int armCapture(void);			// Restart FIFO trigger mode
+	uint8_t takeTrigger(uint8_t *detail);	// Read and clear trigger events, return their INT_SOURCE bits
 };
 
 #endif // _MMA8451Q_
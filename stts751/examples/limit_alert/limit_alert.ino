@@ -0,0 +1,49 @@
+/*
+ *  STTS751 sample sketch - Wait for the temperature to cross the limits by interrupt
+ *
+ *    温度が上限を超えた(または下限以下になった)時だけ、EVENTピンの割り込みで起きて温度を表示するサンプル
+ *    STTS751のEVENTピン(オープンドレイン)をEVENT_PINにつなぐこと
+ */
+
+#include <Wire.h>
+#include <stts751.h>
+
+#define SERIAL_MONITOR      SerialUSB
+#define EVENT_PIN           3               // Pin connected to EVENT of STTS751
+#define HIGH_LIMIT          300             // 30.0C
+#define LOW_LIMIT           100             // 10.0C
+
+STTS751 stts751;
+volatile bool alerted = false;
+
+void onAlert(void) {
+	alerted = true;                         // Only set a flag(no I2C in handler)
+}
+
+void setup() {
+	while (! SERIAL_MONITOR)
+		;
+	SERIAL_MONITOR.begin(9600);
+
+	Wire.begin();
+	stts751.begin();
+	stts751.setResolution(s7RES_10BIT);
+	stts751.setConversionRate(s7RATE_0_25HZ);
+	stts751.setLimits(HIGH_LIMIT, LOW_LIMIT);
+	stts751.getStatus();                    // Clear flags before enabling EVENT pin
+	stts751.setAlertHandler(EVENT_PIN, onAlert);
+	stts751.enableAlert(true);
+}
+
+void loop() {
+	if (! alerted)
+		return;                             // MCU can sleep here until EVENT pin falls
+	alerted = false;
+
+	int status = stts751.getStatus();       // Release EVENT pin
+	int tX10 = stts751.getTemperature();
+	SERIAL_MONITOR.print((status & s7STATUS_T_HIGH) ? "high: " : "low: ");
+	SERIAL_MONITOR.print(tX10 / 10);
+	SERIAL_MONITOR.print(".");
+	SERIAL_MONITOR.println(abs(tX10 % 10));
+}
@@ -0,0 +1,36 @@
+/*
+ *  STTS751 sample sketch - Measure temperature by one-shot conversion
+ *
+ *    STTS751をスタンバイにしておき、10秒ごとに1回だけ変換して温度を表示するサンプル(間欠動作向け)
+ */
+
+#include <Wire.h>
+#include <stts751.h>
+
+#define SERIAL_MONITOR      SerialUSB
+#define INTERVAL            10000           // Interval of measurement [mS]
+
+STTS751 stts751;
+
+void setup() {
+	while (! SERIAL_MONITOR)
+		;
+	SERIAL_MONITOR.begin(9600);
+
+	Wire.begin();
+	stts751.begin();
+	stts751.setResolution(s7RES_11BIT);
+	stts751.setMode(s7MODE_ONE_SHOT);
+}
+
+void loop() {
+	stts751.startConversion();
+	delay(stts751.getConversionTime());     // Wait for the conversion, or sleep
+
+	int tX10 = stts751.getTemperature();
+	SERIAL_MONITOR.print(tX10 / 10);
+	SERIAL_MONITOR.print(".");
+	SERIAL_MONITOR.println(abs(tX10 % 10));
+
+	delay(INTERVAL);
+}
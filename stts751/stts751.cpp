@@ -4,30 +4,33 @@
  *  Digital temperature sensor STTS751 control library
  *
  *  R0.1  2020/02/29 (605e)
+ *  R0.2  2026/10/19 (A.D) add conversion rate/resolution, one-shot mode, consistent readout and limit alerts
  *
- *  Copyright(c) 2020 TABrain Inc. All rights reserved.
+ *  Copyright(c) 2020-2026 TABrain Inc. All rights reserved.
  */
 
 #include <Wire.h>
 #include "stts751.h"
 
+// Symbols
+#define READ_RETRY          3               // readTemperature()で上位バイトが変化した時に読み直す回数
+
 /**
  *  @fn
  *
  *  stts751を初期化する
  *
  *	@param			    なし
- *  @return             なし
- *  @detail             本関数の呼び出し以降、getTemperature()を呼び出すことで温度が計測できるようになる
+ *  @return             s7SUCCESS(成功)またはs7ERROR(I2Cエラー)
+ *  @detail             連続変換、12ビット分解能、1回/秒、EVENTピン無効に設定する
+ *                      本関数の呼び出し以降、getTemperature()を呼び出すことで温度が計測できるようになる
  */
-void STTS751::begin(void) {
-    Wire.beginTransmission(_i2cAddress);
-    Wire.write(0x03);
-    Wire.write(0b10001100);
-    Wire.endTransmission();
-	Wire.write(0x04);
-    Wire.write(0x04);
-    Wire.endTransmission();
+int STTS751::begin(void) {
+	_config = s7CONFIG_MASK1 | s7RES_12BIT;
+	_rate = s7RATE_1HZ;
+	if (writeRegister(s7REG_CONFIG, _config) != s7SUCCESS)
+		return (s7ERROR);
+	return (writeRegister(s7REG_RATE, _rate));
 }
 
 /**
@@ -36,29 +39,284 @@ void STTS751::begin(void) {
  *  温度を計測する
  *
  *	@param			    なし
- *  @return             計測した温度(摂氏)を10倍した値
+ *  @return             計測した温度(摂氏)を10倍した値、読めなかった時はs7INVALID_TEMPERATURE
  *  @detail             なし
  */
 int STTS751::getTemperature(void) {
-	uint32_t data[2];
+	int16_t value;
+	if (readTemperature(&value) != s7SUCCESS)
+		return (s7INVALID_TEMPERATURE);
+
+	return ((int)value * 10 / 256);		// 0.1度未満は0方向に切り捨て
+}
+
+/**
+ *  @fn
+ *
+ *  温度を読み出す
+ *
+ *	@param(value)	    温度(摂氏)を256倍した値を格納する領域
+ *  @return             s7SUCCESS(成功)またはs7ERROR(I2Cエラー)
+ *  @detail             STTS751はレジスタアドレスが自動で進まないので、上位/下位バイトを別々に読む
+ *                      上位、下位、上位の順に読み、上位バイトが一致した時に同じ変換の値として組み合わせる
+ *                      (読み出しの間に変換が完了して上位バイトが変わった時は読み直す)
+ */
+int STTS751::readTemperature(int16_t *value) {
+	if (value == NULL)
+		return (s7ERROR);
+
+	for (int i = 0; i < READ_RETRY; i++) {
+		int high = readRegister(s7REG_TEMP_HIGH);
+		int low = readRegister(s7REG_TEMP_LOW);
+		int again = readRegister(s7REG_TEMP_HIGH);
+		if (high < 0 || low < 0 || again < 0)
+			return (s7ERROR);
+		if (high == again) {
+			*value = (int16_t)((high << 8) | (low & 0xF0));
+			return (s7SUCCESS);
+		}
+	}
+
+	return (s7ERROR);
+}
+
+/**
+ *  @fn
+ *
+ *  分解能を設定する
+ *
+ *	@param(resolution)  s7RES_9BIT, s7RES_10BIT, s7RES_11BIT, s7RES_12BITのいずれか
+ *  @return             s7SUCCESS(成功)またはs7ERROR(パラメータ/I2Cエラー)
+ *  @detail             現在の変換レートで使えない分解能(16回/秒で12ビットなど)はエラーとなる
+ */
+int STTS751::setResolution(uint8_t resolution) {
+	if ((resolution & ~s7CONFIG_TRES) != 0 || ! isValidRate(_rate, resolution))
+		return (s7ERROR);
+
+	uint8_t config = (_config & ~s7CONFIG_TRES) | resolution;
+	if (writeRegister(s7REG_CONFIG, config) != s7SUCCESS)
+		return (s7ERROR);
+	_config = config;
+
+	return (s7SUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  変換レートを設定する
+ *
+ *	@param(rate)        s7RATE_0_0625HZ .. s7RATE_32HZのいずれか
+ *  @return             s7SUCCESS(成功)またはs7ERROR(パラメータ/I2Cエラー)
+ *  @detail             16回/秒は11ビット以下、32回/秒は10ビット以下の分解能でのみ設定できる
+ */
+int STTS751::setConversionRate(uint8_t rate) {
+	if (! isValidRate(rate, _config & s7CONFIG_TRES))
+		return (s7ERROR);
+
+	if (writeRegister(s7REG_RATE, rate) != s7SUCCESS)
+		return (s7ERROR);
+	_rate = rate;
+
+	return (s7SUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  動作モードを設定する
+ *
+ *	@param(mode)        s7MODE_CONTINUOUS(連続変換)またはs7MODE_ONE_SHOT(スタンバイ、startConversion()で1回変換)
+ *  @return             s7SUCCESS(成功)またはs7ERROR(パラメータ/I2Cエラー)
+ *  @detail             間欠動作のボードでは、s7MODE_ONE_SHOTにして必要な時だけ変換すると消費電流が小さくなる
+ */
+int STTS751::setMode(int mode) {
+	uint8_t config;
+	if (mode == s7MODE_CONTINUOUS)
+		config = _config & ~s7CONFIG_STOP;
+	else if (mode == s7MODE_ONE_SHOT)
+		config = _config | s7CONFIG_STOP;
+	else
+		return (s7ERROR);
+
+	if (writeRegister(s7REG_CONFIG, config) != s7SUCCESS)
+		return (s7ERROR);
+	_config = config;
+
+	return (s7SUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  1回だけ温度を変換する(s7MODE_ONE_SHOTの時)
+ *
+ *	@param			    なし
+ *  @return             s7SUCCESS(成功)またはs7ERROR(連続変換中/I2Cエラー)
+ *  @detail             getConversionTime()[mS]以上経ってから(またはisBusy()がfalseになってから)、
+ *                      getTemperature()またはreadTemperature()で結果を読み出す
+ */
+int STTS751::startConversion(void) {
+	if ((_config & s7CONFIG_STOP) == 0)
+		return (s7ERROR);
+
+	return (writeRegister(s7REG_ONE_SHOT, 0x00));
+}
+
+/**
+ *  @fn
+ *
+ *  変換中かどうかを調べる
+ *
+ *	@param			    なし
+ *  @return             true(変換中)またはfalse(変換完了、I2Cエラーの時もfalse)
+ *  @detail             ステータスを読むので、T_HIGH/T_LOWフラグとEVENTピンもクリアされる
+ */
+bool STTS751::isBusy(void) {
+	int status = readRegister(s7REG_STATUS);
+
+	return (status >= 0 && (status & s7STATUS_BUSY) != 0);
+}
+
+/**
+ *  @fn
+ *
+ *  現在の分解能での1回の変換時間を返す
+ *
+ *	@param			    なし
+ *  @return             変換時間[mS]
+ *  @detail             なし
+ */
+uint16_t STTS751::getConversionTime(void) {
+	switch (_config & s7CONFIG_TRES) {
+	case s7RES_9BIT:
+		return (11);
+	case s7RES_10BIT:
+		return (21);
+	case s7RES_11BIT:
+		return (42);
+	default:
+		return (84);
+	}
+}
+
+/**
+ *  @fn
+ *
+ *  温度の上限/下限を設定する
+ *
+ *	@param(highX10)     上限温度(摂氏)を10倍した値(-1280 .. 1279)
+ *	@param(lowX10)      下限温度(摂氏)を10倍した値(-1280 .. highX10 - 1)
+ *  @return             s7SUCCESS(成功)またはs7ERROR(パラメータ/I2Cエラー)
+ *  @detail             上限を超えるとT_HIGH、下限以下になるとT_LOWがセットされ、
+ *                      enableAlert(true)の時はEVENTピンがLOWになる
+ */
+int STTS751::setLimits(int highX10, int lowX10) {
+	if (highX10 < -1280 || highX10 > 1279 || lowX10 < -1280 || lowX10 >= highX10)
+		return (s7ERROR);
+
+	int16_t high = (int16_t)(highX10 * 256L / 10);
+	int16_t low = (int16_t)(lowX10 * 256L / 10);
+	if (writeRegister(s7REG_HIGH_LIMIT_HIGH, (uint8_t)(high >> 8)) != s7SUCCESS ||
+		writeRegister(s7REG_HIGH_LIMIT_LOW, (uint8_t)high & 0xF0) != s7SUCCESS ||
+		writeRegister(s7REG_LOW_LIMIT_HIGH, (uint8_t)(low >> 8)) != s7SUCCESS ||
+		writeRegister(s7REG_LOW_LIMIT_LOW, (uint8_t)low & 0xF0) != s7SUCCESS)
+		return (s7ERROR);
+
+	return (s7SUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  上限/下限を外れた時のEVENTピン出力を有効/無効にする
+ *
+ *	@param(enable)      true(有効)またはfalse(無効)
+ *  @return             s7SUCCESS(成功)またはs7ERROR(I2Cエラー)
+ *  @detail             EVENTピンはオープンドレイン、アクティブLOWで、getStatus()でステータスを読むまでLOWのまま
+ */
+int STTS751::enableAlert(bool enable) {
+	uint8_t config = enable ? (_config & ~s7CONFIG_MASK1) : (_config | s7CONFIG_MASK1);
+	if (writeRegister(s7REG_CONFIG, config) != s7SUCCESS)
+		return (s7ERROR);
+	_config = config;
+
+	return (s7SUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  EVENTピンにつながったピンに割り込みハンドラを設定する
+ *
+ *	@param(pin)         EVENTピンにつながったピン番号
+ *	@param(handler)     割り込みハンドラ(NULLの時は解除する)
+ *  @return             s7SUCCESS(成功)またはs7ERROR(パラメータエラー)
+ *  @detail             EVENTピンの立ち下がりでhandlerが呼ばれる
+ *                      handlerはフラグを立てるだけにして(I2Cは使わない)、loop()でgetStatus()を呼んでEVENTピンを戻す
+ *                      MCUはEVENTピンが変化するまでスリープしていられる
+ */
+int STTS751::setAlertHandler(int pin, void (*handler)(void)) {
+	if (_alertPin >= 0) {
+		detachInterrupt(digitalPinToInterrupt(_alertPin));
+		_alertPin = -1;
+	}
+	if (handler == NULL)
+		return (s7SUCCESS);
+	if (pin < 0)
+		return (s7ERROR);
+
+	pinMode(pin, INPUT_PULLUP);			// EVENT is open drain
+	attachInterrupt(digitalPinToInterrupt(pin), handler, FALLING);
+	_alertPin = pin;
+
+	return (s7SUCCESS);
+}
+
+/**
+ *  @fn
+ *
+ *  ステータスを読み出す
+ *
+ *	@param			    なし
+ *  @return             ステータス(s7STATUS_xxxの論理和)またはs7ERROR(I2Cエラー)
+ *  @detail             読み出すとT_HIGH/T_LOWフラグがクリアされ、EVENTピンがHIGHに戻る
+ */
+int STTS751::getStatus(void) {
+	return (readRegister(s7REG_STATUS));
+}
+
+//
+//  Private methods
+//
+int STTS751::readRegister(uint8_t reg) {
 	Wire.beginTransmission(_i2cAddress);
-    Wire.write(0x00);
-    Wire.endTransmission();
-    Wire.requestFrom(_i2cAddress, 1);
-	if (Wire.available() == 1)
-		data[0] = Wire.read();
-    Wire.beginTransmission(_i2cAddress);
-    Wire.write(0x02);
-    Wire.endTransmission();
-    Wire.requestFrom(_i2cAddress, 1);
-    if (Wire.available() == 1)
-		data[1] = Wire.read();
-
-    long temp = ((data[0] << 8) + (data[1] & 0xFC)) / 16;
-    if (temp > 2047)
-		temp -= 4096;
-
-	return (temp * 0.625);
+	Wire.write(reg);
+	if (Wire.endTransmission(false) != 0)
+		return (s7ERROR);
+	if (Wire.requestFrom(_i2cAddress, (uint8_t)1) != 1)
+		return (s7ERROR);
+
+	return (Wire.read());
+}
+
+int STTS751::writeRegister(uint8_t reg, uint8_t value) {
+	Wire.beginTransmission(_i2cAddress);
+	Wire.write(reg);
+	Wire.write(value);
+
+	return (Wire.endTransmission() == 0 ? s7SUCCESS : s7ERROR);
+}
+
+bool STTS751::isValidRate(uint8_t rate, uint8_t resolution) {
+	if (rate > s7RATE_32HZ)
+		return (false);
+	if (rate == s7RATE_32HZ)
+		return (resolution == s7RES_9BIT || resolution == s7RES_10BIT);
+	if (rate == s7RATE_16HZ)
+		return (resolution != s7RES_12BIT);
+
+	return (true);
 }
 
 // End of stts751.cpp
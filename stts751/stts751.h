@@ -4,8 +4,9 @@
  *  Digital temperature sensor STTS751 control library
  *
  *  R0.1  2020/02/29 (605e)
+ *  R0.2  2026/10/19 (A.D) add conversion rate/resolution, one-shot mode, consistent readout and limit alerts
  *
- *  Copyright(c) 2020 TABrain Inc. All rights reserved.
+ *  Copyright(c) 2020-2026 TABrain Inc. All rights reserved.
  */
 
 #ifndef	_STTS751_H_
@@ -16,14 +17,81 @@
 // Symbols
 #define s7STTS751_I2C_ADDDR  	  0b0111011       // Default i2c address
 
+// Return values
+#define s7SUCCESS                 0               // When the call is successful
+#define s7ERROR                   (-1)            // Bad parameter or I2C error
+#define s7INVALID_TEMPERATURE     (-32768)        // Returned by getTemperature() when it could not be read
+
+// Registers
+#define s7REG_TEMP_HIGH           0x00            // Temperature value high byte(signed, 1C/LSB)
+#define s7REG_STATUS              0x01            // Status
+#define s7REG_TEMP_LOW            0x02            // Temperature value low byte(upper 4 bits, 1/16C/LSB)
+#define s7REG_CONFIG              0x03            // Configuration
+#define s7REG_RATE                0x04            // Conversion rate
+#define s7REG_HIGH_LIMIT_HIGH     0x05            // Temperature high limit high byte
+#define s7REG_HIGH_LIMIT_LOW      0x06            // Temperature high limit low byte
+#define s7REG_LOW_LIMIT_HIGH      0x07            // Temperature low limit high byte
+#define s7REG_LOW_LIMIT_LOW       0x08            // Temperature low limit low byte
+#define s7REG_ONE_SHOT            0x0F            // One-shot(write any value in standby)
+
+// Status bits(T_HIGH/T_LOW are cleared when status is read)
+#define s7STATUS_BUSY             0x80            // Conversion in progress
+#define s7STATUS_T_HIGH           0x40            // Temperature exceeded the high limit
+#define s7STATUS_T_LOW            0x20            // Temperature was at or below the low limit
+#define s7STATUS_THRM             0x01            // Temperature exceeded the THERM limit
+
+// Configuration bits
+#define s7CONFIG_MASK1            0x80            // EVENT pin disabled
+#define s7CONFIG_STOP             0x40            // Standby(one-shot mode)
+#define s7CONFIG_TRES             0x0C            // Resolution bits
+
+// Resolution(for setResolution())
+#define s7RES_9BIT                0x08            // 0.5C, conversion time about 11mS
+#define s7RES_10BIT               0x00            // 0.25C, 21mS
+#define s7RES_11BIT               0x04            // 0.125C, 42mS
+#define s7RES_12BIT               0x0C            // 0.0625C, 84mS
+
+// Conversion rate(for setConversionRate())
+#define s7RATE_0_0625HZ           0x00            // 1 conversion per 16 seconds
+#define s7RATE_0_125HZ            0x01
+#define s7RATE_0_25HZ             0x02
+#define s7RATE_0_5HZ              0x03
+#define s7RATE_1HZ                0x04
+#define s7RATE_2HZ                0x05
+#define s7RATE_4HZ                0x06
+#define s7RATE_8HZ                0x07
+#define s7RATE_16HZ               0x08            // 11-bit resolution or less
+#define s7RATE_32HZ               0x09            // 10-bit resolution or less
+
+// Mode(for setMode())
+#define s7MODE_CONTINUOUS         0               // Convert at the conversion rate
+#define s7MODE_ONE_SHOT           1               // Standby, convert once by startConversion()
+
 class STTS751 {
   public:
-    STTS751(uint8_t i2cAddress = s7STTS751_I2C_ADDDR): _i2cAddress(i2cAddress) { }
-	void begin(void);
-	int getTemperature(void);
+    STTS751(uint8_t i2cAddress = s7STTS751_I2C_ADDDR): _i2cAddress(i2cAddress), _config(s7CONFIG_MASK1 | s7RES_12BIT), _rate(s7RATE_1HZ), _alertPin(-1) { }
+	int begin(void);                                    // Continuous, 12-bit, 1Hz, EVENT pin disabled
+	int getTemperature(void);                           // Temperature x10 [C]
+	int readTemperature(int16_t *value);                // Temperature [1/256C], high and low byte of the same conversion
+	int setResolution(uint8_t resolution);
+	int setConversionRate(uint8_t rate);
+	int setMode(int mode);
+	int startConversion(void);                          // Start one conversion in one-shot mode
+	bool isBusy(void);                                  // Conversion in progress
+	uint16_t getConversionTime(void);                   // Time of one conversion at current resolution [mS]
+	int setLimits(int highX10, int lowX10);             // High/low limits x10 [C]
+	int enableAlert(bool enable);                       // Assert EVENT pin(active low) when out of limits
+	int setAlertHandler(int pin, void (*handler)(void));    // Attach handler to the pin connected to EVENT(NULL to detach)
+	int getStatus(void);                                // Read status(s7STATUS_xxx), clear T_HIGH/T_LOW and EVENT pin
 
 private:
     uint8_t _i2cAddress;
+    uint8_t _config;                                    // Shadow of configuration register
+    uint8_t _rate;                                      // Shadow of conversion rate register
+    int _alertPin;                                      // Pin attached by setAlertHandler()(-1 .. none)
+	int readRegister(uint8_t reg);
+	int writeRegister(uint8_t reg, uint8_t value);
+	static bool isValidRate(uint8_t rate, uint8_t resolution);
 };
 
 #endif // _STTS_751_h_
@@ -0,0 +1,110 @@
+/*
+ * Vibration features sample sketch for MGIM
+ *
+ * [Description]
+ *  This is a sample sketch that computes the vibration features(RMS, peak frequency/amplitude and
+ *  band powers) of each axis every 256 samples(0.64 sec @400Hz), and prints them with CPU cycles.
+ *  The samples are streamed from LIS2DW FIFO by the threshold interrupt.
+ *  The features(42 bytes) are small enough to send by LTE-M instead of raw samples(1536 bytes).
+ *
+ * [Note]
+ *  Do not use LTE-M communication function, so no SIM and antenna required.
+ */
+
+#include <Wire.h>
+#include <mgim.h>
+#include <lis2dw.h>
+#include <vibspec.h>
+
+// Constants
+#define ODR               400.0   // Output data rate [Hz]
+#define FFT_POINTS        256     // Points of FFT(64..512)
+#define STREAM_SAMPLES    128     // Samples in ring(power of 2)
+#define STREAM_THRESHOLD  16      // FIFO threshold to interrupt
+
+// Initial settings
+#define REG_CTRL1     (s2ODR_400 | s2MODE_HIGH_PERFORMANCE)
+#define REG_CTRL2     (s2CTRL2_BDU)
+#define REG_CTRL6     (s2FS_2G | s2CTRL6_LOW_NOISE | s2BW_FILT_DIV2)
+
+// Define instances
+LIS2DW      acc(HIGH);   // Accelerometer
+VibSpectrum spectrum;    // Feature extraction
+int16_t     ring[3 * STREAM_SAMPLES];               // Sample ring(X,Y,Z,X,..)
+int16_t     buffer[vsBUFFER_SIZE(FFT_POINTS)];      // Windows and work area of FFT
+
+// setup() --
+void setup(void) {
+  mgim.begin();
+  Wire.begin();
+  mgSERIAL_MONITOR.begin(115200);
+  while (! mgSERIAL_MONITOR)
+    ;
+
+  // Check id
+  delay(20);    // Wait for lis2dw to complete booting
+  uint8_t id = acc.readRegister(s2REG_WHO_AM_I);
+  if (id != s2WHO_AM_I_ID) {
+    mgSERIAL_MONITOR.print("Bad id=0x");
+    mgSERIAL_MONITOR.println(id, HEX);
+    while (1) ;       // Stop here
+  }
+
+  // Reset LIS2DW
+  acc.writeRegister(s2REG_CTRL2, s2CTRL2_SOFT_RESET);
+  while (acc.readRegister(s2REG_CTRL2) & s2CTRL2_SOFT_RESET)
+    ;   // wait for ready
+
+  // Set up LIS2DW
+  acc.stageRegister(s2REG_CTRL1, 0xff, REG_CTRL1);
+  acc.stageRegister(s2REG_CTRL2, 0xff, REG_CTRL2);
+  acc.stageRegister(s2REG_CTRL6, 0xff, REG_CTRL6);
+  acc.applyConfig();
+
+  // Start feature extraction and streaming
+  spectrum.begin(buffer, FFT_POINTS, ODR);
+  mgim.setAccelerationHandler(onWatermark, RISING);
+  acc.beginStream(ring, STREAM_SAMPLES, STREAM_THRESHOLD);
+}
+
+// loop() --
+void loop(void) {
+  static int16_t  data[3 * s2MAX_FIFO_SAMPLES];
+  static int      count = 0, offset = 0;
+
+  acc.pollStream();
+  if (count == 0) {
+    count = acc.readStream(data, s2MAX_FIFO_SAMPLES);
+    offset = 0;
+  }
+  if (count > 0) {
+    int n = spectrum.addSamples(data + offset * 3, count);
+    offset += n;
+    count -= n;     // the rest is added to the next window
+  }
+
+  if (spectrum.isReady()) {
+    VSFeatures  features;
+    spectrum.compute(&features);
+    for (int axis = 0; axis < vsAXES; axis++)
+      printFeatures("XYZ"[axis], &features.axis[axis]);
+    mgSERIAL_MONITOR.print("cycles=");
+    mgSERIAL_MONITOR.println(spectrum.getCycles());
+  }
+}
+
+// printFeatures() -- print features of an axis
+void printFeatures(char axis, VSAxisFeatures *f) {
+  char  line[80];
+  sprintf(line, "%c: rms=%u peak=%u.%uHz,%u bands=", axis, f->rms, f->peakFreq / 10, f->peakFreq % 10, f->peakAmp);
+  mgSERIAL_MONITOR.print(line);
+  for (int b = 0; b < vsBANDS; b++) {
+    mgSERIAL_MONITOR.print(f->band[b] / 2);     // [dB]
+    mgSERIAL_MONITOR.print(b < vsBANDS - 1 ? "," : "\r\n");
+  }
+}
+
+// onWatermark() -- FIFO threshold interrupt handler, only set a flag(no I2C)
+void onWatermark(void) {
+  acc.onWatermark();
+}
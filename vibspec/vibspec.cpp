@@ -0,0 +1,282 @@
+/*
+ *	vibspec.cpp
+ *
+ *	Vibration spectrum feature extraction library for Arduino (Implementation)
+ *
+ *	Version:
+ *		R1.0  2026.10.19
+ *
+ *	Copyright(c) 2026 TABrain Inc.
+ */
+
+#include "vibspec.h"
+
+/*
+ *	Quarter wave of sine table, sin(2 * PI * i / 512) in Q15(i = 0..128)
+ */
+static const int16_t sineTable[129] = {
+	    0,   402,   804,  1206,  1608,  2009,  2411,  2811,
+	 3212,  3612,  4011,  4410,  4808,  5205,  5602,  5998,
+	 6393,  6787,  7180,  7571,  7962,  8351,  8740,  9127,
+	 9512,  9896, 10279, 10660, 11039, 11417, 11793, 12167,
+	12540, 12910, 13279, 13646, 14010, 14373, 14733, 15091,
+	15447, 15800, 16151, 16500, 16846, 17190, 17531, 17869,
+	18205, 18538, 18868, 19195, 19520, 19841, 20160, 20475,
+	20788, 21097, 21403, 21706, 22006, 22302, 22595, 22884,
+	23170, 23453, 23732, 24008, 24279, 24548, 24812, 25073,
+	25330, 25583, 25833, 26078, 26320, 26557, 26791, 27020,
+	27246, 27467, 27684, 27897, 28106, 28311, 28511, 28707,
+	28899, 29086, 29269, 29448, 29622, 29792, 29957, 30118,
+	30274, 30425, 30572, 30715, 30853, 30986, 31114, 31238,
+	31357, 31471, 31581, 31686, 31786, 31881, 31972, 32058,
+	32138, 32214, 32286, 32352, 32413, 32470, 32522, 32568,
+	32610, 32647, 32679, 32706, 32729, 32746, 32758, 32766,
+	32767
+
+};
+
+/*
+ *	Public methods
+ */
+
+int VibSpectrum::begin(int16_t buffer[], int points, float odr) {
+	if (buffer == NULL || points < vsMIN_POINTS || points > vsMAX_POINTS || (points & (points - 1)) != 0 || odr <= 0)
+		return (-1);	// bad parameter
+
+	_buffer = buffer;
+	_points = points;
+	for (_order = 0; (1 << _order) < points; _order++)
+		;
+	_odr10 = (uint32_t)(odr * 10 + 0.5);
+	_count = 0;
+	_micros = 0;
+
+	return (0);		// OK
+}
+
+int VibSpectrum::addSamples(const int16_t data[], int samples) {
+	if (_buffer == NULL)
+		return (0);
+	int n = _points - _count;
+	if (n > samples)
+		n = samples;		// the rest is for the next window
+	for (int i = 0; i < n; i++, data += 3) {
+		_buffer[_count + i] = data[0];
+		_buffer[_points + _count + i] = data[1];
+		_buffer[_points * 2 + _count + i] = data[2];
+	}
+	_count += n;
+
+	return (n);		// return number of XYZ sets taken
+}
+
+int VibSpectrum::compute(VSFeatures *features) {
+	if (! isReady())
+		return (-1);	// window is not full yet
+
+	uint32_t start = micros();
+	for (int axis = 0; axis < vsAXES; axis++)
+		analyze(_buffer + _points * axis, 1, &features->axis[axis]);
+	_micros = micros() - start;
+	_count = 0;		// start next window
+
+	return (0);		// OK
+}
+
+int VibSpectrum::analyze(const int16_t samples[], int stride, VSAxisFeatures *features) {
+	const int n = _points;
+	const int m = n / 2;			// points of complex FFT
+	int16_t *work = _buffer + vsAXES * n;	// z[i] = x[2i] + j x[2i+1]
+
+	memset(features, 0, sizeof(VSAxisFeatures));
+	if (_buffer == NULL)
+		return (-1);
+
+	// Remove DC, get RMS and apply Hann window
+	int32_t sum = 0;
+	for (int i = 0; i < n; i++)
+		sum += samples[i * stride];
+	int16_t mean = sum >> _order;
+	uint64_t power = 0;
+	int16_t peak = 0;
+	for (int i = 0; i < n; i++) {
+		int32_t d = samples[i * stride] - mean;
+		power += (uint32_t)(d * d);
+		int32_t w = (32767 - sine((i << (9 - _order)) + 128)) >> 1;	// 0.5 - 0.5 * cos(2 * PI * i / n)
+		int16_t x = (d * w) >> 15;
+		work[i] = x;
+		if (x < 0)
+			x = -x;
+		if (x > peak)
+			peak = x;
+	}
+	features->rms = isqrt((uint32_t)(power >> _order));
+	if (peak == 0)
+		return (0);		// no vibration
+
+	// Normalize to 8192..16383 to keep precision, and compute FFT
+	int shift = 0;
+	for (; peak < 8192; peak <<= 1)
+		shift++;
+	if (shift > 0) {
+		for (int i = 0; i < n; i++)
+			work[i] <<= shift;
+	}
+	int exponent = fft(work, m) - shift;
+		/* Amplitude of bin k is 8 * |Y[k]| * 2^exponent / n(Hann window has gain of 0.5)
+		   where Y[k] is a half of spectrum split below */
+	int ampShift = exponent + 3 - _order;
+
+	// Split into the spectrum of real input, and find peak and band powers
+	uint32_t peakPower = 0;
+	int peakBin = 0;
+	uint64_t bands[vsBANDS];
+	memset(bands, 0, sizeof(bands));
+	for (int k = 1; k < m; k++) {
+		const int16_t *z = work + k * 2;
+		const int16_t *zc = work + (m - k) * 2;
+		int32_t ar = ((int32_t)z[0] + zc[0]) >> 1;	// (Z[k] + conj(Z[m-k])) / 2
+		int32_t ai = ((int32_t)z[1] - zc[1]) >> 1;
+		int32_t cr = ((int32_t)z[1] + zc[1]) >> 1;	// -j(Z[k] - conj(Z[m-k])) / 2
+		int32_t ci = ((int32_t)zc[0] - z[0]) >> 1;
+		int32_t wr = sine((k << (9 - _order)) + 128);	// exp(-j * 2 * PI * k / n)
+		int32_t wi = -sine(k << (9 - _order));
+		int32_t yr = (ar + ((wr * cr - wi * ci) >> 15)) >> 1;
+		int32_t yi = (ai + ((wr * ci + wi * cr) >> 15)) >> 1;
+		uint32_t p = (uint32_t)(yr * yr) + (uint32_t)(yi * yi);
+		if (p > peakPower) {
+			peakPower = p;
+			peakBin = k;
+		}
+		bands[(k * vsBANDS) >> (_order - 1)] += p;
+	}
+
+	uint32_t amp = isqrt(peakPower);
+	amp = (ampShift >= 0) ? (amp << ampShift) : (amp >> -ampShift);
+	features->peakAmp = (amp > 0xffff) ? 0xffff : amp;
+	features->peakFreq = getBinFrequency(peakBin);
+	for (int b = 0; b < vsBANDS; b++) {
+		if (bands[b] == 0)
+			continue;
+		// Power = sum of amplitude^2 / 3(sinusoid is A^2 / 2, and noise bandwidth of Hann window is 1.5 bins)
+		int32_t l = log2q8(bands[b]) + 512 * ampShift - 406;	// log2(3) = 406 / 256
+		int32_t db = (l <= 0) ? 0 : (l * 1541 + 32768) >> 16;	// 20 * log10(power) = 6.0206 * log2(power)
+		features->band[b] = (db > 255) ? 255 : db;
+	}
+
+	return (0);		// OK
+}
+
+/*
+ *	Private methods
+ */
+
+int VibSpectrum::fft(int16_t data[], int n) {
+	// Bit reverse order
+	for (int i = 1, j = 0; i < n; i++) {
+		int bit = n >> 1;
+		for (; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+		if (i < j) {
+			int16_t t = data[i * 2];
+			data[i * 2] = data[j * 2];
+			data[j * 2] = t;
+			t = data[i * 2 + 1];
+			data[i * 2 + 1] = data[j * 2 + 1];
+			data[j * 2 + 1] = t;
+		}
+	}
+
+	// Radix-2 butterflies, each stage is scaled by 1/2 only if values may overflow
+	int exponent = 0;
+	for (int len = 2; len <= n; len <<= 1) {
+		int16_t peak = 0;
+		for (int i = 0; i < n * 2; i++) {
+			int16_t v = (data[i] < 0) ? -data[i] : data[i];
+			if (v > peak)
+				peak = v;
+		}
+		int scale = (peak >= 8192) ? 1 : 0;		// |a + w * b| <= 2 * max(|a|, |b|)
+		exponent += scale;
+
+		int half = len >> 1;
+		int step = 512 / len;
+		for (int j = 0; j < half; j++) {
+			int32_t wr = sine(j * step + 128);	// exp(-j * 2 * PI * j / len)
+			int32_t wi = -sine(j * step);
+			for (int i = j; i < n; i += len) {
+				int16_t *a = data + i * 2;
+				int16_t *b = data + (i + half) * 2;
+				int32_t tr = (wr * b[0] - wi * b[1]) >> 15;
+				int32_t ti = (wr * b[1] + wi * b[0]) >> 15;
+				int32_t ar = a[0];
+				int32_t ai = a[1];
+				a[0] = (ar + tr) >> scale;
+				a[1] = (ai + ti) >> scale;
+				b[0] = (ar - tr) >> scale;
+				b[1] = (ai - ti) >> scale;
+			}
+		}
+	}
+
+	return (exponent);		// output is scaled by 2^-exponent
+}
+
+int16_t VibSpectrum::sine(int index) {
+	index &= 511;
+	int r = index & 127;
+	switch (index >> 7) {
+	  case 0:
+		return (sineTable[r]);
+	  case 1:
+		return (sineTable[128 - r]);
+	  case 2:
+		return (-sineTable[r]);
+	  default:
+		return (-sineTable[128 - r]);
+	}
+}
+
+uint16_t VibSpectrum::isqrt(uint32_t value) {
+	uint32_t root = 0;
+	uint32_t bit = 1UL << 30;
+	while (bit > value)
+		bit >>= 2;
+	while (bit != 0) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+			root >>= 1;
+		bit >>= 2;
+	}
+
+	return (root);
+}
+
+int32_t VibSpectrum::log2q8(uint64_t value) {
+	int32_t result = 0;
+	while (value >= 0x10000) {
+		value >>= 1;
+		result += 256;
+	}
+	while (value < 0x8000) {
+		value <<= 1;
+		result -= 256;
+	}
+	// value is 1.0..2.0 in Q15 here, get 8 bits of fraction by squaring
+	uint32_t x = (uint32_t)value;
+	for (int bit = 128; bit > 0; bit >>= 1) {
+		x = (x * x) >> 15;
+		if (x >= 0x10000) {
+			x >>= 1;
+			result += bit;
+		}
+	}
+
+	return (result + 15 * 256);
+}
+
+// End of "vibspec.cpp"
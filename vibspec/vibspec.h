@@ -0,0 +1,83 @@
+/*
+ *	vibspec.h
+ *
+ *	Vibration spectrum feature extraction library for Arduino (Interface)
+ *
+ *	Version:
+ *		R1.0  2026.10.19
+ *
+ *	Note:
+ *		Computes vibration features(RMS, peak frequency/amplitude and band powers) of each axis
+ *		from the 3-axis acceleration blocks(X,Y,Z,X,..) read by LIS2DW/MMA8451Q libraries.
+ *		All calculations are done in integer(Q15 fixed-point), so that it runs fast on Cortex-M0+(no FPU).
+ *		  - DC(mean) is removed and Hann window is applied.
+ *		  - Real FFT of N points is computed by complex FFT of N/2 points(radix-2, block floating point),
+ *		    and split into the spectrum of N/2 bins.
+ *		Work per axis is about N/4 * log2(N/2) complex butterflies and 2 * N multiplies for window and split.
+ *		Cycles of the last compute() are measured by getCycles(), see also examples/vibration_features.
+ *
+ *	Copyright(c) 2026 TABrain Inc.
+ */
+
+#ifndef _VIBSPEC_
+#define _VIBSPEC_
+
+#include <Arduino.h>
+
+/*
+ *	Constants
+ */
+#define	vsMIN_POINTS			64			// Minimum points of FFT
+#define	vsMAX_POINTS			512			// Maximum points of FFT
+#define	vsBANDS					8			// Number of bands(each band has the same width, DC excluded)
+#define	vsAXES					3			// Number of axes(X, Y, Z)
+#define	vsBUFFER_SIZE(points)	(((vsAXES) + 1) * (points))	// int16_t elements of buffer given to begin()
+		/* Buffer keeps the window of each axis and the work area of FFT */
+#ifdef F_CPU
+#define	vsCPU_MHZ				(F_CPU / 1000000L)
+#else
+#define	vsCPU_MHZ				48			// ATSAMD21G18
+#endif
+
+/*
+ *	Features
+ */
+typedef struct {
+	uint16_t	rms;				// RMS of the window(DC removed) [LSB]
+	uint16_t	peakFreq;			// Frequency of the highest peak in spectrum [0.1Hz]
+	uint16_t	peakAmp;			// Amplitude of the highest peak [LSB]
+	uint8_t		band[vsBANDS];		// Power of each band [0.5dB/LSB, 0 means 1LSB^2 or less]
+} __attribute__((packed)) VSAxisFeatures;	// 14 bytes
+
+typedef struct {
+	VSAxisFeatures	axis[vsAXES];	// Features of X, Y and Z
+} __attribute__((packed)) VSFeatures;	// 42 bytes, ready to pack into a payload
+
+/*
+ *	VibSpectrum class
+ */
+class VibSpectrum {
+  public:
+	VibSpectrum() { _buffer = NULL; _points = _count = 0; }
+	int begin(int16_t buffer[], int points, float odr);	// Set buffer(vsBUFFER_SIZE(points)), points(power of 2) and ODR[Hz]
+	int addSamples(const int16_t data[], int samples);	// Add XYZ sets(14-bit) to the window, return number of sets taken
+	bool isReady(void) { return (_points > 0 && _count >= _points); }	// Window is full
+	int compute(VSFeatures *features);				// Compute features of the window, and start next window
+	int analyze(const int16_t samples[], int stride, VSAxisFeatures *features);	// Compute features of one axis
+	uint32_t getCycles(void) { return (_micros * vsCPU_MHZ); }	// CPU cycles of the last compute()(measured by micros())
+	int getBinFrequency(int bin) { return ((int)(((uint32_t)bin * _odr10) >> _order)); }	// Frequency of FFT bin [0.1Hz]
+
+  private:
+	int16_t	*_buffer;					// Windows of X,Y,Z(points each) and work area(points)
+	int		_points;					// Points of FFT
+	uint8_t	_order;						// log2(_points)
+	uint32_t	_odr10;					// ODR [0.1Hz]
+	int		_count;						// XYZ sets in the window
+	uint32_t	_micros;				// Time of the last compute() [uS]
+	static int fft(int16_t data[], int n);	// Complex FFT in place(block floating point), return exponent
+	static int16_t sine(int index);		// sin(2 * PI * index / 512) in Q15
+	static uint16_t isqrt(uint32_t value);	// Integer square root
+	static int32_t log2q8(uint64_t value);	// log2(value) in Q8(value > 0)
+};
+
+#endif // _VIBSPEC_